@@ -0,0 +1,460 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+// Rendering benchmark for the GTK2 engine.
+//
+// Loads the engine module from the build tree through the theme's own gtkrc,
+// and calls every GtkStyleClass drawing hook the engine overrides through
+// the public gtk_paint_* API, on a matrix of widgets and details, for all
+// widget states and a few sizes. Drawing is done into an offscreen
+// GdkPixmap, the X server is synchronized after each batch so that the
+// server side rasterization is part of the measurement.
+//
+// Usage: qtcurve-gtk2-benchmark [-n iterations] [preset file]
+// GTK2 needs an X display; use e.g. xvfb-run on a headless machine.
+
+#include <qtcurve-utils/timer.h>
+#include <qtcurve-utils/number.h>
+
+#include <gtk/gtk.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+enum class Hook {
+    HLine,
+    VLine,
+    Shadow,
+    Arrow,
+    Box,
+    FlatBox,
+    Check,
+    Option,
+    Tab,
+    ShadowGap,
+    BoxGap,
+    Extension,
+    Focus,
+    Slider,
+    Handle,
+    Expander,
+    Layout,
+    ResizeGrip,
+};
+
+static const char *const hook_names[] = {
+    "hline",
+    "vline",
+    "shadow",
+    "arrow",
+    "box",
+    "flat_box",
+    "check",
+    "option",
+    "tab",
+    "shadow_gap",
+    "box_gap",
+    "extension",
+    "focus",
+    "slider",
+    "handle",
+    "expander",
+    "layout",
+    "resize_grip",
+};
+
+enum WidgetKind {
+    W_Button,
+    W_ToggleButton,
+    W_CheckButton,
+    W_RadioButton,
+    W_Entry,
+    W_SpinButton,
+    W_ComboBox,
+    W_HScrollbar,
+    W_VScrollbar,
+    W_HScale,
+    W_ProgressBar,
+    W_Notebook,
+    W_MenuBar,
+    W_MenuItem,
+    W_TreeView,
+    W_Frame,
+    W_ScrolledWindow,
+    W_Toolbar,
+    W_HandleBox,
+    W_Paned,
+    W_Statusbar,
+    W_Label,
+    W_Separator,
+    W_Count
+};
+
+static const char *const widget_names[] = {
+    "GtkButton",
+    "GtkToggleButton",
+    "GtkCheckButton",
+    "GtkRadioButton",
+    "GtkEntry",
+    "GtkSpinButton",
+    "GtkComboBox",
+    "GtkHScrollbar",
+    "GtkVScrollbar",
+    "GtkHScale",
+    "GtkProgressBar",
+    "GtkNotebook",
+    "GtkMenuBar",
+    "GtkMenuItem",
+    "GtkTreeView",
+    "GtkFrame",
+    "GtkScrolledWindow",
+    "GtkToolbar",
+    "GtkHandleBox",
+    "GtkHPaned",
+    "GtkStatusbar",
+    "GtkLabel",
+    "GtkHSeparator",
+};
+
+struct Case {
+    Hook hook;
+    WidgetKind widget;
+    const char *detail;
+    GtkShadowType shadow;
+};
+
+// The widget/detail combinations the engine special cases the most, roughly
+// ordered by how often a typical application hits them.
+static const Case cases[] = {
+    {Hook::FlatBox, W_TreeView, "cell_even", GTK_SHADOW_NONE},
+    {Hook::FlatBox, W_TreeView, "cell_odd_ruled", GTK_SHADOW_NONE},
+    {Hook::FlatBox, W_TreeView, "cell_even_sorted", GTK_SHADOW_NONE},
+    {Hook::FlatBox, W_Entry, "entry_bg", GTK_SHADOW_NONE},
+    {Hook::FlatBox, W_MenuItem, "menuitem", GTK_SHADOW_NONE},
+    {Hook::FlatBox, W_Label, "tooltip", GTK_SHADOW_NONE},
+    {Hook::FlatBox, W_Frame, "base", GTK_SHADOW_NONE},
+    {Hook::Box, W_Button, "button", GTK_SHADOW_OUT},
+    {Hook::Box, W_Button, "buttondefault", GTK_SHADOW_IN},
+    {Hook::Box, W_ToggleButton, "togglebutton", GTK_SHADOW_OUT},
+    {Hook::Box, W_TreeView, "button", GTK_SHADOW_OUT},
+    {Hook::Box, W_ComboBox, "button", GTK_SHADOW_OUT},
+    {Hook::Box, W_HScrollbar, "trough", GTK_SHADOW_IN},
+    {Hook::Box, W_HScrollbar, "stepper", GTK_SHADOW_OUT},
+    {Hook::Box, W_HScrollbar, "hscrollbar", GTK_SHADOW_OUT},
+    {Hook::Box, W_VScrollbar, "vscrollbar", GTK_SHADOW_OUT},
+    {Hook::Box, W_HScale, "trough", GTK_SHADOW_IN},
+    {Hook::Box, W_ProgressBar, "trough", GTK_SHADOW_IN},
+    {Hook::Box, W_ProgressBar, "bar", GTK_SHADOW_OUT},
+    {Hook::Box, W_SpinButton, "spinbutton_up", GTK_SHADOW_OUT},
+    {Hook::Box, W_SpinButton, "spinbutton_down", GTK_SHADOW_OUT},
+    {Hook::Box, W_MenuBar, "menubar", GTK_SHADOW_OUT},
+    {Hook::Box, W_MenuItem, "menuitem", GTK_SHADOW_OUT},
+    {Hook::Box, W_Toolbar, "toolbar", GTK_SHADOW_OUT},
+    {Hook::Box, W_HandleBox, "handlebox_bin", GTK_SHADOW_OUT},
+    {Hook::Shadow, W_Entry, "entry", GTK_SHADOW_IN},
+    {Hook::Shadow, W_Frame, "frame", GTK_SHADOW_ETCHED_IN},
+    {Hook::Shadow, W_ScrolledWindow, "scrolled_window", GTK_SHADOW_IN},
+    {Hook::Shadow, W_SpinButton, "entry", GTK_SHADOW_IN},
+    {Hook::Check, W_CheckButton, "checkbutton", GTK_SHADOW_IN},
+    {Hook::Check, W_TreeView, "cellcheck", GTK_SHADOW_OUT},
+    {Hook::Check, W_MenuItem, "check", GTK_SHADOW_IN},
+    {Hook::Option, W_RadioButton, "radiobutton", GTK_SHADOW_IN},
+    {Hook::Option, W_TreeView, "cellradio", GTK_SHADOW_OUT},
+    {Hook::Arrow, W_HScrollbar, "hscrollbar", GTK_SHADOW_OUT},
+    {Hook::Arrow, W_SpinButton, "spinbutton", GTK_SHADOW_OUT},
+    {Hook::Arrow, W_ComboBox, "arrow", GTK_SHADOW_NONE},
+    {Hook::Arrow, W_MenuItem, "menuitem", GTK_SHADOW_NONE},
+    {Hook::Tab, W_ComboBox, "optionmenutab", GTK_SHADOW_OUT},
+    {Hook::ShadowGap, W_Frame, "frame", GTK_SHADOW_ETCHED_IN},
+    {Hook::BoxGap, W_Notebook, "notebook", GTK_SHADOW_OUT},
+    {Hook::Extension, W_Notebook, "tab", GTK_SHADOW_OUT},
+    {Hook::Focus, W_Button, "button", GTK_SHADOW_NONE},
+    {Hook::Focus, W_Entry, "entry", GTK_SHADOW_NONE},
+    {Hook::Focus, W_TreeView, "treeview", GTK_SHADOW_NONE},
+    {Hook::Slider, W_HScrollbar, "slider", GTK_SHADOW_OUT},
+    {Hook::Slider, W_HScale, "hscale", GTK_SHADOW_OUT},
+    {Hook::Handle, W_Paned, "paned", GTK_SHADOW_NONE},
+    {Hook::Handle, W_HandleBox, "handlebox", GTK_SHADOW_OUT},
+    {Hook::Handle, W_Toolbar, "toolbar", GTK_SHADOW_OUT},
+    {Hook::Expander, W_TreeView, "treeview", GTK_SHADOW_NONE},
+    {Hook::Layout, W_Label, "label", GTK_SHADOW_NONE},
+    {Hook::Layout, W_Button, "button", GTK_SHADOW_NONE},
+    {Hook::ResizeGrip, W_Statusbar, "statusbar", GTK_SHADOW_NONE},
+    {Hook::HLine, W_Separator, "hseparator", GTK_SHADOW_NONE},
+    {Hook::HLine, W_MenuItem, "menuitem", GTK_SHADOW_NONE},
+    {Hook::VLine, W_Toolbar, "toolbar", GTK_SHADOW_NONE},
+};
+
+static const struct {
+    GtkStateType state;
+    const char *name;
+} states[] = {
+    {GTK_STATE_NORMAL, "normal"},
+    {GTK_STATE_PRELIGHT, "prelight"},
+    {GTK_STATE_ACTIVE, "active"},
+    {GTK_STATE_SELECTED, "selected"},
+    {GTK_STATE_INSENSITIVE, "insensitive"},
+};
+
+static const struct {
+    int width;
+    int height;
+} sizes[] = {
+    {16, 16},
+    {120, 24},
+    {400, 300},
+};
+
+static GtkWidget*
+createWidget(WidgetKind kind)
+{
+    switch (kind) {
+    case W_Button:
+        return gtk_button_new_with_label("QtCurve");
+    case W_ToggleButton:
+        return gtk_toggle_button_new_with_label("QtCurve");
+    case W_CheckButton:
+        return gtk_check_button_new_with_label("QtCurve");
+    case W_RadioButton:
+        return gtk_radio_button_new_with_label(nullptr, "QtCurve");
+    case W_Entry:
+        return gtk_entry_new();
+    case W_SpinButton:
+        return gtk_spin_button_new_with_range(0, 100, 1);
+    case W_ComboBox:
+        return gtk_combo_box_new_text();
+    case W_HScrollbar:
+        return gtk_hscrollbar_new(nullptr);
+    case W_VScrollbar:
+        return gtk_vscrollbar_new(nullptr);
+    case W_HScale:
+        return gtk_hscale_new_with_range(0, 100, 1);
+    case W_ProgressBar:
+        return gtk_progress_bar_new();
+    case W_Notebook:
+        return gtk_notebook_new();
+    case W_MenuBar:
+        return gtk_menu_bar_new();
+    case W_MenuItem: {
+        GtkWidget *bar = gtk_menu_bar_new();
+        GtkWidget *item = gtk_menu_item_new_with_label("QtCurve");
+        gtk_menu_shell_append(GTK_MENU_SHELL(bar), item);
+        return item;
+    }
+    case W_TreeView:
+        return gtk_tree_view_new();
+    case W_Frame:
+        return gtk_frame_new("QtCurve");
+    case W_ScrolledWindow:
+        return gtk_scrolled_window_new(nullptr, nullptr);
+    case W_Toolbar:
+        return gtk_toolbar_new();
+    case W_HandleBox:
+        return gtk_handle_box_new();
+    case W_Paned:
+        return gtk_hpaned_new();
+    case W_Statusbar:
+        return gtk_statusbar_new();
+    case W_Label:
+        return gtk_label_new("QtCurve");
+    case W_Separator:
+        return gtk_hseparator_new();
+    default:
+        return nullptr;
+    }
+}
+
+class Bench {
+public:
+    Bench(GtkWidget *window, int iterations)
+        : m_iterations(iterations),
+          m_pixmap(gdk_pixmap_new(gtk_widget_get_window(window), 400, 300, -1)),
+          m_layout(gtk_widget_create_pango_layout(window, "QtCurve"))
+    {
+        GtkWidget *box = gtk_vbox_new(false, 0);
+        gtk_container_add(GTK_CONTAINER(window), box);
+        for (int i = 0;i < W_Count;i++) {
+            m_widgets[i] = createWidget(WidgetKind(i));
+            // Widgets that already have a parent (menu items) are reached
+            // through their toplevel.
+            GtkWidget *top = m_widgets[i];
+            while (GtkWidget *parent = gtk_widget_get_parent(top)) {
+                top = parent;
+            }
+            gtk_box_pack_start(GTK_BOX(box), top, false, false, 0);
+        }
+        gtk_widget_show_all(window);
+    }
+    ~Bench()
+    {
+        g_object_unref(m_layout);
+        g_object_unref(m_pixmap);
+    }
+    void
+    run(const Case &c)
+    {
+        GtkWidget *widget = m_widgets[c.widget];
+        GtkStyle *style = gtk_widget_get_style(widget);
+        for (const auto &state: states) {
+            for (const auto &size: sizes) {
+                GdkRectangle area = {0, 0, size.width, size.height};
+                // Warm up the caches so that we measure the steady state.
+                paint(c, style, widget, state.state, &area);
+                gdk_display_sync(gdk_display_get_default());
+                uint64_t start = QtCurve::getTime();
+                for (int i = 0;i < m_iterations;i++) {
+                    paint(c, style, widget, state.state, &area);
+                }
+                gdk_display_sync(gdk_display_get_default());
+                double ns = double(QtCurve::getElapse(start)) / m_iterations;
+                double mpix = (size.width * size.height) / ns * 1e3;
+                printf("%s\t%s\t%s\t%s\t%dx%d\t%.1f\t%.2f\n",
+                       hook_names[(int)c.hook], widget_names[c.widget],
+                       c.detail, state.name, size.width, size.height, ns,
+                       mpix);
+            }
+        }
+    }
+private:
+    void
+    paint(const Case &c, GtkStyle *style, GtkWidget *widget,
+          GtkStateType state, GdkRectangle *area)
+    {
+        GdkDrawable *d = m_pixmap;
+        int w = area->width;
+        int h = area->height;
+        switch (c.hook) {
+        case Hook::HLine:
+            gtk_paint_hline(style, d, state, area, widget, c.detail,
+                            0, w, h / 2);
+            break;
+        case Hook::VLine:
+            gtk_paint_vline(style, d, state, area, widget, c.detail,
+                            0, h, w / 2);
+            break;
+        case Hook::Shadow:
+            gtk_paint_shadow(style, d, state, c.shadow, area, widget,
+                             c.detail, 0, 0, w, h);
+            break;
+        case Hook::Arrow:
+            gtk_paint_arrow(style, d, state, c.shadow, area, widget, c.detail,
+                            GTK_ARROW_DOWN, true, 0, 0, w, h);
+            break;
+        case Hook::Box:
+            gtk_paint_box(style, d, state, c.shadow, area, widget, c.detail,
+                          0, 0, w, h);
+            break;
+        case Hook::FlatBox:
+            gtk_paint_flat_box(style, d, state, c.shadow, area, widget,
+                               c.detail, 0, 0, w, h);
+            break;
+        case Hook::Check:
+            gtk_paint_check(style, d, state, c.shadow, area, widget, c.detail,
+                            0, 0, w, h);
+            break;
+        case Hook::Option:
+            gtk_paint_option(style, d, state, c.shadow, area, widget, c.detail,
+                             0, 0, w, h);
+            break;
+        case Hook::Tab:
+            gtk_paint_tab(style, d, state, c.shadow, area, widget, c.detail,
+                          0, 0, w, h);
+            break;
+        case Hook::ShadowGap:
+            gtk_paint_shadow_gap(style, d, state, c.shadow, area, widget,
+                                 c.detail, 0, 0, w, h, GTK_POS_TOP,
+                                 w / 4, w / 2);
+            break;
+        case Hook::BoxGap:
+            gtk_paint_box_gap(style, d, state, c.shadow, area, widget,
+                              c.detail, 0, 0, w, h, GTK_POS_TOP, w / 4, w / 2);
+            break;
+        case Hook::Extension:
+            gtk_paint_extension(style, d, state, c.shadow, area, widget,
+                                c.detail, 0, 0, w, h, GTK_POS_BOTTOM);
+            break;
+        case Hook::Focus:
+            gtk_paint_focus(style, d, state, area, widget, c.detail,
+                            0, 0, w, h);
+            break;
+        case Hook::Slider:
+            gtk_paint_slider(style, d, state, c.shadow, area, widget, c.detail,
+                             0, 0, w, h, GTK_ORIENTATION_HORIZONTAL);
+            break;
+        case Hook::Handle:
+            gtk_paint_handle(style, d, state, c.shadow, area, widget, c.detail,
+                             0, 0, w, h, GTK_ORIENTATION_HORIZONTAL);
+            break;
+        case Hook::Expander:
+            gtk_paint_expander(style, d, state, area, widget, c.detail,
+                               w / 2, h / 2, GTK_EXPANDER_EXPANDED);
+            break;
+        case Hook::Layout:
+            gtk_paint_layout(style, d, state, true, area, widget, c.detail,
+                             0, 0, m_layout);
+            break;
+        case Hook::ResizeGrip:
+            gtk_paint_resize_grip(style, d, state, area, widget, c.detail,
+                                  GDK_WINDOW_EDGE_SOUTH_EAST, 0, 0, w, h);
+            break;
+        }
+    }
+    int m_iterations;
+    GdkPixmap *m_pixmap;
+    PangoLayout *m_layout;
+    GtkWidget *m_widgets[W_Count];
+};
+
+}
+
+int
+main(int argc, char **argv)
+{
+    int iterations = 100;
+    for (int i = 1;i < argc;i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = qtcMax(1, atoi(argv[++i]));
+        } else {
+            setenv("QTCURVE_CONFIG_FILE", argv[i], 1);
+        }
+    }
+    // Make gtk find the engine we just built and use it for every widget.
+    setenv("GTK_PATH", QTC_BENCHMARK_GTK_PATH, 1);
+    setenv("GTK2_RC_FILES", QTC_BENCHMARK_GTKRC, 1);
+    if (!gtk_init_check(&argc, &argv)) {
+        fprintf(stderr, "Cannot open display, "
+                "run the benchmark with an X server (e.g. xvfb-run).\n");
+        return 1;
+    }
+
+    GtkWidget *window = gtk_offscreen_window_new();
+    gtk_widget_realize(window);
+    Bench bench(window, iterations);
+    printf("# hook\twidget\tdetail\tstate\tsize\tns/call\tMpixel/s\n");
+    for (const auto &c: cases) {
+        bench.run(c);
+    }
+    gtk_widget_destroy(window);
+    return 0;
+}
@@ -25,11 +25,15 @@
 #include <qtcurve-utils/dirs.h>
 #include <qtcurve-utils/strs.h>
 #include <qtcurve-utils/color.h>
+#include <qtcurve-utils/confcache.h>
+#include <qtcurve-utils/lrucache.h>
+#include <qtcurve-utils/trace.h>
 
 #include "common.h"
 #include "config_file.h"
 
 #include <fstream>
+#include <vector>
 
 #define CONFIG_FILE               "stylerc"
 #define OLD_CONFIG_FILE           "qtcurvestylerc"
@@ -1134,8 +1138,195 @@ void qtcCheckConfig(Options *opts)
         opts->toolbarSeparators=LINE_DOTS;
 }
 
+#ifndef CONFIG_DIALOG
+// Binary snapshot of the options read by the style, see confcache.h.
+// Everything from version up to customGradient is plain data and is copied
+// as is.
+#define CACHE_STRINGS(F)                                                \
+    F(noBgndGradientApps) F(noBgndOpacityApps) F(noMenuBgndOpacityApps) \
+    F(noBgndImageApps) F(noMenuStripeApps)
+
+typedef std::pair<const char*, size_t> CacheStr;
+
+static uint64_t
+cacheLayout(const Options *opts)
+{
+    const char *base = (const char*)opts;
+    uint64_t layout = QtCurve::hashCombine(sizeof(Options), sizeof(GdkColor));
+    layout = QtCurve::hashCombine(layout, sizeof(GradientStop));
+    layout = QtCurve::hashCombine(layout, NUM_CUSTOM_GRAD);
+    return QtCurve::hashCombine(
+        layout, (const char*)&opts->customGradient - base);
+}
+
+static char*
+cacheStrDup(const CacheStr &str)
+{
+    return str.first ? g_strndup(str.first, str.second) : nullptr;
+}
+
+static void
+writeCacheImage(QtCurve::ConfCache::Writer &w, const QtCImage &img)
+{
+    w.put<int>(img.type);
+    w.put<bool>(img.onBorder);
+    w.put<int>(img.width);
+    w.put<int>(img.height);
+    w.put<int>(img.pos);
+    w.putStr(img.pixmap.file);
+}
+
+static void
+readCacheImage(QtCurve::ConfCache::Reader &r, QtCImage *img, CacheStr *file)
+{
+    int type = 0;
+    int pos = 0;
+    r.get(&type);
+    r.get(&img->onBorder);
+    r.get(&img->width);
+    r.get(&img->height);
+    r.get(&pos);
+    r.getStr(&file->first, &file->second);
+    img->type = (EImageType)type;
+    img->pos = (EPixPos)pos;
+    img->loaded = false;
+    img->pixmap.img = nullptr;
+    img->pixmap.file = nullptr;
+}
+
+static void
+writeCacheStrings(QtCurve::ConfCache::Writer &w, const Strings strs)
+{
+    w.put<int>(strs ? g_strv_length(strs) : -1);
+    for (int i = 0;strs && strs[i];i++) {
+        w.putStr(strs[i]);
+    }
+}
+
+// \param null is set for a NULL list (as opposed to an empty one).
+static void
+readCacheStrings(QtCurve::ConfCache::Reader &r, std::vector<CacheStr> *strs,
+                 bool *null)
+{
+    int num = -1;
+    r.get(&num);
+    *null = num < 0;
+    for (int i = 0;i < num && r.ok();i++) {
+        CacheStr str;
+        if (r.getStr(&str.first, &str.second) && str.first) {
+            strs->push_back(str);
+        }
+    }
+}
+
+static Strings
+toStrings(const std::vector<CacheStr> &strs, bool null)
+{
+    if (null) {
+        return nullptr;
+    }
+    Strings res = qtcNew(char*, strs.size() + 1);
+    for (size_t i = 0;i < strs.size();i++) {
+        res[i] = cacheStrDup(strs[i]);
+    }
+    return res;
+}
+
+static void
+saveConfigCache(const QtCurve::ConfCache::File &cache, const Options *opts)
+{
+    // The name of a background pixmap is not kept after loading it.
+    if (opts->bgndAppearance == APPEARANCE_FILE ||
+        opts->menuBgndAppearance == APPEARANCE_FILE) {
+        return;
+    }
+    QtCurve::ConfCache::Writer w;
+    w.putRange(&opts->version, &opts->customGradient);
+    for (int i = 0;i < NUM_CUSTOM_GRAD;i++) {
+        const Gradient *grad = opts->customGradient[i];
+        w.put<int>(grad ? grad->numStops : -1);
+        if (grad) {
+            w.put<int>(grad->border);
+            w.putData(grad->stops, sizeof(GradientStop) * grad->numStops);
+        }
+    }
+    writeCacheImage(w, opts->bgndImage);
+    writeCacheImage(w, opts->menuBgndImage);
+#define WRITE_STRINGS(ENTRY) writeCacheStrings(w, opts->ENTRY);
+    CACHE_STRINGS(WRITE_STRINGS)
+#undef WRITE_STRINGS
+    w.put(opts->onlyTicksInMenu);
+    w.put(opts->buttonStyleMenuSections);
+    w.put(opts->menuCloseDelay);
+    cache.save(w);
+}
+
+static bool
+loadConfigCache(QtCurve::ConfCache::File &cache, Options *opts)
+{
+    if (!cache.load()) {
+        return false;
+    }
+    // Check the whole snapshot before allocating anything.
+    QtCurve::ConfCache::Reader r(cache.reader());
+    Options res;
+    memcpy(&res, opts, sizeof(Options));
+    r.getRange(&res.version, &res.customGradient);
+    int borders[NUM_CUSTOM_GRAD];
+    int numStops[NUM_CUSTOM_GRAD];
+    std::vector<GradientStop> stops[NUM_CUSTOM_GRAD];
+    for (int i = 0;i < NUM_CUSTOM_GRAD;i++) {
+        numStops[i] = -1;
+        if (r.get(&numStops[i]) && numStops[i] >= 0 && r.get(&borders[i])) {
+            stops[i].resize(numStops[i]);
+            r.getData(stops[i].data(), sizeof(GradientStop) * numStops[i]);
+        }
+    }
+    CacheStr bgndFile;
+    CacheStr menuBgndFile;
+    readCacheImage(r, &res.bgndImage, &bgndFile);
+    readCacheImage(r, &res.menuBgndImage, &menuBgndFile);
+#define READ_STRINGS(ENTRY)                             \
+    std::vector<CacheStr> ENTRY;                        \
+    bool ENTRY##Null;                                   \
+    readCacheStrings(r, &ENTRY, &ENTRY##Null);
+    CACHE_STRINGS(READ_STRINGS)
+#undef READ_STRINGS
+    r.get(&res.onlyTicksInMenu);
+    r.get(&res.buttonStyleMenuSections);
+    r.get(&res.menuCloseDelay);
+    if (!r.atEnd()) {
+        return false;
+    }
+    for (int i = 0;i < NUM_CUSTOM_GRAD;i++) {
+        auto &grad = res.customGradient[i];
+        grad = nullptr;
+        if (numStops[i] >= 0) {
+            grad = qtcNew(Gradient);
+            grad->border = (EGradientBorder)borders[i];
+            grad->numStops = numStops[i];
+            grad->stops = qtcNew(GradientStop, numStops[i]);
+            memcpy(grad->stops, stops[i].data(),
+                   sizeof(GradientStop) * numStops[i]);
+        }
+    }
+    res.bgndImage.pixmap.file = cacheStrDup(bgndFile);
+    res.menuBgndImage.pixmap.file = cacheStrDup(menuBgndFile);
+#define SET_STRINGS(ENTRY) res.ENTRY = toStrings(ENTRY, ENTRY##Null);
+    CACHE_STRINGS(SET_STRINGS)
+#undef SET_STRINGS
+    memcpy(opts, &res, sizeof(Options));
+    qtcX11SetShadowSize(opts->shadowSize);
+    return true;
+}
+#undef CACHE_STRINGS
+#endif
+
+static const char * getSystemConfigFile();
+
 bool qtcReadConfig(const char *file, Options *opts, Options *defOpts)
 {
+    qtcTrace("qtcReadConfig");
     bool checkImages=true;
     if (!file) {
         const char *env = getenv("QTCURVE_CONFIG_FILE");
@@ -1148,6 +1339,17 @@ bool qtcReadConfig(const char *file, Options *opts, Options *defOpts)
         }
         return qtcReadConfig(filename.c_str(), opts, defOpts);
     } else {
+#ifndef CONFIG_DIALOG
+        // Only the style reads with the default options, don't bother
+        // caching for the config dialog or the system config.
+        QtCurve::ConfCache::File cache(
+            defOpts ? std::string() :
+            QtCurve::ConfCache::File::path(file, "gtk2"),
+            {file, getSystemConfigFile()}, cacheLayout(opts));
+        if (loadConfigCache(cache, opts)) {
+            return true;
+        }
+#endif
         GHashTable *cfg = loadConfig(file);
 
         if (cfg) {
@@ -1553,6 +1755,9 @@ bool qtcReadConfig(const char *file, Options *opts, Options *defOpts)
             }
 
             qtcCheckConfig(opts);
+#ifndef CONFIG_DIALOG
+            saveConfigCache(cache, opts);
+#endif
 
             if (!defOpts) {
                 for (int i = 0;i < NUM_CUSTOM_GRAD;++i) {
@@ -41,6 +41,8 @@ namespace Animation {
 class Info {
 public:
     GtkWidget *const widget;
+    /* The animated part of the widget, empty if unknown. */
+    GdkRectangle area;
 
     Info(const GtkWidget *w, double stop_time);
     ~Info();
@@ -66,6 +68,7 @@ static gboolean timeoutHandler(void *data);
 inline
 Info::Info(const GtkWidget *w, double stop_time)
     : widget(const_cast<GtkWidget*>(w)),
+      area{0, 0, 0, 0},
       m_timer(g_timer_new()),
       m_stop_time(stop_time)
 {
@@ -95,12 +98,22 @@ Info::timer_reset() const
     g_timer_start(m_timer);
 }
 
-/* This forces a redraw on a widget */
+/* This forces a redraw on a widget, limited to \param area if it is not
+ * empty. */
 static void
-force_widget_redraw(GtkWidget *widget)
+force_widget_redraw(GtkWidget *widget, const GdkRectangle *area=nullptr)
 {
+#if !GTK_CHECK_VERSION(2, 90, 0)
+    /* GtkProgressBar only repaints its offscreen pixmap when it is dirty,
+     * mark it so here instead of queueing a resize (and with it a size
+     * negotiation of the whole toplevel) for every frame. */
     if (GTK_IS_PROGRESS_BAR(widget)) {
-        gtk_widget_queue_resize(widget);
+        GTK_PROGRESS_BAR(widget)->dirty = true;
+    }
+#endif
+    if (area && area->width > 0 && area->height > 0) {
+        gtk_widget_queue_draw_area(widget, area->x, area->y,
+                                   area->width, area->height);
     } else {
         gtk_widget_queue_draw(widget);
     }
@@ -165,12 +178,12 @@ lookupInfo(const GtkWidget *widget)
 
 /* Create all the relevant information for the animation,
  * and insert it into the hash table. */
-static void
+static Info*
 addWidget(const GtkWidget *widget, double stop_time)
 {
     /* object already in the list, do not add it twice */
-    if (lookupInfo(widget)) {
-        return;
+    if (Info *info = lookupInfo(widget)) {
+        return info;
     }
 
     if (animated_widgets == nullptr) {
@@ -185,6 +198,7 @@ addWidget(const GtkWidget *widget, double stop_time)
     g_hash_table_insert(animated_widgets, (GtkWidget*)widget, value);
 
     startTimer();
+    return value;
 }
 
 /* update the animation information for each widget. This will also queue a redraw
@@ -220,7 +234,7 @@ updateInfo(void *key, void *value, void*)
         }
     }
 
-    force_widget_redraw(widget);
+    force_widget_redraw(widget, &info->area);
 
     /* stop at stop_time */
     if (info->need_stop()) {
@@ -229,7 +243,9 @@ updateInfo(void *key, void *value, void*)
     return false;
 }
 
-/* This gets called by the glib main loop every once in a while. */
+/* This gets called by the glib main loop every once in a while. All the
+ * animated widgets are updated from this single timer so that their redraws
+ * end up in the same frame. */
 static gboolean
 timeoutHandler(void*)
 {
@@ -318,14 +334,23 @@ connectCheckbox(GtkWidget *widget)
 
 /* adds a progress bar */
 void
-addProgressBar(GtkWidget *progressbar, bool isEntry)
+addProgressBar(GtkWidget *progressbar, bool isEntry, const GdkRectangle *area)
 {
     double fraction =
         (isEntry ? gtk_entry_get_progress_fraction(GTK_ENTRY(progressbar)) :
          gtk_progress_bar_get_fraction(GTK_PROGRESS_BAR(progressbar)));
 
     if (fraction < 1.0 && fraction > 0.0) {
-        addWidget((GtkWidget*)progressbar, 0.0);
+        Info *info = addWidget((GtkWidget*)progressbar, 0.0);
+        /* The area is relative to the window it is drawn on while
+         * gtk_widget_queue_draw_area() takes allocation relative coordinates,
+         * these are only the same if that is the widget's own window (which
+         * is not the case for the text area of an entry). */
+        if (area && !isEntry && gtk_widget_get_has_window(progressbar)) {
+            info->area = *area;
+        } else {
+            info->area = GdkRectangle{0, 0, 0, 0};
+        }
     }
 }
 
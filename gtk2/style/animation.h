@@ -27,7 +27,12 @@
 
 namespace QtCurve {
 namespace Animation {
-void addProgressBar(GtkWidget *progressbar, bool isEntry);
+/**
+ * Animate \param progressbar, \param area (if not NULL) is the part of it
+ * that changes between frames, in the coordinates of the widget's window.
+ */
+void addProgressBar(GtkWidget *progressbar, bool isEntry,
+                    const GdkRectangle *area=nullptr);
 void cleanup();
 double elapsed(void *data);
 }
@@ -0,0 +1,180 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+
+#include "detail.h"
+
+#include <qtcurve-utils/strs.h>
+#include <glib.h>
+#include <unordered_map>
+
+namespace QtCurve {
+
+static const struct {
+    const char *name;
+    EDetail type;
+} detailNames[] = {
+    {"arrow", DETAIL_ARROW},
+    {"bar", DETAIL_BAR},
+    {"base", DETAIL_BASE},
+    {"button", DETAIL_BUTTON},
+    {"buttondefault", DETAIL_BUTTON_DEFAULT},
+    {"cellrenderertext", DETAIL_CELL_RENDERER_TEXT},
+    {"check", DETAIL_CHECK},
+    {"checkbutton", DETAIL_CHECK_BUTTON},
+    {"dockitem", DETAIL_DOCK_ITEM},
+    {"dockitem_bin", DETAIL_DOCK_ITEM_BIN},
+    {"entry", DETAIL_ENTRY},
+    {"entry_bg", DETAIL_ENTRY_BG},
+    {"entry-progress", DETAIL_ENTRY_PROGRESS},
+    {"eventbox", DETAIL_EVENT_BOX},
+    {"expander", DETAIL_EXPANDER},
+    {"frame", DETAIL_FRAME},
+    {"handlebox", DETAIL_HANDLE_BOX},
+    {"handlebox_bin", DETAIL_HANDLE_BOX_BIN},
+    {"hscale", DETAIL_HSCALE},
+    {"hseparator", DETAIL_HSEPARATOR},
+    {"icon_view_item", DETAIL_ICON_VIEW_ITEM},
+    {"label", DETAIL_LABEL},
+    {"menu", DETAIL_MENU},
+    {"menubar", DETAIL_MENUBAR},
+    {"menuitem", DETAIL_MENUITEM},
+    {"notebook", DETAIL_NOTEBOOK},
+    {"option", DETAIL_OPTION},
+    {"optionmenu", DETAIL_OPTION_MENU},
+    {"paned", DETAIL_PANED},
+    {"progressbar", DETAIL_PROGRESSBAR},
+    {"qtc-slider", DETAIL_QTC_SLIDER},
+    {"scrolled_window", DETAIL_SCROLLED_WINDOW},
+    {"slider", DETAIL_SLIDER},
+    {"spinbutton", DETAIL_SPIN_BUTTON},
+    {"spinbutton_up", DETAIL_SPIN_BUTTON_UP},
+    {"spinbutton_down", DETAIL_SPIN_BUTTON_DOWN},
+    {"splitter", DETAIL_SPLITTER},
+    {"stepper", DETAIL_STEPPER},
+    {"tab", DETAIL_TAB},
+    {"text", DETAIL_TEXT},
+    {"togglebutton", DETAIL_TOGGLE_BUTTON},
+    {"togglebuttondefault", DETAIL_TOGGLE_BUTTON_DEFAULT},
+    {"toolbar", DETAIL_TOOLBAR},
+    {"tooltip", DETAIL_TOOLTIP},
+    {"trough", DETAIL_TROUGH},
+    {"trough-lower", DETAIL_TROUGH_LOWER},
+    {"viewport", DETAIL_VIEWPORT},
+    {"viewportbin", DETAIL_VIEWPORT_BIN},
+    {"vscale", DETAIL_VSCALE},
+    {"vseparator", DETAIL_VSEPARATOR}
+};
+
+static EDetail
+detailType(const char *detail)
+{
+    for (const auto &entry: detailNames) {
+        if (strcmp(detail, entry.name) == 0) {
+            return entry.type;
+        }
+    }
+    // "hpaned", "vpaned", "hruler" and "vruler"
+    if (strcmp(detail + 1, "paned") == 0) {
+        return DETAIL_PANED;
+    } else if (strcmp(detail + 1, "ruler") == 0) {
+        return DETAIL_RULER;
+    }
+    return DETAIL_OTHER;
+}
+
+static Detail
+classify(const char *detail)
+{
+    Detail res = {detailType(detail), 0, detail};
+    unsigned &flags = res.flags;
+    if (detail[0] == 'h') {
+        flags |= DETAIL_H;
+    } else if (detail[0] == 'v') {
+        flags |= DETAIL_V;
+    }
+    if (Str::startsWith(detail + 1, "scrollbar")) {
+        flags |= DETAIL_SBAR;
+        if (detail[0] == 'h') {
+            flags |= DETAIL_HSCROLLBAR;
+        } else if (detail[0] == 'v') {
+            flags |= DETAIL_VSCROLLBAR;
+        }
+    } else if (res.type == DETAIL_STEPPER) {
+        flags |= DETAIL_SBAR;
+    }
+    if (Str::endsWith(detail, "_start")) {
+        flags |= DETAIL_ENDS_START;
+    } else if (Str::endsWith(detail, "_end")) {
+        flags |= DETAIL_ENDS_END;
+    }
+    const struct {
+        const char *str;
+        EDetailFlags flag;
+    } substrs[] = {
+        {"cell_even", DETAIL_CELL_EVEN},
+        {"cell_odd", DETAIL_CELL_ODD},
+        {"_sorted", DETAIL_SORTED},
+        {"_start", DETAIL_HAS_START},
+        {"_end", DETAIL_HAS_END},
+        {"_middle", DETAIL_HAS_MIDDLE},
+        {"menu_scroll_arrow_", DETAIL_MENU_SCROLL_ARROW},
+        {"viewport", DETAIL_HAS_VIEWPORT}
+    };
+    for (const auto &substr: substrs) {
+        if (strstr(detail, substr.str)) {
+            flags |= substr.flag;
+        }
+    }
+    if (Str::startsWith(detail, "trough-")) {
+        flags |= DETAIL_TROUGH_PART;
+    }
+    if ((flags & DETAIL_SBAR) ||
+        oneOf(res.type, DETAIL_OPTION_MENU, DETAIL_BUTTON,
+              DETAIL_BUTTON_DEFAULT, DETAIL_TOGGLE_BUTTON_DEFAULT,
+              DETAIL_TOGGLE_BUTTON, DETAIL_HSCALE, DETAIL_VSCALE,
+              DETAIL_SPIN_BUTTON, DETAIL_SPIN_BUTTON_UP,
+              DETAIL_SPIN_BUTTON_DOWN, DETAIL_SLIDER, DETAIL_QTC_SLIDER)) {
+        flags |= DETAIL_BUTTON_COLOR;
+    }
+    return res;
+}
+
+const Detail&
+classifyDetail(const char *detail)
+{
+    static const Detail none = {DETAIL_NONE, 0, ""};
+    if (!detail || !detail[0]) {
+        return none;
+    }
+    // GTK only uses a few dozen different details, so the table stays small.
+    static std::unordered_map<GQuark, Detail> details;
+    GQuark quark = g_quark_from_string(detail);
+    auto it = details.find(quark);
+    if (qtcLikely(it != details.end())) {
+        return it->second;
+    }
+    // The quark's copy of the string lives as long as the process.
+    return details.emplace(quark,
+                           classify(g_quark_to_string(quark))).first->second;
+}
+
+}
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+
+#ifndef __QTC_DETAIL_H__
+#define __QTC_DETAIL_H__
+
+#include <qtcurve-utils/utils.h>
+
+namespace QtCurve {
+
+// The detail strings GTK passes to the style hooks that we care about.
+// Strings we match exactly map to an EDetail, the prefixes and substrings we
+// test for are EDetailFlags.
+enum EDetail {
+    DETAIL_NONE, // NULL or ""
+    DETAIL_OTHER,
+    DETAIL_ARROW,
+    DETAIL_BAR,
+    DETAIL_BASE,
+    DETAIL_BUTTON,
+    DETAIL_BUTTON_DEFAULT,
+    DETAIL_CELL_RENDERER_TEXT,
+    DETAIL_CHECK,
+    DETAIL_CHECK_BUTTON,
+    DETAIL_DOCK_ITEM,
+    DETAIL_DOCK_ITEM_BIN,
+    DETAIL_ENTRY,
+    DETAIL_ENTRY_BG,
+    DETAIL_ENTRY_PROGRESS,
+    DETAIL_EVENT_BOX,
+    DETAIL_EXPANDER,
+    DETAIL_FRAME,
+    DETAIL_HANDLE_BOX,
+    DETAIL_HANDLE_BOX_BIN,
+    DETAIL_HSCALE,
+    DETAIL_HSEPARATOR,
+    DETAIL_ICON_VIEW_ITEM,
+    DETAIL_LABEL,
+    DETAIL_MENU,
+    DETAIL_MENUBAR,
+    DETAIL_MENUITEM,
+    DETAIL_NOTEBOOK,
+    DETAIL_OPTION,
+    DETAIL_OPTION_MENU,
+    DETAIL_PANED, // "paned", "hpaned", "vpaned"
+    DETAIL_PROGRESSBAR,
+    DETAIL_QTC_SLIDER,
+    DETAIL_RULER, // "hruler", "vruler"
+    DETAIL_SCROLLED_WINDOW,
+    DETAIL_SLIDER,
+    DETAIL_SPIN_BUTTON,
+    DETAIL_SPIN_BUTTON_UP,
+    DETAIL_SPIN_BUTTON_DOWN,
+    DETAIL_SPLITTER,
+    DETAIL_STEPPER,
+    DETAIL_TAB,
+    DETAIL_TEXT,
+    DETAIL_TOGGLE_BUTTON,
+    DETAIL_TOGGLE_BUTTON_DEFAULT,
+    DETAIL_TOOLBAR,
+    DETAIL_TOOLTIP,
+    DETAIL_TROUGH,
+    DETAIL_TROUGH_LOWER,
+    DETAIL_VIEWPORT,
+    DETAIL_VIEWPORT_BIN,
+    DETAIL_VSCALE,
+    DETAIL_VSEPARATOR
+};
+
+enum EDetailFlags {
+    DETAIL_H = 1 << 0, // starts with 'h'
+    DETAIL_V = 1 << 1, // starts with 'v'
+    // "stepper" or "?scrollbar*"
+    DETAIL_SBAR = 1 << 2,
+    DETAIL_HSCROLLBAR = 1 << 3, // "hscrollbar*"
+    DETAIL_VSCROLLBAR = 1 << 4, // "vscrollbar*"
+    // Scrollbar stepper positions (`GtkRange::stepper-position-details`)
+    DETAIL_ENDS_START = 1 << 5, // "*_start"
+    DETAIL_ENDS_END = 1 << 6, // "*_end"
+    // Tree view cells, e.g. "cell_odd_ruled_sorted_start"
+    DETAIL_CELL_EVEN = 1 << 7,
+    DETAIL_CELL_ODD = 1 << 8,
+    DETAIL_SORTED = 1 << 9,
+    DETAIL_HAS_START = 1 << 10,
+    DETAIL_HAS_END = 1 << 11,
+    DETAIL_HAS_MIDDLE = 1 << 12,
+    DETAIL_MENU_SCROLL_ARROW = 1 << 13, // "*menu_scroll_arrow_*"
+    DETAIL_TROUGH_PART = 1 << 14, // "trough-*"
+    DETAIL_HAS_VIEWPORT = 1 << 15, // "*viewport*"
+    // Drawn with the button colors (see useButtonColor())
+    DETAIL_BUTTON_COLOR = 1 << 16
+};
+
+struct Detail {
+    EDetail type;
+    unsigned flags;
+    // The original string, for debug output.
+    const char *name;
+};
+
+/**
+ * Classify \param detail. Each distinct string is only looked at once,
+ * after that this is a quark lookup.
+ */
+const Detail &classifyDetail(const char *detail);
+
+}
+
+#endif
@@ -27,39 +27,49 @@
 #include "qt_settings.h"
 #include "helpers.h"
 #include "pixcache.h"
+#include "gradcache.h"
 #include "entry.h"
 #include "tab.h"
 #include "animation.h"
+#include "treeview.h"
 
 #include <qtcurve-utils/gtkprops.h>
 #include <qtcurve-utils/color.h>
 #include <qtcurve-utils/log.h>
+#include <qtcurve-utils/shape.h>
 
 #include <common/config_file.h>
 
 namespace QtCurve {
 
+// The shape of a popup with rounded corners, as rectangles so that setting it
+// doesn't need a bitmap to be uploaded to the X server.
 #if GTK_CHECK_VERSION(2, 90, 0)
 static cairo_region_t*
-windowMask(int x, int y, int w, int h, bool full)
+#else
+static GdkRegion*
+#endif
+windowMask(int w, int h, bool full)
 {
-    QtcRect rects[4];
-    int numRects = 4;
-
-    if (full) {
-        rects[0] = qtcRect(x + 4, y + 0, w - 4 * 2, h);
-        rects[1] = qtcRect(x + 0, y + 4, w, h - 4 * 2);
-        rects[2] = qtcRect(x + 2, y + 1, w - 2 * 2, h - 2);
-        rects[3] = qtcRect(x + 1, y + 2, w - 2, h - 2 * 2);
-    } else {
-        rects[0] = qtcRect(x + 1, y + 1, w - 2, h - 2);
-        rects[1] = qtcRect(x, y + 2, w, h - 4);
-        rects[2] = qtcRect(x + 2, y, w - 4, h);
-        numRects = 3;
+    ShapeRect rects[Shape::maxRects];
+    size_t numRects = Shape::rounded(w, h, full, rects);
+#if GTK_CHECK_VERSION(2, 90, 0)
+    QtcRect regionRects[Shape::maxRects];
+    for (size_t i = 0;i < numRects;i++) {
+        regionRects[i] = qtcRect(rects[i].x, rects[i].y,
+                                 rects[i].width, rects[i].height);
     }
-    return cairo_region_create_rectangles(rects, numRects);
-}
+    return cairo_region_create_rectangles(regionRects, numRects);
+#else
+    GdkRegion *region = gdk_region_new();
+    for (size_t i = 0;i < numRects;i++) {
+        GdkRectangle rect = {rects[i].x, rects[i].y,
+                             rects[i].width, rects[i].height};
+        gdk_region_union_with_rect(region, &rect);
+    }
+    return region;
 #endif
+}
 
 void
 drawBgnd(cairo_t *cr, const GdkColor *col, GtkWidget *widget,
@@ -92,9 +102,6 @@ drawBevelGradient(cairo_t *cr, const QtcRect *area, int x, int y,
             Cairo::rect(cr, area, x, y, width, height, base, alpha);
         }
     } else {
-        cairo_pattern_t *pt =
-            cairo_pattern_create_linear(x, y, horiz ? x : x + width - 1,
-                                        horiz ? y + height - 1 : y);
         bool topTab = w == WIDGET_TAB_TOP;
         bool botTab = w == WIDGET_TAB_BOT;
         bool selected = (topTab || botTab) ? false : sel;
@@ -107,48 +114,33 @@ drawBevelGradient(cairo_t *cr, const QtcRect *area, int x, int y,
                            WIDGET_LISTVIEW_HEADER == w ? bevApp :
                            APPEARANCE_GRADIENT);
         const Gradient *grad = qtcGetGradient(app, &opts);
-        Cairo::Saver saver(cr);
-        Cairo::clipRect(cr, area);
-
+        int len = horiz ? height : width;
+        int flags = ((botTab ? Ramp::Reverse : 0) |
+                     (botTab && opts.invertBotTab ? Ramp::Invert : 0) |
+                     (topTab || botTab ? Ramp::BaseEnd : 0) |
+                     (oneOf(w, WIDGET_TOOLTIP, WIDGET_LISTVIEW_HEADER) ?
+                      Ramp::Opaque : 0));
+        Ramp ramp(_qtc_color_from_gdk(base), opts.shading, flags);
+        ramp.reserve(grad->numStops);
         for (int i = 0;i < grad->numStops;i++) {
-            GdkColor col;
-            double pos = botTab ? 1.0 - grad->stops[i].pos : grad->stops[i].pos;
-
-            if ((topTab || botTab) && i == grad->numStops - 1) {
-                if (sel && opts.tabBgnd == 0 && !isMozilla()) {
-                    alpha = 0.0;
-                }
-                col = *base;
-            } else {
-                double val = (botTab && opts.invertBotTab ?
-                              INVERT_SHADE(grad->stops[i].val) :
-                              grad->stops[i].val);
-                qtcShade(base, &col, botTab && opts.invertBotTab ?
-                         qtcMax(val, 0.9) : val, opts.shading);
-            }
-
-            Cairo::patternAddColorStop(pt, pos, &col,
-                                       oneOf(w, WIDGET_TOOLTIP,
-                                             WIDGET_LISTVIEW_HEADER) ?
-                                       alpha : alpha * grad->stops[i].alpha);
+            ramp.add(grad->stops[i].pos, grad->stops[i].val,
+                     grad->stops[i].alpha);
         }
+        bool fadeEnd = ((topTab || botTab) && sel && opts.tabBgnd == 0 &&
+                        !isMozilla());
+        bool agua = (app == APPEARANCE_AGUA && !(topTab || botTab) &&
+                     len > AGUA_MAX);
+        Cairo::Saver saver(cr);
+        Cairo::clipRect(cr, area);
 
-        if (app == APPEARANCE_AGUA && !(topTab || botTab) &&
-            (horiz ? height : width) > AGUA_MAX) {
-            GdkColor col;
-            double pos = AGUA_MAX / ((horiz ? height : width) * 2.0);
-
-            qtcShade(base, &col, AGUA_MID_SHADE, opts.shading);
-            Cairo::patternAddColorStop(pt, pos, &col, alpha);
-            /* *grad->stops[i].alpha); */
-            Cairo::patternAddColorStop(pt, 1.0 - pos, &col, alpha);
-            /* *grad->stops[i].alpha); */
+        GdkColor aguaMid;
+        if (agua) {
+            qtcShade(base, &aguaMid, AGUA_MID_SHADE, opts.shading);
         }
-
-        cairo_set_source(cr, pt);
+        setGradientSource(cr, ramp.stops(), alpha, fadeEnd,
+                          agua ? &aguaMid : nullptr, x, y, len, horiz);
         cairo_rectangle(cr, x, y, width, height);
         cairo_fill(cr);
-        cairo_pattern_destroy(pt);
     }
 }
 
@@ -1510,7 +1502,11 @@ drawProgress(cairo_t *cr, GtkStyle *style, GtkStateType state,
 #if !GTK_CHECK_VERSION(2, 90, 0) /* Gtk3:TODO !!! */
         if (isEntryProg || !GTK_PROGRESS(widget)->activity_mode)
 #endif
-            Animation::addProgressBar(widget, isEntryProg);
+        {
+            // Only the filled part moves.
+            const GdkRectangle band = {xo, yo, wo, ho};
+            Animation::addProgressBar(widget, isEntryProg, &band);
+        }
 
         animShift+=(revProg ? -1 : 1)*
             (int(Animation::elapsed(widget) * PROGRESS_CHUNK_WIDTH) %
@@ -1691,7 +1687,7 @@ drawProgressGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
 
 void
 drawSliderGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
-                 GtkWidget *widget, const char *detail,
+                 GtkWidget *widget, const Detail &detail,
                  const QtcRect *area, int x, int y, int width, int height,
                  bool horiz)
 {
@@ -1735,7 +1731,7 @@ drawSliderGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
 
     if (state == GTK_STATE_INSENSITIVE) {
         bgndcol = &bgndcols[ORIGINAL_SHADE];
-    } else if (oneOf(detail, "trough-lower") && opts.fillSlider) {
+    } else if (detail.type == DETAIL_TROUGH_LOWER && opts.fillSlider) {
         bgndcols = usedcols;
         bgndcol = &usedcols[ORIGINAL_SHADE];
         wid = WIDGET_FILLED_SLIDER_TROUGH;
@@ -1746,7 +1742,7 @@ drawSliderGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
                    DF_SUNKEN | DF_DO_BORDER | (horiz ? 0 : DF_VERT), nullptr);
 
     if (opts.fillSlider && upper != lower &&
-        state != GTK_STATE_INSENSITIVE && oneOf(detail, "trough")) {
+        state != GTK_STATE_INSENSITIVE && detail.type == DETAIL_TROUGH) {
         if (horiz) {
             pos += width > 10 && pos < width / 2 ? 3 : 0;
 
@@ -1777,7 +1773,7 @@ drawSliderGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
 
 void
 drawTriangularSlider(cairo_t *cr, GtkStyle *style, GtkStateType state,
-                     const char *detail, int x, int y, int width, int height)
+                     const Detail &detail, int x, int y, int width, int height)
 {
     GdkColor newColors[TOTAL_SHADES + 1];
     const GdkColor *btnColors = nullptr;
@@ -1801,7 +1797,7 @@ drawTriangularSlider(cairo_t *cr, GtkStyle *style, GtkStateType state,
     bool coloredMouseOver = (state == GTK_STATE_PRELIGHT &&
                              opts.coloredMouseOver &&
                              !opts.colorSliderMouseOver);
-    bool horiz = height > width || oneOf(detail, "hscale");
+    bool horiz = height > width || detail.type == DETAIL_HSCALE;
     int bgnd = getFill(state, false, opts.shadeSliders == SHADE_DARKEN);
     int xo = horiz ? 8 : 0;
     int yo = horiz ? 0 : 8;
@@ -2246,9 +2242,18 @@ drawSelection(cairo_t *cr, GtkStyle *style, GtkStateType state,
     }
 }
 
+// The shape is set on the GdkWindow, which is gone after an unrealize, so it
+// has to be set again on the next draw.
+static void
+roundedMaskUnrealize(GtkWidget *widget, void*)
+{
+    GtkWidgetProps props(widget);
+    props->widgetMask = 0;
+}
+
 void
 createRoundedMask(GtkWidget *widget, int x, int y, int width,
-                  int height, double radius, bool isToolTip)
+                  int height, bool isToolTip)
 {
     if (widget) {
         int size = ((width & 0xFFFF) << 16) + (height & 0xFFFF);
@@ -2257,34 +2262,30 @@ createRoundedMask(GtkWidget *widget, int x, int y, int width,
 
         if (size != old) {
 #if GTK_CHECK_VERSION(2, 90, 0)
-            GdkRegion *mask = windowMask(0, 0, width, height,
-                                         opts.round > ROUND_SLIGHT);
+            cairo_region_t *mask = windowMask(width, height,
+                                              opts.round > ROUND_SLIGHT);
 
             gtk_widget_shape_combine_region(widget, nullptr);
             gtk_widget_shape_combine_region(widget, mask);
-            gdk_region_destroy(mask);
+            cairo_region_destroy(mask);
 #else
-            GdkBitmap *mask = gdk_pixmap_new(nullptr, width, height, 1);
-            cairo_t *crMask = gdk_cairo_create((GdkDrawable*)mask);
-
-            cairo_rectangle(crMask, 0, 0, width, height);
-            cairo_set_source_rgba(crMask, 1, 1, 1, 0);
-            cairo_set_operator(crMask, CAIRO_OPERATOR_SOURCE);
-            cairo_paint(crMask);
-            cairo_new_path(crMask);
-            Cairo::pathWhole(crMask, 0, 0, width, height, radius, ROUNDED_ALL);
-            cairo_set_source_rgba(crMask, 0, 0, 0, 1);
-            cairo_fill(crMask);
+            GdkWindow *window = (isToolTip ? gtk_widget_get_window(widget) :
+                                 gtk_widget_get_parent_window(widget));
+            if (!window) {
+                return;
+            }
+            GdkRegion *mask = windowMask(width, height,
+                                         opts.round > ROUND_SLIGHT);
             if (isToolTip) {
-                gtk_widget_shape_combine_mask(widget, mask, x, y);
+                gdk_window_shape_combine_region(window, mask, x, y);
             } else {
-                gdk_window_shape_combine_mask(
-                    gtk_widget_get_parent_window(widget), mask, 0, 0);
+                gdk_window_shape_combine_region(window, mask, 0, 0);
             }
-            cairo_destroy(crMask);
-            gdk_pixmap_unref(mask);
+            gdk_region_destroy(mask);
 #endif
             props->widgetMask = size;
+            props->widgetMaskUnrealize.conn("unrealize",
+                                            roundedMaskUnrealize);
             /* Setting the window type to 'popup menu' seems to
                re-eanble kwin shadows! */
             if (isToolTip && gtk_widget_get_window(widget)) {
@@ -2304,10 +2305,11 @@ clearRoundedMask(GtkWidget *widget, bool isToolTip)
 #if GTK_CHECK_VERSION(2, 90, 0)
             gtk_widget_shape_combine_region(widget, nullptr);
 #else
-            if(isToolTip)
-                gtk_widget_shape_combine_mask(widget, nullptr, 0, 0);
-            else
-                gdk_window_shape_combine_mask(gtk_widget_get_parent_window(widget), nullptr, 0, 0);
+            GdkWindow *window = (isToolTip ? gtk_widget_get_window(widget) :
+                                 gtk_widget_get_parent_window(widget));
+            if (window) {
+                gdk_window_shape_combine_region(window, nullptr, 0, 0);
+            }
 #endif
             props->widgetMask = 0;
         }
@@ -2321,33 +2323,30 @@ drawTreeViewLines(cairo_t *cr, const GdkColor *col, int x, int y, int h,
 {
     int cellIndent = levelIndent + expanderSize + 4;
     int xStart = x + cellIndent / 2;
-    int isLastMask = 0;
+    uint32_t isLastMask = 0;
     bool haveChildren = treeViewCellHasChildren(treeView, path);
     bool useBitMask = depth < 33;
     GByteArray *isLast = (depth && !useBitMask ?
                           g_byte_array_sized_new(depth) : nullptr);
 
+    if (useBitMask) {
+        isLastMask = TreeView::isLastMask(treeView, path);
+    }
     if (useBitMask || isLast) {
-        GtkTreePath  *p = path ? gtk_tree_path_copy(path) : nullptr;
+        GtkTreePath  *p = path && isLast ? gtk_tree_path_copy(path) : nullptr;
         int index=depth-1;
 
         while (p && gtk_tree_path_get_depth(p) > 0 && index>=0) {
             GtkTreePath *next=treeViewPathParent(treeView, p);
             uint8_t last=treeViewCellIsLast(treeView, p) ? 1 : 0;
-            if (useBitMask) {
-                if (last) {
-                    isLastMask |= 1 << index;
-                }
-            } else {
-                isLast = g_byte_array_prepend(isLast, &last, 1);
-            }
+            isLast = g_byte_array_prepend(isLast, &last, 1);
             gtk_tree_path_free(p);
             p = next;
             index--;
         }
         Cairo::setColor(cr, col);
         for(int i = 0;i < depth;++i) {
-            bool isLastCell = ((useBitMask ? isLastMask & (1 << i) :
+            bool isLastCell = ((useBitMask ? isLastMask & (1u << i) :
                                 isLast->data[i]) ? true : false);
             bool last = i == depth - 1;
             double xCenter = xStart;
@@ -2524,8 +2523,7 @@ drawToolTip(cairo_t *cr, GtkWidget *widget, const QtcRect *area,
             cairo_fill(cr);
             clearRoundedMask(widget, true);
         } else {
-            createRoundedMask(widget, x, y, width, height,
-                              opts.round >= ROUND_FULL ? 5.0 : 2.5, true);
+            createRoundedMask(widget, x, y, width, height, true);
         }
         Cairo::clipWhole(cr, x, y, width, height,
                          opts.round >= ROUND_FULL ? 5.0 : 2.5, ROUNDED_ALL);
@@ -2797,8 +2795,7 @@ drawMenu(cairo_t *cr, GtkWidget *widget, const QtcRect *area,
             cairo_fill(cr);
             clearRoundedMask(widget, false);
         } else {
-            createRoundedMask(widget, x, y, width, height,
-                              radius - 0.25, false);
+            createRoundedMask(widget, x, y, width, height, false);
         }
         Cairo::clipWhole(cr, x, y, width, height, radius, ROUNDED_ALL);
     }
@@ -3235,14 +3232,14 @@ drawShadowGap(cairo_t *cr, GtkStyle *style, GtkShadowType shadow,
 
 void
 drawCheckBox(cairo_t *cr, GtkStateType state, GtkShadowType shadow,
-             GtkStyle *style, GtkWidget *widget, const char *detail,
+             GtkStyle *style, GtkWidget *widget, const Detail &detail,
              const QtcRect *area, int x, int y, int width, int height)
 {
     if (state == GTK_STATE_PRELIGHT &&
         oneOf(qtSettings.app, GTK_APP_MOZILLA, GTK_APP_JAVA)) {
         state = GTK_STATE_NORMAL;
     }
-    bool mnu = oneOf(detail, "check");
+    bool mnu = detail.type == DETAIL_CHECK;
     bool list = !mnu && isList(widget);
     bool on = shadow == GTK_SHADOW_IN;
     bool tri = shadow == GTK_SHADOW_ETCHED_IN;
@@ -3267,7 +3264,7 @@ drawCheckBox(cairo_t *cr, GtkStateType state, GtkShadowType shadow,
     if (qtSettings.debug == DEBUG_ALL) {
         printf(DEBUG_PREFIX "%s %d %d %d %d %d %d %d %s  ",
                __FUNCTION__, state, shadow, x, y, width, height, mnu,
-               detail ? detail : "nullptr");
+               detail.name);
         debugDisplayWidget(widget, 10);
     }
     if ((mnu && state == GTK_STATE_PRELIGHT) ||
@@ -3377,14 +3374,14 @@ drawCheckBox(cairo_t *cr, GtkStateType state, GtkShadowType shadow,
 
 void
 drawRadioButton(cairo_t *cr, GtkStateType state, GtkShadowType shadow,
-                GtkStyle *style, GtkWidget *widget, const char *detail,
+                GtkStyle *style, GtkWidget *widget, const Detail &detail,
                 const QtcRect *area, int x, int y, int width, int height)
 {
     if (state == GTK_STATE_PRELIGHT &&
         oneOf(qtSettings.app, GTK_APP_MOZILLA, GTK_APP_JAVA)) {
         state = GTK_STATE_NORMAL;
     }
-    bool mnu = oneOf(detail, "option");
+    bool mnu = detail.type == DETAIL_OPTION;
     bool list = !mnu && isList(widget);
     if ((mnu && state == GTK_STATE_PRELIGHT) ||
         (list && state == GTK_STATE_ACTIVE)) {
@@ -3392,7 +3389,8 @@ drawRadioButton(cairo_t *cr, GtkStateType state, GtkShadowType shadow,
     }
 
     if (!qtSettings.qt4 && mnu) {
-        drawCheckBox(cr, state, shadow, style, widget, "check", area,
+        static const Detail check = {DETAIL_CHECK, 0, "check"};
+        drawCheckBox(cr, state, shadow, style, widget, check, area,
                      x, y, width, height);
     } else {
         bool on = shadow == GTK_SHADOW_IN;
@@ -3872,7 +3870,8 @@ drawTab(cairo_t *cr, GtkStateType state, GtkStyle *style, GtkWidget *widget,
 
 void
 drawToolbarBorders(cairo_t *cr, GtkStateType state, int x, int y, int width,
-                   int height, bool isActiveWindowMenubar, const char *detail)
+                   int height, bool isActiveWindowMenubar,
+                   const Detail &detail)
 {
     bool top = false;
     bool bottom = false;
@@ -3885,13 +3884,13 @@ drawToolbarBorders(cairo_t *cr, GtkStateType state, int x, int y, int width,
                              opts.shadeMenubars != SHADE_NONE) ?
                             menuColors(isActiveWindowMenubar) :
                             qtcPalette.background);
-    if (oneOf(detail, "menubar")) {
+    if (detail.type == DETAIL_MENUBAR) {
         if (all) {
             top = bottom = left = right = true;
         } else {
             bottom = true;
         }
-    } else if (oneOf(detail, "toolbar")) {
+    } else if (detail.type == DETAIL_TOOLBAR) {
         if (all) {
             if (width < height) {
                 left = right = bottom = true;
@@ -3905,7 +3904,8 @@ drawToolbarBorders(cairo_t *cr, GtkStateType state, int x, int y, int width,
                 top = bottom = true;
             }
         }
-    } else if (oneOf(detail,"dockitem_bin", "handlebox_bin")) {
+    } else if (oneOf(detail.type, DETAIL_DOCK_ITEM_BIN,
+                     DETAIL_HANDLE_BOX_BIN)) {
         /* CPD: bit risky - what if only 1 item ??? */
         if (all) {
             if (width < height) {
@@ -25,6 +25,7 @@
 
 #include <common/common.h>
 #include <qtcurve-cairo/draw.h>
+#include "detail.h"
 
 #define CAIRO_GRAD_END 1.0
 
@@ -107,11 +108,11 @@ void drawProgressGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
                         const QtcRect *area, int x, int y, int width,
                         int height, bool isList, bool horiz);
 void drawSliderGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
-                      GtkWidget *widget, const char *detail,
+                      GtkWidget *widget, const Detail &detail,
                       const QtcRect *area, int x, int y, int width, int height,
                       bool horiz);
 void drawTriangularSlider(cairo_t *cr, GtkStyle *style, GtkStateType state,
-                          const char *detail, int x, int y,
+                          const Detail &detail, int x, int y,
                           int width, int height);
 void drawScrollbarGroove(cairo_t *cr, GtkStyle *style, GtkStateType state,
                          GtkWidget *widget, const QtcRect *area, int x, int y,
@@ -125,7 +126,7 @@ void drawSelection(cairo_t *cr, GtkStyle *style, GtkStateType state,
                    int width, int height, ECornerBits round, bool isLvSelection,
                    double alphaMod, int factor);
 void createRoundedMask(GtkWidget *widget, int x, int y, int width, int height,
-                       double radius, bool isToolTip);
+                       bool isToolTip);
 void clearRoundedMask(GtkWidget *widget, bool isToolTip);
 void drawTreeViewLines(cairo_t *cr, const GdkColor *col, int x, int y, int h,
                        int depth, int levelIndent, int expanderSize,
@@ -158,17 +159,17 @@ void drawShadowGap(cairo_t *cr, GtkStyle *style, GtkShadowType shadow,
                    int x, int y, int width, int height,
                    GtkPositionType gapSide, int gapX, int gapWidth);
 void drawCheckBox(cairo_t *cr, GtkStateType state, GtkShadowType shadow,
-                  GtkStyle *style, GtkWidget *widget, const char *detail,
+                  GtkStyle *style, GtkWidget *widget, const Detail &detail,
                   const QtcRect *area, int x, int y, int width, int height);
 void drawTab(cairo_t *cr, GtkStateType state, GtkStyle *style,
              GtkWidget *widget, QtcRect *area, int x, int y,
              int width, int height, GtkPositionType gapSide);
 void drawRadioButton(cairo_t *cr, GtkStateType state, GtkShadowType shadow,
-                     GtkStyle *style, GtkWidget *widget, const char *detail,
+                     GtkStyle *style, GtkWidget *widget, const Detail &detail,
                      const QtcRect *area, int x, int y, int width, int height);
 void drawToolbarBorders(cairo_t *cr, GtkStateType state, int x, int y,
                         int width, int height, bool isActiveWindowMenubar,
-                        const char *detail);
+                        const Detail &detail);
 void drawListViewHeader(cairo_t *cr, GtkStateType state,
                         const GdkColor *btnColors, int bgnd,
                         const QtcRect *area, int x, int y,
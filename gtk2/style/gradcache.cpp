@@ -0,0 +1,225 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "gradcache.h"
+
+#include <qtcurve-utils/cachestats.h>
+#include <qtcurve-cairo/utils.h>
+#include <common/common.h>
+
+namespace QtCurve {
+
+// A pattern is a couple hundred bytes plus its stops, there's one for each
+// color, appearance and alpha drawn with.
+static const size_t patternCacheBudget = 128 * 1024;
+
+struct PatternKey {
+    const std::vector<RampStop> *stops;
+    double alpha;
+    bool fadeEnd;
+    bool
+    operator==(const PatternKey &other) const
+    {
+        return (stops == other.stops && alpha == other.alpha &&
+                fadeEnd == other.fadeEnd);
+    }
+};
+
+struct PatternHash {
+    size_t
+    operator()(const PatternKey &key) const
+    {
+        uint64_t alpha;
+        memcpy(&alpha, &key.alpha, sizeof(alpha));
+        // The lowest bit of the (aligned) pointer is always clear.
+        return hashCombine(hashMix(uint64_t(key.stops) | key.fadeEnd), alpha);
+    }
+};
+
+struct PatternDeleter {
+    void
+    operator()(cairo_pattern_t *pt)
+    {
+        cairo_pattern_destroy(pt);
+    }
+};
+
+struct CachedPattern {
+    // Keeps the ramp, and therefore the address used in the key, alive.
+    RampStops stops;
+    std::unique_ptr<cairo_pattern_t, PatternDeleter> pattern;
+};
+
+static LRUCache<PatternKey, CachedPattern, PatternHash> patternCache(
+    patternCacheBudget);
+static CacheRegistration patternCacheStats("gtk2 patterns",
+                                           [] (CacheReport *report) {
+                                               reportCache(patternCache,
+                                                           report);
+                                           });
+
+// A strip takes 4 bytes per pixel of its length, enough for the headers,
+// selections and buttons of a few windows.
+static const size_t stripCacheBudget = 1024 * 1024;
+
+struct StripKey {
+    PatternKey pattern;
+    int len;
+    bool horiz;
+    bool agua;
+    bool
+    operator==(const StripKey &other) const
+    {
+        return (pattern == other.pattern && len == other.len &&
+                horiz == other.horiz && agua == other.agua);
+    }
+};
+
+struct StripHash {
+    size_t
+    operator()(const StripKey &key) const
+    {
+        return hashCombine(PatternHash()(key.pattern),
+                           (uint64_t(key.len) << 2) | (key.horiz << 1) |
+                           key.agua);
+    }
+};
+
+static LRUCache<StripKey, CachedPattern, StripHash> stripCache(
+    stripCacheBudget);
+static CacheRegistration stripCacheStats("gtk2 gradient strips",
+                                         [] (CacheReport *report) {
+                                             reportCache(stripCache, report);
+                                         });
+
+// Map 0 to 1 of a pattern along the x axis onto \param from to
+// \param from + \param len - 1, along y if \param horiz.
+static void
+setAxisMatrix(cairo_pattern_t *pt, double from, int len, bool horiz)
+{
+    cairo_matrix_t matrix;
+    if (horiz) {
+        cairo_matrix_init(&matrix, 0, 1, 1.0 / (len - 1), 0,
+                          -from / (len - 1), 0);
+    } else {
+        cairo_matrix_init(&matrix, 1.0 / (len - 1), 0, 0, 1,
+                          -from / (len - 1), 0);
+    }
+    cairo_pattern_set_matrix(pt, &matrix);
+}
+
+void
+addRampStops(cairo_pattern_t *pt, const RampStops &stops, double alpha,
+             bool fadeEnd)
+{
+    for (size_t i = 0;i < stops->size();i++) {
+        const RampStop &stop = (*stops)[i];
+        bool clear = fadeEnd && i == stops->size() - 1;
+        cairo_pattern_add_color_stop_rgba(pt, stop.pos, stop.color.red,
+                                          stop.color.green, stop.color.blue,
+                                          clear ? 0.0 : alpha * stop.alpha);
+    }
+}
+
+cairo_pattern_t*
+getRampPattern(const RampStops &stops, double alpha, bool fadeEnd)
+{
+    const PatternKey key = {stops.get(), alpha, fadeEnd};
+    auto *cached = patternCache.get(key, [&] (size_t *cost) {
+            CachedPattern res;
+            res.stops = stops;
+            res.pattern.reset(cairo_pattern_create_linear(0, 0, 1, 0));
+            addRampStops(res.pattern.get(), stops, alpha, fadeEnd);
+            *cost = 256 + stops->size() * 64;
+            return res;
+        });
+    return cached->pattern.get();
+}
+
+static cairo_pattern_t*
+stripNew(const RampStops &stops, double alpha, bool fadeEnd,
+         const GdkColor *aguaMid, int len, bool horiz)
+{
+    cairo_surface_t *strip =
+        cairo_image_surface_create(CAIRO_FORMAT_ARGB32, horiz ? 1 : len,
+                                   horiz ? len : 1);
+    cairo_t *cr = cairo_create(strip);
+    if (aguaMid) {
+        // The middle stops of agua depend on the size.
+        cairo_pattern_t *pt =
+            cairo_pattern_create_linear(0, 0, horiz ? 0 : len - 1,
+                                        horiz ? len - 1 : 0);
+        double pos = AGUA_MAX / (len * 2.0);
+        addRampStops(pt, stops, alpha, fadeEnd);
+        Cairo::patternAddColorStop(pt, pos, aguaMid, alpha);
+        Cairo::patternAddColorStop(pt, 1.0 - pos, aguaMid, alpha);
+        cairo_set_source(cr, pt);
+        cairo_pattern_destroy(pt);
+    } else {
+        cairo_pattern_t *pt = getRampPattern(stops, alpha, fadeEnd);
+        setAxisMatrix(pt, 0, len, horiz);
+        cairo_set_source(cr, pt);
+    }
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    cairo_pattern_t *res = cairo_pattern_create_for_surface(strip);
+    cairo_surface_destroy(strip);
+    cairo_pattern_set_extend(res, CAIRO_EXTEND_REPEAT);
+    cairo_pattern_set_filter(res, CAIRO_FILTER_NEAREST);
+    return res;
+}
+
+void
+setGradientSource(cairo_t *cr, const RampStops &stops, double alpha,
+                  bool fadeEnd, const GdkColor *aguaMid, int x, int y,
+                  int len, bool horiz)
+{
+    if (len < 2) {
+        cairo_pattern_t *pt = cairo_pattern_create_linear(x, y, x, y);
+        addRampStops(pt, stops, alpha, fadeEnd);
+        cairo_set_source(cr, pt);
+        cairo_pattern_destroy(pt);
+        return;
+    }
+    const StripKey key = {{stops.get(), alpha, fadeEnd}, len, horiz,
+                          aguaMid != nullptr};
+    auto *cached = stripCache.get(key, [&] (size_t *cost) {
+            CachedPattern res;
+            res.stops = stops;
+            res.pattern.reset(stripNew(stops, alpha, fadeEnd, aguaMid,
+                                       len, horiz));
+            *cost = 256 + len * 4;
+            return res;
+        });
+    cairo_matrix_t matrix;
+    cairo_matrix_init_translate(&matrix, -x, -y);
+    cairo_pattern_set_matrix(cached->pattern.get(), &matrix);
+    cairo_set_source(cr, cached->pattern.get());
+}
+
+void
+clearGradientCache()
+{
+    stripCache.clear();
+    patternCache.clear();
+}
+
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef __QTC_GRADCACHE_H__
+#define __QTC_GRADCACHE_H__
+
+#include <gdk/gdk.h>
+#include <cairo.h>
+#include <qtcurve-utils/ramp.h>
+
+namespace QtCurve {
+
+/**
+ * Add \param stops to \param pt, with their alpha multiplied by \param alpha
+ * and, if \param fadeEnd, with a transparent last stop.
+ */
+void addRampStops(cairo_pattern_t *pt, const RampStops &stops, double alpha,
+                  bool fadeEnd);
+/**
+ * A linear pattern with the stops of addRampStops going from 0 to 1 along
+ * the x axis. The pattern is shared with the other users of the same ramp,
+ * its matrix should be set right before it is used as a source.
+ */
+cairo_pattern_t *getRampPattern(const RampStops &stops, double alpha,
+                                bool fadeEnd);
+/**
+ * Set the source of \param cr to the gradient of addRampStops going from
+ * (\param x, \param y) over \param len pixels, downward if \param horiz and
+ * to the right otherwise. \param aguaMid, if not NULL, is the color of the
+ * middle stops of a tall agua gradient. The gradient is rendered once into a
+ * strip that is \param len pixels long and 1 pixel wide, which is repeated
+ * across the area that is filled.
+ */
+void setGradientSource(cairo_t *cr, const RampStops &stops, double alpha,
+                       bool fadeEnd, const GdkColor *aguaMid, int x, int y,
+                       int len, bool horiz);
+void clearGradientCache();
+
+}
+
+#endif
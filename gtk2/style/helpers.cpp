@@ -83,31 +83,27 @@ shadowToBorder(GtkShadowType shadow)
 }
 
 bool
-useButtonColor(const char *detail)
+useButtonColor(const Detail &detail)
 {
-    return (detail &&
-            (oneOf(detail, "optionmenu", "button", "buttondefault",
-                   "togglebuttondefault", "togglebutton", "hscale", "vscale",
-                   "spinbutton", "spinbutton_up", "spinbutton_down", "slider",
-                   "qtc-slider", "stepper") ||
-             (detail[0] && Str::startsWith(detail + 1, "scrollbar"))));
+    return detail.flags & DETAIL_BUTTON_COLOR;
 }
 
 void
 shadeColors(const GdkColor *base, GdkColor *vals)
 {
+    static_assert(QTC_NUM_PALETTE_SHADES == ORIGINAL_SHADE + 1, "");
     bool useCustom = USE_CUSTOM_SHADES(opts);
-    double hl = TO_FACTOR(opts.highlightFactor);
+    QtcShadeParams params;
 
     for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
-        qtcShade(base, &vals[i], useCustom ? opts.customShades[i] :
-                 qtcShadeGetIntern(opts.contrast, i, opts.darkerBorders,
-                                   opts.shading), opts.shading);
+        params.factors[i] = (useCustom ? opts.customShades[i] :
+                             qtcShadeGetIntern(opts.contrast, i,
+                                               opts.darkerBorders,
+                                               opts.shading));
     }
-    qtcShade(base, &vals[SHADE_ORIG_HIGHLIGHT], hl, opts.shading);
-    qtcShade(&vals[4], &vals[SHADE_4_HIGHLIGHT], hl, opts.shading);
-    qtcShade(&vals[2], &vals[SHADE_2_HIGHLIGHT], hl, opts.shading);
-    vals[ORIGINAL_SHADE] = *base;
+    params.highlight = TO_FACTOR(opts.highlightFactor);
+    params.shading = opts.shading;
+    qtcShadeColors(base, &params, vals);
 }
 
 bool
@@ -161,9 +157,9 @@ isSortColumn(GtkWidget *button)
 };
 
 GdkColor*
-getCellCol(GdkColor *std, const char *detail)
+getCellCol(GdkColor *std, const Detail &detail)
 {
-    if (!qtSettings.shadeSortedList || !strstr(detail, "_sorted"))
+    if (!qtSettings.shadeSortedList || !(detail.flags & DETAIL_SORTED))
         return std;
 
     static GdkColor shaded;
@@ -302,11 +298,11 @@ isListViewHeader(GtkWidget *widget)
 }
 
 bool
-isEvolutionListViewHeader(GtkWidget *widget, const char *detail)
+isEvolutionListViewHeader(GtkWidget *widget, const Detail &detail)
 {
     GtkWidget *parent = nullptr;
     return ((qtSettings.app == GTK_APP_EVOLUTION) && widget &&
-            oneOf(detail, "button") &&
+            detail.type == DETAIL_BUTTON &&
             oneOf(gTypeName(widget), "ECanvas") &&
             (parent = gtk_widget_get_parent(widget)) &&
             (parent = gtk_widget_get_parent(parent)) &&
@@ -700,53 +696,54 @@ getFill(GtkStateType state, bool set, bool darker)
 }
 
 bool
-isSbarDetail(const char *detail)
+isSbarDetail(const Detail &detail)
 {
-    return (detail && detail[0] && (oneOf(detail, "stepper") ||
-                                    Str::startsWith(detail + 1, "scrollbar")));
+    return detail.flags & DETAIL_SBAR;
 }
 
 ECornerBits
-getRound(const char *detail, GtkWidget *widget, bool rev)
+getRound(const Detail &detail, GtkWidget *widget, bool rev)
 {
-    if (detail) {
-        if (oneOf(detail, "slider")) {
+    switch (detail.type) {
+    case DETAIL_SLIDER:
 #ifndef SIMPLE_SCROLLBARS
-            if (!(opts.square & SQUARE_SB_SLIDER) &&
-                (opts.scrollbarType == SCROLLBAR_NONE ||
-                 opts.flatSbarButtons)) {
-                return ROUNDED_ALL;
-            }
+        if (!(opts.square & SQUARE_SB_SLIDER) &&
+            (opts.scrollbarType == SCROLLBAR_NONE || opts.flatSbarButtons)) {
+            return ROUNDED_ALL;
+        }
 #endif
+        return ROUNDED_NONE;
+    case DETAIL_QTC_SLIDER:
+        return opts.square&SQUARE_SLIDER && (SLIDER_PLAIN == opts.sliderStyle || SLIDER_PLAIN_ROTATED == opts.sliderStyle)
+            ? ROUNDED_NONE : ROUNDED_ALL;
+    case DETAIL_SPLITTER:
+    case DETAIL_OPTION_MENU:
+    case DETAIL_TOGGLE_BUTTON:
+    case DETAIL_HSCALE:
+    case DETAIL_VSCALE:
+        return ROUNDED_ALL;
+    case DETAIL_SPIN_BUTTON_UP:
+        return rev ? ROUNDED_TOPLEFT : ROUNDED_TOPRIGHT;
+    case DETAIL_SPIN_BUTTON_DOWN:
+        return rev ? ROUNDED_BOTTOMLEFT : ROUNDED_BOTTOMRIGHT;
+    case DETAIL_BUTTON:
+        if(isListViewHeader(widget))
             return ROUNDED_NONE;
-        } else if (oneOf(detail, "qtc-slider")) {
-            return opts.square&SQUARE_SLIDER && (SLIDER_PLAIN == opts.sliderStyle || SLIDER_PLAIN_ROTATED == opts.sliderStyle)
-                ? ROUNDED_NONE : ROUNDED_ALL;
-        } else if (oneOf(detail, "splitter", "optionmenu", "togglebutton",
-                         "hscale", "vscale")) {
+        else if(isComboBoxButton(widget))
+            return rev ? ROUNDED_LEFT : ROUNDED_RIGHT;
+        else
             return ROUNDED_ALL;
-        } else if (oneOf(detail, "spinbutton_up"))
-            return rev ? ROUNDED_TOPLEFT : ROUNDED_TOPRIGHT;
-        else if(oneOf(detail, "spinbutton_down"))
-            return rev ? ROUNDED_BOTTOMLEFT : ROUNDED_BOTTOMRIGHT;
-        else if (isSbarDetail(detail)) {
-            // Requires `GtkRange::stepper-position-details = 1`
-            if (Str::endsWith(detail, "_start")) {
-                return detail[0] == 'h' ? ROUNDED_LEFT : ROUNDED_TOP;
-            } else if (Str::endsWith(detail, "_end")) {
-                return detail[0] == 'v' ? ROUNDED_BOTTOM : ROUNDED_RIGHT;
-            }
-            return ROUNDED_NONE;
-        } else if (oneOf(detail, "button")) {
-            if(isListViewHeader(widget))
-                return ROUNDED_NONE;
-            else if(isComboBoxButton(widget))
-                return rev ? ROUNDED_LEFT : ROUNDED_RIGHT;
-            else
-                return ROUNDED_ALL;
+    default:
+        break;
+    }
+    if (isSbarDetail(detail)) {
+        // Requires `GtkRange::stepper-position-details = 1`
+        if (detail.flags & DETAIL_ENDS_START) {
+            return detail.flags & DETAIL_H ? ROUNDED_LEFT : ROUNDED_TOP;
+        } else if (detail.flags & DETAIL_ENDS_END) {
+            return detail.flags & DETAIL_V ? ROUNDED_BOTTOM : ROUNDED_RIGHT;
         }
     }
-
     return ROUNDED_NONE;
 }
 
@@ -25,6 +25,7 @@
 
 #include "config.h"
 #include "qt_settings.h"
+#include "detail.h"
 #include <common/common.h>
 #include <qtcurve-cairo/utils.h>
 
@@ -102,10 +103,10 @@ isFakeGtk()
 }
 GdkColor *menuColors(bool active);
 EBorder shadowToBorder(GtkShadowType shadow);
-bool useButtonColor(const char *detail);
+bool useButtonColor(const Detail &detail);
 void shadeColors(const GdkColor *base, GdkColor *vals);
 bool isSortColumn(GtkWidget *button);
-GdkColor *getCellCol(GdkColor *std, const char *detail);
+GdkColor *getCellCol(GdkColor *std, const Detail &detail);
 bool reverseLayout(GtkWidget *widget);
 bool isOnToolbar(GtkWidget *widget, bool *horiz, int level);
 bool isOnHandlebox(GtkWidget *widget, bool *horiz, int level);
@@ -114,7 +115,7 @@ bool isButtonOnHandlebox(GtkWidget *widget, bool *horiz);
 bool isOnStatusBar(GtkWidget *widget, int level);
 bool isList(GtkWidget *widget);
 bool isListViewHeader(GtkWidget *widget);
-bool isEvolutionListViewHeader(GtkWidget *widget, const char *detail);
+bool isEvolutionListViewHeader(GtkWidget *widget, const Detail &detail);
 bool isOnListViewHeader(GtkWidget *w, int level);
 bool isPathButton(GtkWidget *widget);
 GtkWidget *getComboEntry(GtkWidget *widget);
@@ -164,7 +165,7 @@ void sanitizeSize(GdkWindow *window, int *width, int *height);
 EStepper getStepper(GtkWidget *widget, int x, int y, int width, int height);
 
 int getFill(GtkStateType state, bool set, bool darker=false);
-bool isSbarDetail(const char *detail);
+bool isSbarDetail(const Detail &detail);
 bool isHorizontalProgressbar(GtkWidget *widget);
 bool isComboBoxPopupWindow(GtkWidget *widget, int level);
 bool isComboBoxList(GtkWidget *widget);
@@ -188,7 +189,7 @@ void enableBlurBehind(GtkWidget *w, bool enable);
 void getTopLevelSize(GdkWindow *window, int *w, int *h);
 void getTopLevelOrigin(GdkWindow *window, int *x, int *y);
 bool mapToTopLevel(GdkWindow *window, GtkWidget *widget, int *x, int *y, int *w, int *h); //, bool frame)
-ECornerBits getRound(const char *detail, GtkWidget *widget, bool rev);
+ECornerBits getRound(const Detail &detail, GtkWidget *widget, bool rev);
 
 bool treeViewCellHasChildren(GtkTreeView *treeView, GtkTreePath *path);
 bool treeViewCellIsLast(GtkTreeView *treeView, GtkTreePath *path);
@@ -27,38 +27,50 @@
 #include "qt_settings.h"
 
 #include <qtcurve-utils/gtkutils.h>
-
-#include <unordered_map>
+#include <qtcurve-utils/cachestats.h>
+#include <qtcurve-utils/log.h>
 
 namespace QtCurve {
 
+// Tinted images are small (16x16 RGBA ~ 1KB), this is enough for a few
+// hundred color/shade combinations before the least recently used ones are
+// dropped.
+static const size_t pixCacheBudget = 256 * 1024;
+
 struct PixKey {
-    GdkColor col;
+    EPixmap pix;
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
     double shade;
+    bool
+    operator==(const PixKey &other) const
+    {
+        return (pix == other.pix && red == other.red &&
+                green == other.green && blue == other.blue &&
+                shade == other.shade);
+    }
 };
 
 struct PixHash {
     size_t
     operator()(const PixKey &key) const
     {
-        const GdkColor &col = key.col;
-        return (std::hash<int>()(col.red) ^
-                (std::hash<int>()(col.green) << 1) ^
-                (std::hash<int>()(col.blue) << 2) ^
-                (std::hash<double>()(key.shade) << 3));
-    }
-};
-
-struct PixEqual {
-    bool
-    operator()(const PixKey &lhs, const PixKey &rhs) const
-    {
-        return memcmp(&lhs, &rhs, sizeof(PixKey)) == 0;
+        uint64_t shade;
+        memcpy(&shade, &key.shade, sizeof(shade));
+        return hashCombine(hashMix((uint64_t(key.pix) << 48) |
+                                   (uint64_t(key.red) << 32) |
+                                   (uint64_t(key.green) << 16) |
+                                   uint64_t(key.blue)), shade);
     }
 };
 
-static std::unordered_map<PixKey, GObjPtr<GdkPixbuf>,
-                          PixHash, PixEqual> pixbufMap;
+static LRUCache<PixKey, GObjPtr<GdkPixbuf>, PixHash> pixbufCache(
+    pixCacheBudget);
+static CacheRegistration pixbufCacheStats("gtk2 pixbufs",
+                                          [] (CacheReport *report) {
+                                              reportCache(pixbufCache, report);
+                                          });
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 // Replacement isn't available until the version it is deprecated
@@ -67,36 +79,63 @@ static GObjPtr<GdkPixbuf> blankPixbuf =
     gdk_pixbuf_new_from_inline(-1, blank16x16, true, nullptr);
 #pragma GCC diagnostic pop
 
+static const uint8_t*
+pixbufCacheSource(EPixmap p)
+{
+    switch (p) {
+    case PIX_CHECK:
+        return opts.xCheck ? check_x_on : check_on;
+    default:
+        return nullptr;
+    }
+}
+
 static GdkPixbuf*
-pixbufCacheValueNew(const PixKey &key)
+pixbufCacheValueNew(const PixKey &key, size_t *cost)
 {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
     // Replacement isn't available until the version it is deprecated
     // (gdk-pixbuf-2.0 2.32)
-    GdkPixbuf *res = gdk_pixbuf_new_from_inline(-1, opts.xCheck ? check_x_on :
-                                                check_on, true, nullptr);
+    GdkPixbuf *res = gdk_pixbuf_new_from_inline(-1, pixbufCacheSource(key.pix),
+                                                true, nullptr);
 #pragma GCC diagnostic pop
     qtcAdjustPix(gdk_pixbuf_get_pixels(res), gdk_pixbuf_get_n_channels(res),
                  gdk_pixbuf_get_width(res), gdk_pixbuf_get_height(res),
-                 gdk_pixbuf_get_rowstride(res),
-                 key.col.red >> 8, key.col.green >> 8,
-                 key.col.blue >> 8, key.shade, QTC_PIXEL_GDK);
+                 gdk_pixbuf_get_rowstride(res), key.red >> 8,
+                 key.green >> 8, key.blue >> 8, key.shade, QTC_PIXEL_GDK);
+    *cost = gdk_pixbuf_get_rowstride(res) * gdk_pixbuf_get_height(res);
     return res;
 }
 
 GdkPixbuf*
 getPixbuf(GdkColor *widgetColor, EPixmap p, double shade)
 {
-    if (p != PIX_CHECK) {
+    if (!pixbufCacheSource(p)) {
         return blankPixbuf.get();
     }
-    const PixKey key = {*widgetColor, shade};
-    auto &pixbuf = pixbufMap[key];
-    if (pixbuf.get() == nullptr) {
-        pixbuf = pixbufCacheValueNew(key);
-    }
-    return pixbuf.get();
+    const PixKey key = {p, widgetColor->red, widgetColor->green,
+                        widgetColor->blue, shade};
+    auto *pixbuf = pixbufCache.get(key, [&] (size_t *cost) {
+            GObjPtr<GdkPixbuf> res(pixbufCacheValueNew(key, cost));
+            // GObjPtr takes its own reference, release the one from
+            // gdk_pixbuf_new_from_inline so that eviction frees the pixbuf.
+            g_object_unref(res.get());
+            return res;
+        });
+    return pixbuf->get();
+}
+
+void
+clearPixbufCache()
+{
+    const CacheStats &stats = pixbufCache.stats();
+    qtcDebug("Pixbuf cache: %llu hits, %llu misses, %llu evictions, "
+             "%zu entries, %zu bytes\n", (unsigned long long)stats.hits,
+             (unsigned long long)stats.misses,
+             (unsigned long long)stats.evictions, pixbufCache.size(),
+             pixbufCache.cost());
+    pixbufCache.clear();
 }
 
 }
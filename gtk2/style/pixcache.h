@@ -29,6 +29,7 @@
 namespace QtCurve {
 
 GdkPixbuf *getPixbuf(GdkColor *widgetColor, EPixmap p, double shade);
+void clearPixbufCache();
 
 }
 
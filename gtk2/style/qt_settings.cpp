@@ -28,7 +28,8 @@
 #include <qtcurve-utils/log.h>
 #include <qtcurve-utils/dirs.h>
 #include <qtcurve-utils/strs.h>
-#include <qtcurve-utils/process.h>
+#include <qtcurve-utils/ini.h>
+#include <qtcurve-utils/trace.h>
 
 #include <common/config_file.h>
 #include "helpers.h"
@@ -51,27 +52,10 @@ Options opts;
 #define qtc_gtkrc_printf(str_buff, args...)     \
     gtk_rc_parse_string(str_buff.printf(args))
 
-static char*
+static const char*
 getKdeHome()
 {
-    static uniqueStr dir = [] {
-        size_t len = 0;
-        const char *const args[] = {"kde4-config", "--localprefix", nullptr};
-        char *res = qtcPopenStdout("kde4-config", args, 300, &len);
-        if (res && res[strspn(res, " \t\b\n\f\v")]) {
-            if (res[len - 1] == '\n') {
-                res[len - 1] = '\0';
-            }
-            return res;
-        }
-        if ((res = getenv(getuid() ? "KDEHOME" : "KDEROOTHOME"))) {
-            return strdup(res);
-        }
-        // according to kdecore/kernel/kstandarddirs.h, ~/.kde is the default for KDEHOME
-        // distributions using the default should not have to patch this code.
-        return Str::cat(getHome(), ".kde");
-    };
-    return dir.get();
+    return getKDE4LocalPrefix();
 }
 
 static const char*
@@ -143,34 +127,6 @@ QtData qtSettings;
 
 #define defaultIcons() ("oxygen")
 
-enum {
-    SECT_NONE = 0x000001,
-    SECT_PALETTE = 0x000002,
-    SECT_GENERAL = 0x000004,
-    SECT_KDE = 0x000008,
-    SECT_ICONS = 0x000010,
-    SECT_TOOLBAR_STYLE = 0x000020,
-    SECT_MAIN_TOOLBAR_ICONS = 0x000040,
-    SECT_SMALL_ICONS = 0x000080,
-
-    SECT_KDE4_COL_BUTTON = 0x000100,
-    SECT_KDE4_COL_SEL = 0x000200,
-    SECT_KDE4_COL_TOOLTIP = 0x000400,
-    SECT_KDE4_COL_VIEW = 0x000800,
-    SECT_KDE4_COL_WINDOW = 0x001000,
-
-    SECT_KDE4_EFFECT_DISABLED = 0x002000,
-    SECT_KDE4_EFFECT_INACTIVE = 0x004000,
-
-    SECT_KDE4_COL_WM = 0x008000,
-
-    SECT_KWIN_COMPOS = 0x010000
-};
-
-#define ALL_KDE4_PAL_SETTINGS                                           \
-    (SECT_KDE4_COL_BUTTON | SECT_KDE4_COL_SEL | SECT_KDE4_COL_TOOLTIP | \
-     SECT_KDE4_COL_VIEW | SECT_KDE4_COL_WINDOW |                        \
-     SECT_KDE4_EFFECT_DISABLED | SECT_KDE4_EFFECT_INACTIVE | SECT_KDE4_COL_WM)
 /*
   Qt uses the following predefined weights:
     Light    = 25,
@@ -211,33 +167,6 @@ italicStr(int i)
     return i ? "Italic" : "";
 }
 
-enum {
-    RD_ACT_PALETTE = 0x000001,
-    RD_DIS_PALETTE = 0x000002,
-    RD_INACT_PALETTE = 0x000004,
-    RD_FONT = 0x000008,
-    RD_CONTRAST = 0x000010,
-    RD_ICONS = 0x000020,
-    RD_TOOLBAR_STYLE = 0x000040,
-    RD_TOOLBAR_ICON_SIZE = 0x000080,
-    RD_BUTTON_ICONS = 0x000100,
-    RD_SMALL_ICON_SIZE = 0x000200,
-    RD_LIST_COLOR = 0x000400,
-#ifdef QTC_GTK2_STYLE_SUPPORT
-    RD_STYLE = 0x000800,
-#else
-    RD_STYLE = 0x000000,
-#endif
-    RD_LIST_SHADE = 0x001000,
-    RD_KDE4_PAL = 0x002000,
-
-    RD_MENU_FONT = 0x004000,
-    RD_TB_FONT = 0x008000,
-
-    RD_DRAG_DIST = 0x010000,
-    RD_DRAG_TIME = 0x020000
-};
-
 #ifdef QTC_GTK2_STYLE_SUPPORT
 static char*
 themeFileSub(const char *prefix, const char *name, Str::Buff &str_buff,
@@ -260,16 +189,6 @@ themeFile(const char *prefix, const char *name, Str::Buff &str_buff)
 }
 #endif
 
-typedef enum {
-    BackgroundAlternate,
-    BackgroundNormal,
-    DecorationFocus,
-    DecorationHover,
-    ForegroundNormal,
-
-    UnknownColor
-} ColorType;
-
 typedef enum  // Taken from "kcolorscheme.cpp"
 {
     // Effects
@@ -312,31 +231,15 @@ typedef enum
     EFF_INACTIVE
 } Effect;
 
-static ColorType getColorType(const char *line)
-{
-    if(0==strncasecmp(line, "BackgroundAlternate=", 20))
-        return BackgroundAlternate;
-    if(0==strncasecmp(line, "BackgroundNormal=", 17))
-        return BackgroundNormal;
-    if(0==strncasecmp(line, "ForegroundNormal=", 17))
-        return ForegroundNormal;
-    if(0==strncasecmp(line, "DecorationFocus=", 16))
-        return DecorationFocus;
-    if(0==strncasecmp(line, "DecorationHover=", 16))
-        return DecorationHover;
-    return UnknownColor;
-}
-
-static GdkColor readColor(const char *line)
+static GdkColor
+readColor(const char *val)
 {
-    const char *eq = strchr(line, '=');
     GdkColor col;
     int red;
     int green;
     int blue;
 
-    if (eq && ++eq && *eq != '\0' &&
-        sscanf(eq, "%d,%d,%d", &red, &green, &blue) == 3) {
+    if (sscanf(val, "%d,%d,%d", &red, &green, &blue) == 3) {
         col.red = toGtkColor(red);
         col.green = toGtkColor(green);
         col.blue = toGtkColor(blue);
@@ -346,20 +249,22 @@ static GdkColor readColor(const char *line)
     return col;
 }
 
-static int readInt(const char *line, int offset)
+static int
+readInt(const char *val)
 {
-    return line[offset]!='\0' ? atoi(&line[offset]) : 0;
+    return atoi(val);
 }
 
-static double readDouble(const char *line, int offset)
+static double
+readDouble(const char *val)
 {
-    return line[offset]!='\0' ? g_ascii_strtod(&line[offset], nullptr) : 0;
+    return g_ascii_strtod(val, nullptr);
 }
 
 static bool
-readBool(const char *line, int offset)
+readBool(const char *val)
 {
-    return line[offset]!='\0' ? 0==strncasecmp(&line[offset], "true", 4) : false;
+    return strncasecmp(val, "true", 4) == 0;
 }
 
 typedef struct
@@ -385,18 +290,17 @@ static void initFont(QtFontDetails *f, bool setFamily)
 }
 
 static void
-parseFontLine(const char *line, QtFontDetails *font)
+parseFontLine(const char *val, QtFontDetails *font)
 {
-    int n = -1;
-    char *l;
-    char fontLine[MAX_CONFIG_INPUT_LINE_LEN+1];
+    char fontLine[MAX_CONFIG_INPUT_LINE_LEN + 1];
     QtFontDetails rc;
 
     initFont(&rc, false);
-    memcpy(fontLine, line, MAX_CONFIG_INPUT_LINE_LEN + 1);
-    l = strtok(fontLine, "=");
+    strncpy(fontLine, val, MAX_CONFIG_INPUT_LINE_LEN);
+    fontLine[MAX_CONFIG_INPUT_LINE_LEN] = '\0';
 
-    while (l) {
+    int n = 0;
+    for (char *l = strtok(fontLine, ",");l;l = strtok(nullptr, ","), n++) {
         switch (n) {
         case 0: {
             /* Family - and foundry(maybe!) (ignore X11 and XFT) */
@@ -418,21 +322,15 @@ parseFontLine(const char *line, QtFontDetails *font)
             break;
         case 8:  /* Spacing */
             sscanf(l, "%d", &rc.fixedW);
-            break;
-        default:
-            break;
-        }
-
-        n++;
-        if (n>8 && font->family[0]) {
             font->weight = rc.weight;
             font->italic = rc.italic;
             font->fixedW = rc.fixedW;
             font->size = rc.size;
             strcpy(font->family, rc.family);
+            return;
+        default:
             break;
         }
-        l = strtok(nullptr, ",");
     }
 }
 
@@ -496,353 +394,212 @@ GdkColor mixColors(const GdkColor *c1, const GdkColor *c2, double bias)
 
 static void readKwinrc()
 {
-    if (FILE *f = fopen(kwinrc(), "r")) {
-        int  section = SECT_NONE;
-        char line[MAX_CONFIG_INPUT_LINE_LEN + 1];
-
+    IniFile ini;
+    if (ini.load(kwinrc())) {
         if (qtSettings.debug)
             fprintf(stderr, DEBUG_PREFIX "Reading kwinrc\n");
 
-        while(nullptr!=fgets(line, MAX_CONFIG_INPUT_LINE_LEN, f))
-            if(line[0]=='[')
-            {
-                if(0==strncasecmp(line, "[Compositing]", 13))
-                    section=SECT_KWIN_COMPOS;
-                else
-                    section=SECT_NONE;
-            }
-            else if (SECT_KWIN_COMPOS==section && 0==strncasecmp(line, "Backend=", 8))
-            {
-                if (strstr(line, "=XRender"))
-                    opts.square|=SQUARE_POPUP_MENUS|SQUARE_TOOLTIPS;
-                break;
-            }
-        fclose(f);
+        const char *backend = ini.value("Compositing", "Backend");
+        if (backend && Str::startsWith(backend, "XRender")) {
+            opts.square |= SQUARE_POPUP_MENUS | SQUARE_TOOLTIPS;
+        }
     }
 }
 
-static void readKdeGlobals(const char *rc, int rd, bool first)
+// Bump when the format of IniFile::serialize changes.
+#define KDEGLOBALS_CACHE_LAYOUT 1
+
+// Merge all the kdeglobals files, later files override earlier ones. The
+// merged result is cached and only read again when one of the files changes.
+static void
+loadKdeGlobals(IniFile *ini)
 {
-    ColorEffect   effects[2];
-    int found = 0;
-    int colorsFound = 0;
-    char          line[MAX_CONFIG_INPUT_LINE_LEN+1];
-    FILE          *f=fopen(rc, "r");
-    QtFontDetails fonts[FONT_NUM_STD];
-
-    for (int i = 0;i < FONT_NUM_STD;++i) {
-        initFont(&fonts[i], true);
+    const std::initializer_list<const char*> files = {
+        QTC_GTK2_THEME_DIR"/kdeglobals", /* QtCurve supplied kdeglobals file */
+        "/etc/kderc",
+        "/etc/kde4/kdeglobals",
+        "/etc/kde4rc",
+        QTC_KDE4_PREFIX KDE4_SYS_CFG_DIR KDEGLOBALS_FILE,
+        QTC_KDE4_PREFIX KDE4_SYS_CFG_DIR KDEGLOBALS_SYS_FILE,
+        kde4Globals(),
+        kde5Globals()
+    };
+    ConfCache::File cache(getConfFile(std::string("kdeglobals.gtk2.cache")),
+                          files, KDEGLOBALS_CACHE_LAYOUT, false);
+    if (cache.load()) {
+        ConfCache::Reader r(cache.reader());
+        if (ini->deserialize(r) && r.atEnd()) {
+            return;
+        }
+        ini->clear();
     }
-
-    if(first)
-    {
-        // Set defaults!
-        effects[EFF_DISABLED].col.red=112;
-        effects[EFF_DISABLED].col.green=111;
-        effects[EFF_DISABLED].col.blue=110;
-        effects[EFF_DISABLED].color.amount=0.0;
-        effects[EFF_DISABLED].color.effect=ColorNoEffect;
-        effects[EFF_DISABLED].contrast.amount=0.65;
-        effects[EFF_DISABLED].contrast.effect=ContrastFade;
-        effects[EFF_DISABLED].intensity.amount=0.1;
-        effects[EFF_DISABLED].intensity.effect=IntensityDarken;
-        effects[EFF_DISABLED].enabled=true;
-        effects[EFF_INACTIVE].col.red=112;
-        effects[EFF_INACTIVE].col.green=111;
-        effects[EFF_INACTIVE].col.blue=110;
-        effects[EFF_INACTIVE].color.amount=0.0;
-        effects[EFF_INACTIVE].color.effect=ColorNoEffect;
-        effects[EFF_INACTIVE].contrast.amount=0.0;
-        effects[EFF_INACTIVE].contrast.effect=ContrastNoEffect;
-        effects[EFF_INACTIVE].intensity.amount=0.0;
-        effects[EFF_INACTIVE].intensity.effect=IntensityNoEffect;
-        effects[EFF_INACTIVE].enabled=false;
-
-        qtSettings.colors[PAL_ACTIVE][COLOR_BUTTON]=setGdkColor(232, 231, 230);
-        qtSettings.colors[PAL_ACTIVE][COLOR_BUTTON_TEXT]=setGdkColor(20, 19, 18);
-        qtSettings.colors[PAL_ACTIVE][COLOR_SELECTED]=setGdkColor(65, 139, 212);
-        qtSettings.colors[PAL_ACTIVE][COLOR_TEXT_SELECTED]=setGdkColor(255, 255, 255);
-        qtSettings.colors[PAL_ACTIVE][COLOR_TOOLTIP]=setGdkColor(192, 218, 255);
-        qtSettings.colors[PAL_ACTIVE][COLOR_TOOLTIP_TEXT]=setGdkColor(20, 19, 18);
-        qtSettings.colors[PAL_ACTIVE][COLOR_BACKGROUND]=setGdkColor(255, 255, 255);
-        qtSettings.colors[PAL_ACTIVE][COLOR_TEXT]=setGdkColor(20, 19, 18);
-        qtSettings.colors[PAL_ACTIVE][COLOR_LV]=setGdkColor(248, 247, 246);
-        qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW]=setGdkColor(233, 232, 232);
-        qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_TEXT]=setGdkColor(20, 19, 18);
-        qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_BORDER]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW];
-        qtSettings.colors[PAL_INACTIVE][COLOR_WINDOW_BORDER]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW];
-        qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_BORDER_TEXT]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_TEXT];
-        qtSettings.colors[PAL_INACTIVE][COLOR_WINDOW_BORDER_TEXT]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_TEXT];
-
-        qtSettings.colors[PAL_ACTIVE][COLOR_FOCUS]=setGdkColor( 43, 116, 199);
-        qtSettings.colors[PAL_ACTIVE][COLOR_HOVER]=setGdkColor(119, 183, 255);
+    for (const char *file: files) {
+        if (ini->load(file) && qtSettings.debug) {
+            fprintf(stderr, DEBUG_PREFIX"Reading kdeglobals - %s\n", file);
+        }
     }
+    ConfCache::Writer w;
+    ini->serialize(w);
+    cache.save(w);
+}
 
-    if(f)
-    {
-        int section=SECT_NONE;
-
-        if(qtSettings.debug)
-            fprintf(stderr, DEBUG_PREFIX"Reading kdeglobals - %s\n", rc);
+typedef struct {
+    const char *group;
+    const char *key;
+    int pal;
+    int color;
+} KdeColor;
+
+static const KdeColor kdeColors[] = {
+    {"Colors:Button", "BackgroundNormal", PAL_ACTIVE, COLOR_BUTTON},
+    {"Colors:Button", "ForegroundNormal", PAL_ACTIVE, COLOR_BUTTON_TEXT},
+    {"Colors:Button", "DecorationFocus", PAL_ACTIVE, COLOR_FOCUS},
+    {"Colors:Button", "DecorationHover", PAL_ACTIVE, COLOR_HOVER},
+    {"Colors:Selection", "BackgroundNormal", PAL_ACTIVE, COLOR_SELECTED},
+    {"Colors:Selection", "ForegroundNormal", PAL_ACTIVE, COLOR_TEXT_SELECTED},
+    {"Colors:Tooltip", "BackgroundNormal", PAL_ACTIVE, COLOR_TOOLTIP},
+    {"Colors:Tooltip", "ForegroundNormal", PAL_ACTIVE, COLOR_TOOLTIP_TEXT},
+    {"Colors:View", "BackgroundNormal", PAL_ACTIVE, COLOR_BACKGROUND},
+    {"Colors:View", "ForegroundNormal", PAL_ACTIVE, COLOR_TEXT},
+    {"Colors:View", "BackgroundAlternate", PAL_ACTIVE, COLOR_LV},
+    {"Colors:Window", "BackgroundNormal", PAL_ACTIVE, COLOR_WINDOW},
+    {"Colors:Window", "ForegroundNormal", PAL_ACTIVE, COLOR_WINDOW_TEXT},
+    {"WM", "activeBackground", PAL_ACTIVE, COLOR_WINDOW_BORDER},
+    {"WM", "activeForeground", PAL_ACTIVE, COLOR_WINDOW_BORDER_TEXT},
+    {"WM", "inactiveBackground", PAL_INACTIVE, COLOR_WINDOW_BORDER},
+    {"WM", "inactiveForeground", PAL_INACTIVE, COLOR_WINDOW_BORDER_TEXT}
+};
 
-        while(found!=rd && nullptr!=fgets(line, MAX_CONFIG_INPUT_LINE_LEN, f))
-            if(line[0]=='[')
-            {
-                if(0==strncasecmp(line, "[Icons]", 7))
-                    section=SECT_ICONS;
-                else if(0==strncasecmp(line, "[Toolbar style]", 15))
-                    section=SECT_TOOLBAR_STYLE;
-                else if(0==strncasecmp(line, "[MainToolbarIcons]", 18))
-                    section=SECT_MAIN_TOOLBAR_ICONS;
-                else if(0==strncasecmp(line, "[SmallIcons]", 12))
-                    section=SECT_SMALL_ICONS;
-                else if(0==strncasecmp(line, "[Colors:View]", 13))
-                    section=SECT_KDE4_COL_VIEW;
-                else if(0==strncasecmp(line, "[Colors:Button]", 15))
-                    section=SECT_KDE4_COL_BUTTON;
-                else if(0==strncasecmp(line, "[Colors:Selection]", 18))
-                    section=SECT_KDE4_COL_SEL;
-                else if(0==strncasecmp(line, "[Colors:Tooltip]", 16))
-                    section=SECT_KDE4_COL_TOOLTIP;
-                else if(0==strncasecmp(line, "[Colors:Window]", 15))
-                    section=SECT_KDE4_COL_WINDOW;
-                else if(0==strncasecmp(line, "[ColorEffects:Disabled]", 23))
-                    section=SECT_KDE4_EFFECT_DISABLED;
-                else if(0==strncasecmp(line, "[ColorEffects:Inactive]", 23))
-                    section=SECT_KDE4_EFFECT_INACTIVE;
-                else if(0==strncasecmp(line, "[General]", 9))
-                    section=SECT_GENERAL;
-                else if(0==strncasecmp(line, "[KDE]", 5))
-                    section=SECT_KDE;
-                else if(0==strncasecmp(line, "[WM]", 4))
-                    section=SECT_KDE4_COL_WM;
-                else
-                {
-                    section=SECT_NONE;
-                    if(colorsFound==ALL_KDE4_PAL_SETTINGS)
-                        found|=RD_KDE4_PAL;
-                    if(found==rd)
-                        break;
-                }
-            }
-            else if (SECT_ICONS==section && rd&RD_ICONS && !(found&RD_ICONS) &&
-                     0==strncasecmp(line, "Theme=", 6)) {
-                char *eq = strstr(line, "=");
-
-                if(eq && ++eq) {
-                    unsigned int len = strlen(eq);
-
-                    qtSettings.icons = (char*)realloc(qtSettings.icons,
-                                                      len + 1);
-                    strcpy(qtSettings.icons, eq);
-                    if('\n'==qtSettings.icons[len-1])
-                        qtSettings.icons[len-1]='\0';
-                }
-                found|=RD_ICONS;
-            }
-            else if (SECT_SMALL_ICONS==section && rd&RD_SMALL_ICON_SIZE && !(found&RD_SMALL_ICON_SIZE) &&
-                     0==strncasecmp(line, "Size=", 5))
-            {
-                int size=readInt(line, 5);
+static void
+readColorEffect(const IniFile &ini, const char *group, ColorEffect *effect)
+{
+    if (const char *val = ini.value(group, "Color"))
+        effect->col = readColor(val);
+    if (const char *val = ini.value(group, "ColorAmount"))
+        effect->color.amount = readDouble(val);
+    if (const char *val = ini.value(group, "ColorEffect"))
+        effect->color.effect = (ColAdjustEffects)readInt(val);
+    if (const char *val = ini.value(group, "ContrastAmount"))
+        effect->contrast.amount = readDouble(val);
+    if (const char *val = ini.value(group, "ContrastEffect"))
+        effect->contrast.effect = (ColAdjustEffects)readInt(val);
+    if (const char *val = ini.value(group, "IntensityAmount"))
+        effect->intensity.amount = readDouble(val);
+    if (const char *val = ini.value(group, "IntensityEffect"))
+        effect->intensity.effect = (ColAdjustEffects)readInt(val);
+    if (const char *val = ini.value(group, "Enable"))
+        effect->enabled = readBool(val);
+    if (const char *val = ini.value(group, "ChangeSelectionColor"))
+        qtSettings.inactiveChangeSelectionColor = readBool(val);
+}
 
-                if(0!=size)
-                {
-                    qtSettings.iconSizes.smlTbSize=size;
-                    qtSettings.iconSizes.btnSize=size;
-                    qtSettings.iconSizes.mnuSize=size;
-                    found|=RD_SMALL_ICON_SIZE;
-                }
-            }
-            else if (SECT_TOOLBAR_STYLE==section && rd&RD_TOOLBAR_STYLE &&
-                     !(found&RD_TOOLBAR_STYLE) &&
-                     0==strncasecmp(line, "ToolButtonStyle=", 16)) {
-                char *eq = strstr(line, "=");
+static void
+readFont(const IniFile &ini, const char *key, int f)
+{
+    if (const char *val = ini.value("General", key)) {
+        QtFontDetails font;
+        initFont(&font, true);
+        parseFontLine(val, &font);
+        setFont(&font, f);
+    }
+}
 
-                if(eq && ++eq)
-                {
-                    if(0==strncasecmp(eq, "IconOnly", 8))
-                        qtSettings.toolbarStyle=GTK_TOOLBAR_ICONS;
-                    else if(0==strncasecmp(eq, "TextOnly", 8))
-                        qtSettings.toolbarStyle=GTK_TOOLBAR_TEXT;
-                    else if (0==strncasecmp(eq, "TextBesideIcon", 14))
-                        qtSettings.toolbarStyle=GTK_TOOLBAR_BOTH_HORIZ;
-                    else if (0==strncasecmp(eq, "TextUnderIcon", 13))
-                        qtSettings.toolbarStyle=GTK_TOOLBAR_BOTH;
-                    found|=RD_TOOLBAR_STYLE;
-                }
-            }
-            else if (SECT_MAIN_TOOLBAR_ICONS==section && rd&RD_TOOLBAR_ICON_SIZE &&
-                        !(found&RD_TOOLBAR_ICON_SIZE) && 0==strncasecmp(line, "Size=", 5))
-            {
-                qtSettings.iconSizes.tbSize = readInt(line, 5);
-                found|=RD_TOOLBAR_ICON_SIZE;
-            }
-            else if (SECT_KDE==section && rd&RD_BUTTON_ICONS && !(found&RD_BUTTON_ICONS) &&
-                        0==strncasecmp(line, "ShowIconsOnPushButtons=", 23))
-            {
-                qtSettings.buttonIcons=readBool(line, 23);
-                found|=RD_BUTTON_ICONS;
-            }
-//             else if (SECT_KDE==section && rd&RD_DRAG_DIST && !(found&RD_DRAG_DIST) &&
-//                         0==strncasecmp(line, "StartDragDist=", 14))
-//             {
-//                 qtSettings.startDragDist=readInt(line, 14);
-//                 found|=RD_DRAG_DIST;
-//             }
-            else if (SECT_KDE==section && rd&RD_DRAG_TIME && !(found&RD_DRAG_TIME) &&
-                        0==strncasecmp(line, "StartDragTime=", 14))
-            {
-                qtSettings.startDragTime=readInt(line, 14);
-                found|=RD_DRAG_TIME;
-            }
-            else if (SECT_KDE4_COL_WM==section && rd&RD_KDE4_PAL &&
-                     !(found&RD_KDE4_PAL)) {
-                colorsFound|=section;
-                if(0==strncasecmp(line, "activeBackground=", 17))
-                    qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_BORDER]=readColor(line);
-                else if(0==strncasecmp(line, "activeForeground=", 17))
-                    qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_BORDER_TEXT]=readColor(line);
-                else if(0==strncasecmp(line, "inactiveBackground=", 19))
-                    qtSettings.colors[PAL_INACTIVE][COLOR_WINDOW_BORDER]=readColor(line);
-                else if(0==strncasecmp(line, "inactiveForeground=", 19))
-                    qtSettings.colors[PAL_INACTIVE][COLOR_WINDOW_BORDER_TEXT]=readColor(line);
-            } else if (section>=SECT_KDE4_COL_BUTTON &&
-                       section<=SECT_KDE4_COL_WINDOW &&
-                       rd&RD_KDE4_PAL && !(found&RD_KDE4_PAL)) {
-                ColorType colorType=getColorType(line);
-
-                colorsFound|=section;
-                if(UnknownColor!=colorType)
-                {
-                    GdkColor color=readColor(line);
-
-                    switch(section)
-                    {
-                        case SECT_KDE4_COL_BUTTON:
-                            switch(colorType) {
-                            case BackgroundNormal:
-                                qtSettings.colors[PAL_ACTIVE][COLOR_BUTTON]=color;
-                                break;
-                            case ForegroundNormal:
-                                qtSettings.colors[PAL_ACTIVE][COLOR_BUTTON_TEXT]=color;
-                                break;
-                            case DecorationFocus:
-                                qtSettings.colors[PAL_ACTIVE][COLOR_FOCUS]=color;
-                                break;
-                            case DecorationHover:
-                                qtSettings.colors[PAL_ACTIVE][COLOR_HOVER]=color;
-                                break;
-                            default:
-                                break;
-                            }
-                            break;
-                        case SECT_KDE4_COL_SEL:
-                            if(BackgroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_SELECTED]=color;
-                            else if(ForegroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_TEXT_SELECTED]=color;
-                            break;
-                        case SECT_KDE4_COL_TOOLTIP:
-                            if(BackgroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_TOOLTIP]=color;
-                            else if(ForegroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_TOOLTIP_TEXT]=color;
-                            break;
-                        case SECT_KDE4_COL_VIEW:
-                            if(BackgroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_BACKGROUND]=color;
-                            else if(ForegroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_TEXT]=color;
-                            else if(BackgroundAlternate==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_LV]=color;
-                            break;
-                        case SECT_KDE4_COL_WINDOW:
-                            if(BackgroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW]=color;
-                            else if(ForegroundNormal==colorType)
-                                qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_TEXT]=color;
-                            break;
-                        default:
-                            break;
-                    }
-                }
-            } else if (SECT_GENERAL==section && rd&RD_FONT && !(found&RD_FONT) &&
-                       0==strncasecmp(line, "font=", 5)) {
-                parseFontLine(line, &fonts[FONT_GENERAL]);
-                found|=RD_FONT;
-            }
-            else if (SECT_GENERAL==section && rd&RD_MENU_FONT && !(found&RD_MENU_FONT) &&
-                     0==strncasecmp(line, "menuFont=", 9))
-            {
-                parseFontLine(line, &fonts[FONT_MENU]);
-                found|=RD_MENU_FONT;
-            }
-            else if (SECT_GENERAL==section && rd&RD_TB_FONT && !(found&RD_TB_FONT) &&
-                     0==strncasecmp(line, "toolBarFont=", 12))
-            {
-                parseFontLine(line, &fonts[FONT_TOOLBAR]);
-                found|=RD_TB_FONT;
-            } else if (rd&RD_CONTRAST && !(found&RD_CONTRAST) &&
-                       SECT_KDE==section && 0==strncasecmp(line, "contrast=", 9)) {
-                opts.contrast=readInt(line, 9);
-                if(opts.contrast>10 || opts.contrast<0)
-                    opts.contrast=DEFAULT_CONTRAST;
-                found|=RD_CONTRAST;
-            }
-#ifdef QTC_GTK2_STYLE_SUPPORT
-            else if(SECT_GENERAL==section && rd&RD_STYLE && !(found&RD_STYLE) &&
-                    0==strncasecmp(line, "widgetStyle=", 12)) {
-                int len=strlen(line);
-                qtSettings.styleName=realloc(qtSettings.styleName, strlen(&line[12])+1);
-                if('\n'==line[len-1])
-                    line[len-1]='\0';
-                strcpy(qtSettings.styleName, &line[12]);
-                found|=RD_STYLE;
-            }
-#endif
-            else if((SECT_KDE4_EFFECT_DISABLED==section ||
-                     SECT_KDE4_EFFECT_INACTIVE==section) &&
-                    rd&RD_KDE4_PAL && !(found&RD_KDE4_PAL)) {
-                colorsFound|=section;
-                Effect eff=SECT_KDE4_EFFECT_DISABLED==section ? EFF_DISABLED : EFF_INACTIVE;
-                if(0==strncasecmp(line, "Color=", 6))
-                    effects[eff].col=readColor(line);
-                else if(0==strncasecmp(line, "ColorAmount=", 12))
-                    effects[eff].color.amount=readDouble(line, 12);
-                else if(0==strncasecmp(line, "ColorEffect=", 12))
-                    effects[eff].color.effect =
-                        (ColAdjustEffects)readInt(line, 12);
-                else if(0==strncasecmp(line, "ContrastAmount=", 15))
-                    effects[eff].contrast.amount=readDouble(line, 15);
-                else if(0==strncasecmp(line, "ContrastEffect=", 15))
-                    effects[eff].contrast.effect =
-                        (ColAdjustEffects)readInt(line, 15);
-                else if(0==strncasecmp(line, "IntensityAmount=", 16))
-                    effects[eff].intensity.amount=readDouble(line, 16);
-                else if(0==strncasecmp(line, "IntensityEffect=", 16))
-                    effects[eff].intensity.effect =
-                        (ColAdjustEffects)readInt(line, 16);
-                else if(0==strncasecmp(line, "Enable=", 7))
-                    effects[eff].enabled=readBool(line, 7);
-                else if(0==strncasecmp(line, "ChangeSelectionColor=", 21))
-                    qtSettings.inactiveChangeSelectionColor=readBool(line, 21);
-            }
-            else if(SECT_GENERAL==section && rd&RD_LIST_SHADE && !(found&RD_LIST_SHADE) &&
-                    0==strncasecmp(line, "shadeSortColumn=", 16))
-            {
-                qtSettings.shadeSortedList=readBool(line, 16);
-                found|=RD_LIST_SHADE;
-            }
-            else if(found==rd)
-                break;
+static void readKdeGlobals(const IniFile &ini)
+{
+    ColorEffect effects[2];
+
+    // Set defaults!
+    effects[EFF_DISABLED].col.red=112;
+    effects[EFF_DISABLED].col.green=111;
+    effects[EFF_DISABLED].col.blue=110;
+    effects[EFF_DISABLED].color.amount=0.0;
+    effects[EFF_DISABLED].color.effect=ColorNoEffect;
+    effects[EFF_DISABLED].contrast.amount=0.65;
+    effects[EFF_DISABLED].contrast.effect=ContrastFade;
+    effects[EFF_DISABLED].intensity.amount=0.1;
+    effects[EFF_DISABLED].intensity.effect=IntensityDarken;
+    effects[EFF_DISABLED].enabled=true;
+    effects[EFF_INACTIVE].col.red=112;
+    effects[EFF_INACTIVE].col.green=111;
+    effects[EFF_INACTIVE].col.blue=110;
+    effects[EFF_INACTIVE].color.amount=0.0;
+    effects[EFF_INACTIVE].color.effect=ColorNoEffect;
+    effects[EFF_INACTIVE].contrast.amount=0.0;
+    effects[EFF_INACTIVE].contrast.effect=ContrastNoEffect;
+    effects[EFF_INACTIVE].intensity.amount=0.0;
+    effects[EFF_INACTIVE].intensity.effect=IntensityNoEffect;
+    effects[EFF_INACTIVE].enabled=false;
+
+    qtSettings.colors[PAL_ACTIVE][COLOR_BUTTON]=setGdkColor(232, 231, 230);
+    qtSettings.colors[PAL_ACTIVE][COLOR_BUTTON_TEXT]=setGdkColor(20, 19, 18);
+    qtSettings.colors[PAL_ACTIVE][COLOR_SELECTED]=setGdkColor(65, 139, 212);
+    qtSettings.colors[PAL_ACTIVE][COLOR_TEXT_SELECTED]=setGdkColor(255, 255, 255);
+    qtSettings.colors[PAL_ACTIVE][COLOR_TOOLTIP]=setGdkColor(192, 218, 255);
+    qtSettings.colors[PAL_ACTIVE][COLOR_TOOLTIP_TEXT]=setGdkColor(20, 19, 18);
+    qtSettings.colors[PAL_ACTIVE][COLOR_BACKGROUND]=setGdkColor(255, 255, 255);
+    qtSettings.colors[PAL_ACTIVE][COLOR_TEXT]=setGdkColor(20, 19, 18);
+    qtSettings.colors[PAL_ACTIVE][COLOR_LV]=setGdkColor(248, 247, 246);
+    qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW]=setGdkColor(233, 232, 232);
+    qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_TEXT]=setGdkColor(20, 19, 18);
+    qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_BORDER]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW];
+    qtSettings.colors[PAL_INACTIVE][COLOR_WINDOW_BORDER]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW];
+    qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_BORDER_TEXT]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_TEXT];
+    qtSettings.colors[PAL_INACTIVE][COLOR_WINDOW_BORDER_TEXT]=qtSettings.colors[PAL_ACTIVE][COLOR_WINDOW_TEXT];
+
+    qtSettings.colors[PAL_ACTIVE][COLOR_FOCUS]=setGdkColor( 43, 116, 199);
+    qtSettings.colors[PAL_ACTIVE][COLOR_HOVER]=setGdkColor(119, 183, 255);
+
+    for (const auto &color: kdeColors) {
+        if (const char *val = ini.value(color.group, color.key)) {
+            qtSettings.colors[color.pal][color.color] = readColor(val);
+        }
+    }
+    readColorEffect(ini, "ColorEffects:Disabled", &effects[EFF_DISABLED]);
+    readColorEffect(ini, "ColorEffects:Inactive", &effects[EFF_INACTIVE]);
 
-        fclose(f);
+    if (const char *val = ini.value("Icons", "Theme")) {
+        qtSettings.icons = Str::fill(qtSettings.icons, val);
     }
-    else if (!first)
-    {
-        // don't repeat the settings below, as that would probably override settings read from file.
-        return;
+    if (const char *val = ini.value("SmallIcons", "Size")) {
+        if (int size = readInt(val)) {
+            qtSettings.iconSizes.smlTbSize = size;
+            qtSettings.iconSizes.btnSize = size;
+            qtSettings.iconSizes.mnuSize = size;
+        }
+    }
+    qtSettings.toolbarStyle = GTK_TOOLBAR_ICONS;
+    if (const char *val = ini.value("Toolbar style", "ToolButtonStyle")) {
+        if (0==strncasecmp(val, "TextOnly", 8))
+            qtSettings.toolbarStyle=GTK_TOOLBAR_TEXT;
+        else if (0==strncasecmp(val, "TextBesideIcon", 14))
+            qtSettings.toolbarStyle=GTK_TOOLBAR_BOTH_HORIZ;
+        else if (0==strncasecmp(val, "TextUnderIcon", 13))
+            qtSettings.toolbarStyle=GTK_TOOLBAR_BOTH;
+    }
+    if (const char *val = ini.value("MainToolbarIcons", "Size")) {
+        qtSettings.iconSizes.tbSize = readInt(val);
+    }
+    const char *buttonIcons = ini.value("KDE", "ShowIconsOnPushButtons");
+    qtSettings.buttonIcons = !buttonIcons || readBool(buttonIcons);
+    if (const char *val = ini.value("KDE", "StartDragTime")) {
+        qtSettings.startDragTime = readInt(val);
+    }
+    if (const char *val = ini.value("KDE", "contrast")) {
+        opts.contrast = readInt(val);
+        if (opts.contrast > 10 || opts.contrast < 0) {
+            opts.contrast = DEFAULT_CONTRAST;
+        }
     }
+    const char *shadeSorted = ini.value("General", "shadeSortColumn");
+    qtSettings.shadeSortedList = !shadeSorted || readBool(shadeSorted);
+#ifdef QTC_GTK2_STYLE_SUPPORT
+    if (const char *val = ini.value("General", "widgetStyle")) {
+        qtSettings.styleName = Str::fill(qtSettings.styleName, val);
+    }
+#endif
+    readFont(ini, "font", FONT_GENERAL);
+    readFont(ini, "menuFont", FONT_MENU);
+    readFont(ini, "toolBarFont", FONT_TOOLBAR);
 
     int eff = 0;
     double contrast = 0.1 * opts.contrast;
@@ -931,24 +688,9 @@ static void readKdeGlobals(const char *rc, int rd, bool first)
             qtSettings.inactiveChangeSelectionColor=false;
 #endif
 
-    if(rd&RD_ICONS && !qtSettings.icons)
-    {
-        qtSettings.icons=(char *)realloc(qtSettings.icons, strlen(defaultIcons())+1);
-        strcpy(qtSettings.icons, defaultIcons());
+    if (!qtSettings.icons) {
+        qtSettings.icons = Str::fill(qtSettings.icons, defaultIcons());
     }
-    if(rd&RD_TOOLBAR_STYLE && !(found&RD_TOOLBAR_STYLE))
-        qtSettings.toolbarStyle=GTK_TOOLBAR_ICONS;
-    if(rd&RD_BUTTON_ICONS && !(found&RD_BUTTON_ICONS))
-        qtSettings.buttonIcons=true;
-    if(rd&RD_LIST_SHADE && !(found&RD_LIST_SHADE))
-        qtSettings.shadeSortedList=true;
-    //if(rd&RD_FONT && (found&RD_FONT || (!qtSettings.fonts[FONT_GENERAL] && kde4)))  /* No need to check if read in */
-    if(rd&RD_FONT && found&RD_FONT)
-        setFont(&fonts[FONT_GENERAL], FONT_GENERAL);
-    if(rd&RD_MENU_FONT && found&RD_MENU_FONT)
-        setFont(&fonts[FONT_MENU], FONT_MENU);
-    if(rd&RD_TB_FONT && found&RD_TB_FONT)
-        setFont(&fonts[FONT_TOOLBAR], FONT_TOOLBAR);
 }
 
 static int qt_refs = 0;
@@ -956,22 +698,7 @@ static int qt_refs = 0;
 static const char*
 kdeIconsPrefix()
 {
-    static uniqueStr dir = [] {
-        size_t len = 0;
-        const char *const args[] = {"kde4-config", "--install", "icon",
-                                    nullptr};
-        char *res = qtcPopenStdout("kde4-config", args, 300, &len);
-        if (res && res[strspn(res, " \t\b\n\f\v")]) {
-            if (res[len - 1]=='\n') {
-                res[len - 1]='\0';
-            }
-            return res;
-        }
-        return strdup(QTC_KDE4_ICONS_PREFIX &&
-                      strlen(QTC_KDE4_ICONS_PREFIX) > 2 ?
-                      QTC_KDE4_ICONS_PREFIX : DEFAULT_ICON_PREFIX);
-    };
-    return dir.get();
+    return getKDE4IconsPrefix();
 }
 
 static char*
@@ -1093,6 +820,7 @@ debugLevel()
 bool
 qtSettingsInit()
 {
+    qtcTrace("qtSettingsInit");
     if (0 == qt_refs++) {
         static int lastRead = 0;
         int now = time(nullptr);
@@ -1140,23 +868,9 @@ qtSettingsInit()
             lastRead=now;
 
             {
-            int        f=0;
-            const char *files[]={QTC_GTK2_THEME_DIR"/kdeglobals", /* QtCurve supplied kdeglobals file */
-                                 "/etc/kderc",
-                                 "/etc/kde4/kdeglobals",
-                                 "/etc/kde4rc",
-                                 QTC_KDE4_PREFIX KDE4_SYS_CFG_DIR KDEGLOBALS_FILE,
-                                 QTC_KDE4_PREFIX KDE4_SYS_CFG_DIR
-                                 KDEGLOBALS_SYS_FILE,
-                                 kde4Globals(),
-                                 kde5Globals(),
-                                 nullptr};
-
-            for(f=0; 0!=files[f]; ++f)
-                readKdeGlobals(files[f], RD_ICONS|RD_SMALL_ICON_SIZE|RD_TOOLBAR_STYLE|RD_MENU_FONT|RD_TB_FONT|
-                               RD_TOOLBAR_ICON_SIZE|RD_BUTTON_ICONS|RD_LIST_SHADE|
-                               (RD_KDE4_PAL|RD_FONT|RD_CONTRAST|RD_STYLE|RD_DRAG_DIST|RD_DRAG_TIME),
-                               0==f);
+                IniFile kdeGlobals;
+                loadKdeGlobals(&kdeGlobals);
+                readKdeGlobals(kdeGlobals);
             }
 
 #ifdef QTC_GTK2_STYLE_SUPPORT
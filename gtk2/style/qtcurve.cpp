@@ -55,6 +55,7 @@
 #include "helpers.h"
 #include "drawing.h"
 #include "pixcache.h"
+#include "gradcache.h"
 #include "shadowhelper.h"
 #include "config.h"
 
@@ -142,7 +143,7 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     cairo_t *cr = Cairo::gdkCreateClip(window, area);
 
     bool isMenuOrToolTipWindow =
@@ -160,7 +161,7 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
     sanitizeSize(window, &width, &height);
 
     if (!opts.gtkButtonOrder && opts.reorderGtkButtons &&
-        GTK_IS_WINDOW(widget) && oneOf(detail, "base")) {
+        GTK_IS_WINDOW(widget) && detail.type == DETAIL_BASE) {
         GtkWidget *topLevel = gtk_widget_get_toplevel(widget);
         GtkWidgetProps topProps(topLevel);
 
@@ -183,7 +184,8 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
     }
 
     if (opts.windowDrag > WM_DRAG_MENU_AND_TOOLBAR &&
-        oneOf(detail, "base", "eventbox", "viewportbin")) {
+        oneOf(detail.type, DETAIL_BASE, DETAIL_EVENT_BOX,
+              DETAIL_VIEWPORT_BIN)) {
         WMMove::setup(widget);
     }
 
@@ -244,11 +246,12 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
         }
     }
 
-    if (widget && qtcIsCustomBgnd(opts) && oneOf(detail, "base", "eventbox")) {
+    if (widget && qtcIsCustomBgnd(opts) &&
+        oneOf(detail.type, DETAIL_BASE, DETAIL_EVENT_BOX)) {
         Scrollbar::setup(widget);
     }
 
-    if (qtcIsCustomBgnd(opts) && oneOf(detail, "viewportbin")) {
+    if (qtcIsCustomBgnd(opts) && detail.type == DETAIL_VIEWPORT_BIN) {
         GtkRcStyle *st = widget ? gtk_widget_get_modifier_style(widget) : nullptr;
         // if the app hasn't modified bg, draw background gradient
         if (st && !(st->color_flags[state]&GTK_RC_BG)) {
@@ -270,7 +273,7 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
         GtkTreeView *treeView = GTK_TREE_VIEW(widget);
         bool checkRules = (opts.forceAlternateLvCols ||
                            gtk_tree_view_get_rules_hint(treeView));
-        bool isEven = checkRules && strstr(detail, "cell_even");
+        bool isEven = checkRules && (detail.flags & DETAIL_CELL_EVEN);
 
         if (qtSettings.app == GTK_APP_JAVA_SWT)
             area = nullptr;
@@ -282,10 +285,10 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
             static GtkWidget *lastWidget = nullptr;
             static int lastEven = -1;
 
-            if (strstr(detail, "cell_even")) {
+            if (detail.flags & DETAIL_CELL_EVEN) {
                 lastWidget = widget;
                 lastEven = y;
-            } else if (strstr(detail, "cell_odd")) {
+            } else if (detail.flags & DETAIL_CELL_ODD) {
                 if (lastWidget == widget) {
                     if (y == lastEven) {
                         isEven = true;
@@ -374,11 +377,13 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
                 if (opts.round != ROUND_NONE) {
                     if (forceCellStart && forceCellEnd) {
                         round = ROUNDED_ALL;
-                    } else if (forceCellStart || strstr(detail, "_start")) {
+                    } else if (forceCellStart ||
+                               (detail.flags & DETAIL_HAS_START)) {
                         round = ROUNDED_LEFT;
-                    } else if (forceCellEnd || strstr(detail, "_end")) {
+                    } else if (forceCellEnd ||
+                               (detail.flags & DETAIL_HAS_END)) {
                         round = ROUNDED_RIGHT;
-                    } else if (!strstr(detail, "_middle")) {
+                    } else if (!(detail.flags & DETAIL_HAS_MIDDLE)) {
                         round = ROUNDED_ALL;
                     }
                 }
@@ -386,32 +391,32 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
                               y, selW, height, round, true, alpha, factor);
             }
         }
-    } else if (oneOf(detail, "checkbutton")) {
+    } else if (detail.type == DETAIL_CHECK_BUTTON) {
         if (state == GTK_STATE_PRELIGHT && opts.crHighlight &&
             width > opts.crSize * 2) {
             GdkColor col=shadeColor(&style->bg[state], TO_FACTOR(opts.crHighlight));
             drawSelectionGradient(cr, (QtcRect*)area, x, y, width, height,
                                   ROUNDED_ALL, false, 1.0, &col, true);
         }
-    } else if (oneOf(detail, "expander")) {
+    } else if (detail.type == DETAIL_EXPANDER) {
         if (state == GTK_STATE_PRELIGHT && opts.expanderHighlight) {
             GdkColor col = shadeColor(&style->bg[state],
                                       TO_FACTOR(opts.expanderHighlight));
             drawSelectionGradient(cr, (QtcRect*)area, x, y, width, height,
                                   ROUNDED_ALL, false, 1.0, &col, true);
         }
-    } else if (oneOf(detail, "tooltip")) {
+    } else if (detail.type == DETAIL_TOOLTIP) {
         drawToolTip(cr, widget, (QtcRect*)area, x, y, width, height);
-    } else if (oneOf(detail, "icon_view_item")) {
+    } else if (detail.type == DETAIL_ICON_VIEW_ITEM) {
         drawSelection(cr, style, state, (QtcRect*)area, widget, x, y,
                       width, height, ROUNDED_ALL, false, 1.0, 0);
     } else if (state != GTK_STATE_SELECTED &&
-               qtcIsCustomBgnd(opts) && oneOf(detail, "eventbox")) {
+               qtcIsCustomBgnd(opts) && detail.type == DETAIL_EVENT_BOX) {
         drawWindowBgnd(cr, style, nullptr, window, widget, x, y, width, height);
     } else if (!(qtSettings.app == GTK_APP_JAVA && widget &&
                  GTK_IS_LABEL(widget))) {
         if (state != GTK_STATE_PRELIGHT || opts.crHighlight ||
-            noneOf(detail, "checkbutton")) {
+            detail.type != DETAIL_CHECK_BUTTON) {
             parent_class->draw_flat_box(style, window, state, shadow, area,
                                         widget, _detail, x, y, width, height);
         }
@@ -420,7 +425,7 @@ gtkDrawFlatBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
            for etching we need 3. So we fake this by drawing the 3rd lines here...*/
 
 /*
-        if(DO_EFFECT && GTK_STATE_INSENSITIVE!=state && oneOf(detail, "entry_bg") &&
+        if(DO_EFFECT && GTK_STATE_INSENSITIVE!=state && detail.type == DETAIL_ENTRY_BG &&
            isSwtComboBoxEntry(widget) && gtk_widget_has_focus(widget))
         {
             Cairo::hLine(cr, x, y, width,
@@ -441,7 +446,7 @@ gtkDrawHandle(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_WINDOW(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     QtcRect *area = (QtcRect*)_area;
     bool paf = widgetIsType(widget, "PanelAppletFrame");
     cairo_t *cr = Cairo::gdkCreateClip(window, area);
@@ -462,12 +467,12 @@ gtkDrawHandle(GtkStyle *style, GdkWindow *window, GtkStateType state,
         }
     }
 
-    if (oneOf(detail, "paned") || oneOf(detail + 1, "paned")) {
+    if (detail.type == DETAIL_PANED) {
         drawSplitter(cr, state, style, area, x, y, width, height);
-    } else if ((oneOf(detail, "handlebox") &&
+    } else if ((detail.type == DETAIL_HANDLE_BOX &&
                 (qtSettings.app == GTK_APP_JAVA ||
                  (widget && GTK_IS_HANDLE_BOX(widget)))) ||
-               oneOf(detail, "dockitem") || paf) {
+               detail.type == DETAIL_DOCK_ITEM || paf) {
         /* Note: I'm not sure why the 'widget && GTK_IS_HANDLE_BOX(widget)' is in
          * the following 'if' - its been there for a while. But this breaks the
          * toolbar handles for Java Swing apps. I'm leaving it in for non Java
@@ -536,7 +541,7 @@ gtkDrawArrow(GtkStyle *style, GdkWindow *window, GtkStateType state,
              int x, int y, int width, int height)
 {
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     if (qtSettings.debug == DEBUG_ALL) {
         printf(DEBUG_PREFIX "%s %d %d %d %d %d %d %d %s  ", __FUNCTION__,
                state, shadow, arrow_type, x, y, width, height, _detail);
@@ -545,7 +550,7 @@ gtkDrawArrow(GtkStyle *style, GdkWindow *window, GtkStateType state,
     QtcRect *area = (QtcRect*)_area;
     cairo_t *cr = gdk_cairo_create(window);
 
-    if (oneOf(detail, "arrow")) {
+    if (detail.type == DETAIL_ARROW) {
         bool onComboEntry = isOnComboEntry(widget, 0);
 
         if (isOnComboBox(widget, 0) && !onComboEntry) {
@@ -606,8 +611,8 @@ gtkDrawArrow(GtkStyle *style, GdkWindow *window, GtkStateType state,
                          false, true, opts.vArrows);
         }
     } else {
-        int isSpinButton = oneOf(detail, "spinbutton");
-        bool isMenuItem = oneOf(detail, "menuitem");
+        int isSpinButton = detail.type == DETAIL_SPIN_BUTTON;
+        bool isMenuItem = detail.type == DETAIL_MENUITEM;
         /* int a_width = LARGE_ARR_WIDTH; */
         /* int a_height = LARGE_ARR_HEIGHT; */
         bool sbar = isSbarDetail(detail);
@@ -711,23 +716,22 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     bool sbar = isSbarDetail(detail);
-    bool pbar = oneOf(detail, "bar"); //  && GTK_IS_PROGRESS_BAR(widget);
-    bool qtcSlider = !pbar && oneOf(detail, "qtc-slider");
-    bool slider = qtcSlider || (!pbar && oneOf(detail, "slider"));
-    bool hscale = !slider && oneOf(detail, "hscale");
-    bool vscale = !hscale && oneOf(detail, "vscale");
-    bool menubar = !vscale && oneOf(detail, "menubar");
-    bool button = !menubar && oneOf(detail, "button");
-    bool togglebutton = !button && oneOf(detail, "togglebutton");
-    bool optionmenu = !togglebutton && oneOf(detail, "optionmenu");
-    bool stepper = !optionmenu && oneOf(detail, "stepper");
-    bool vscrollbar = (!optionmenu && Str::startsWith(detail, "vscrollbar"));
-    bool hscrollbar = (!vscrollbar && Str::startsWith(detail, "hscrollbar"));
-    bool spinUp = !hscrollbar && oneOf(detail, "spinbutton_up");
-    bool spinDown = !spinUp && oneOf(detail, "spinbutton_down");
-    bool menuScroll = strstr(detail, "menu_scroll_arrow_");
+    bool pbar = detail.type == DETAIL_BAR; //  && GTK_IS_PROGRESS_BAR(widget);
+    bool qtcSlider = detail.type == DETAIL_QTC_SLIDER;
+    bool slider = qtcSlider || detail.type == DETAIL_SLIDER;
+    bool hscale = detail.type == DETAIL_HSCALE;
+    bool vscale = detail.type == DETAIL_VSCALE;
+    bool menubar = detail.type == DETAIL_MENUBAR;
+    bool button = detail.type == DETAIL_BUTTON;
+    bool togglebutton = detail.type == DETAIL_TOGGLE_BUTTON;
+    bool optionmenu = detail.type == DETAIL_OPTION_MENU;
+    bool stepper = detail.type == DETAIL_STEPPER;
+    bool vscrollbar = detail.flags & DETAIL_VSCROLLBAR;
+    bool spinUp = detail.type == DETAIL_SPIN_BUTTON_UP;
+    bool spinDown = detail.type == DETAIL_SPIN_BUTTON_DOWN;
+    bool menuScroll = detail.flags & DETAIL_MENU_SCROLL_ARROW;
     bool rev = (reverseLayout(widget) ||
                 (widget && reverseLayout(gtk_widget_get_parent(widget))));
     bool activeWindow = true;
@@ -840,7 +844,7 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
                            &btnColors[bgnd], btnColors, round, wid, BORDER_FLAT,
                            DF_DO_BORDER | (sunken ? DF_SUNKEN : 0), widget);
         }
-    } else if (oneOf(detail, "spinbutton")) {
+    } else if (detail.type == DETAIL_SPIN_BUTTON) {
         if (qtcIsFlatBgnd(opts.bgndAppearance) ||
             !(widget && drawWindowBgnd(cr, style, (QtcRect*)area, window,
                                        widget, x, y, width, height))) {
@@ -920,7 +924,8 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
         }
     } else if (button || togglebutton || optionmenu || sbar ||
                hscale || vscale || stepper || slider) {
-        bool combo = oneOf(detail, "optionmenu") || isOnComboBox(widget, 0);
+        bool combo = (detail.type == DETAIL_OPTION_MENU ||
+                      isOnComboBox(widget, 0));
         bool combo_entry = combo && isOnComboEntry(widget, 0);
         bool horiz_tbar;
         bool tbar_button = isButtonOnToolbar(widget, &horiz_tbar);
@@ -981,7 +986,7 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
             /* Try and guess if this button is a toolbar button... */
             if (oneOf(widgetType, WIDGET_STD_BUTTON, WIDGET_TOGGLE_BUTTON) &&
                 isMozillaWidget(widget) && GTK_IS_BUTTON(widget) &&
-                oneOf(detail, "button") && ((width > 22 && width < 56 &&
+                detail.type == DETAIL_BUTTON && ((width > 22 && width < 56 &&
                                              height > 30) || height >= 32 ||
                                             ((width == 30 || width == 45) &&
                                              height == 30)))
@@ -1422,9 +1427,10 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
                 }
             }
         }
-    } else if (oneOf(detail, "buttondefault", "togglebuttondefault")) {
-    } else if (widget && (oneOf(detail, "trough") ||
-                          Str::startsWith(detail, "trough-"))) {
+    } else if (oneOf(detail.type, DETAIL_BUTTON_DEFAULT,
+                     DETAIL_TOGGLE_BUTTON_DEFAULT)) {
+    } else if (widget && (detail.type == DETAIL_TROUGH ||
+                          (detail.flags & DETAIL_TROUGH_PART))) {
         bool list = isList(widget);
         bool pbar = list || GTK_IS_PROGRESS_BAR(widget);
         bool scale = !pbar && GTK_IS_SCALE(widget);
@@ -1442,18 +1448,19 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
             drawScrollbarGroove(cr, style, state, widget, (QtcRect*)area,
                                 x, y, width, height, horiz);
         }
-    } else if (oneOf(detail, "entry-progress")) {
+    } else if (detail.type == DETAIL_ENTRY_PROGRESS) {
         int adjust = (opts.fillProgress ? 4 : 3) - (opts.etchEntry ? 1 : 0);
         drawProgress(cr, style, state, widget, (QtcRect*)area, x - adjust,
                      y - adjust, width + adjust, height + 2 * adjust,
                      rev, true);
-    } else if (oneOf(detail, "dockitem", "dockitem_bin")) {
+    } else if (oneOf(detail.type, DETAIL_DOCK_ITEM, DETAIL_DOCK_ITEM_BIN)) {
         if (qtcIsCustomBgnd(opts) && widget) {
             drawWindowBgnd(cr, style, (QtcRect*)area, window, widget,
                            x, y, width, height);
         }
-    } else if (widget && ((menubar || oneOf(detail, "toolbar", "handlebox",
-                                            "handlebox_bin")) ||
+    } else if (widget && ((menubar ||
+                           oneOf(detail.type, DETAIL_TOOLBAR, DETAIL_HANDLE_BOX,
+                                 DETAIL_HANDLE_BOX_BIN)) ||
                           widgetIsType(widget, "PanelAppletFrame"))) {
         //if(GTK_SHADOW_NONE!=shadow)
         {
@@ -1489,7 +1496,7 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
             if (drawGradient) {
                 drawBevelGradient(cr, (QtcRect*)area, x, y - menuBarAdjust, width,
                                   height + menuBarAdjust, col,
-                                  (menubar ? true : oneOf(detail, "handlebox") ?
+                                  (menubar ? true : detail.type == DETAIL_HANDLE_BOX ?
                                    width < height : width > height),
                                   false, MODIFY_AGUA(app), WIDGET_OTHER, alpha);
             } else if (fillBackground) {
@@ -1504,20 +1511,20 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
     } else if (widget && pbar) {
         drawProgress(cr, style, state, widget, (QtcRect*)area,
                      x, y, width, height, rev, false);
-    } else if (oneOf(detail, "menuitem")) {
+    } else if (detail.type == DETAIL_MENUITEM) {
         drawMenuItem(cr, state, style, widget, (QtcRect*)area,
                      x, y, width, height);
-    } else if (oneOf(detail, "menu")) {
+    } else if (detail.type == DETAIL_MENU) {
         drawMenu(cr, widget, (QtcRect*)area, x, y, width, height);
-    } else if ((!strcmp(detail, "paned") || !strcmp(detail + 1, "paned"))) {
-        gtkDrawHandle(style, window, state, shadow, area, widget, detail,
+    } else if (detail.type == DETAIL_PANED) {
+        gtkDrawHandle(style, window, state, shadow, area, widget, _detail,
                       x, y, width, height,
-                      *detail == 'h' ? GTK_ORIENTATION_VERTICAL :
+                      detail.flags & DETAIL_H ? GTK_ORIENTATION_VERTICAL :
                       GTK_ORIENTATION_HORIZONTAL);
-    } else if (strcmp(detail + 1, "ruler") == 0) {
+    } else if (detail.type == DETAIL_RULER) {
         drawBevelGradient(cr, (QtcRect*)area, x, y, width, height,
                           &qtcPalette.background[ORIGINAL_SHADE],
-                          detail[0] == 'h', false, opts.lvAppearance,
+                          detail.flags & DETAIL_H, false, opts.lvAppearance,
                           WIDGET_LISTVIEW_HEADER);
 
 //        if(qtcIsFlatBgnd(opts.bgndAppearance) || !widget || !drawWindowBgnd(cr, style, area, widget, x, y, width, height))
@@ -1526,7 +1533,7 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
 //             if(widget && IMG_NONE!=opts.bgndImage.type)
 //                 drawWindowBgnd(cr, style, area, widget, x, y, width, height);
 //        }
-    } else if (oneOf(detail, "hseparator")) {
+    } else if (detail.type == DETAIL_HSEPARATOR) {
         bool isMenuItem = widget && GTK_IS_MENU_ITEM(widget);
         const GdkColor *cols=qtcPalette.background;
         int offset=opts.menuStripe && (isMozilla() || isMenuItem) ? 20 : 0;
@@ -1541,7 +1548,7 @@ drawBox(GtkStyle *style, GdkWindow *window, GtkStateType state,
         drawFadedLine(cr, x + 1 + offset, y + height / 2, width - (1 + offset),
                       1, &cols[isMenuItem ? MENU_SEP_SHADE : QTC_STD_BORDER],
                       (QtcRect*)area, nullptr, true, true, true);
-    } else if (oneOf(detail, "vseparator")) {
+    } else if (detail.type == DETAIL_VSEPARATOR) {
         drawFadedLine(cr, x + width / 2, y, 1, height,
                       &qtcPalette.background[QTC_STD_BORDER], (QtcRect*)area,
                       nullptr, true, true, false);
@@ -1594,7 +1601,7 @@ gtkDrawShadow(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     sanitizeSize(window, &width, &height);
     cairo_t *cr = Cairo::gdkCreateClip(window, area);
     bool comboBoxList = isComboBoxList(widget);
@@ -1604,7 +1611,7 @@ gtkDrawShadow(GtkStyle *style, GdkWindow *window, GtkStateType state,
         bool square = opts.square & SQUARE_POPUP_MENUS;
 
         if ((!square || opts.popupBorder) &&
-            (!comboList || noneOf(detail, "viewport"))) {
+            (!comboList || detail.type != DETAIL_VIEWPORT)) {
             bool nonGtk = square || isFakeGtk();
             bool composActive = !nonGtk && compositingActive(widget);
             bool isAlphaWidget = (!nonGtk && composActive &&
@@ -1628,9 +1635,7 @@ gtkDrawShadow(GtkStyle *style, GdkWindow *window, GtkStateType state,
                     cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
                     clearRoundedMask(widget, false);
                 } else {
-                    createRoundedMask(widget, x, y, width, height,
-                                      opts.round >= ROUND_FULL ? 5.0 : 2.5,
-                                      false);
+                    createRoundedMask(widget, x, y, width, height, false);
                 }
 
                 Cairo::clipWhole(cr, x, y, width, height,
@@ -1693,7 +1698,7 @@ gtkDrawShadow(GtkStyle *style, GdkWindow *window, GtkStateType state,
 
         WidgetMap::setup(parent, widget, 1);
         ComboBox::setup(widget, parent);
-    } else if (oneOf(detail, "entry", "text")) {
+    } else if (oneOf(detail.type, DETAIL_ENTRY, DETAIL_TEXT)) {
         GtkWidget *parent=widget ? gtk_widget_get_parent(widget) : nullptr;
         if (parent && isList(parent)) {
             // Dont draw shadow for entries in listviews...
@@ -1752,9 +1757,9 @@ gtkDrawShadow(GtkStyle *style, GdkWindow *window, GtkStateType state,
             }
         }
     } else {
-        bool frame = !_detail || strcmp(detail, "frame") == 0;
-        bool scrolledWindow = oneOf(detail, "scrolled_window");
-        bool viewport = !scrolledWindow && strstr(detail, "viewport");
+        bool frame = !_detail || detail.type == DETAIL_FRAME;
+        bool scrolledWindow = detail.type == DETAIL_SCROLLED_WINDOW;
+        bool viewport = !scrolledWindow && (detail.flags & DETAIL_HAS_VIEWPORT);
         bool drawSquare = ((frame && opts.square & SQUARE_FRAME) ||
                            (!viewport && !scrolledWindow &&
                             !_detail && !widget));
@@ -1978,7 +1983,7 @@ gtkDrawCheck(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     QtcRect *area = (QtcRect*)_area;
     cairo_t *cr = Cairo::gdkCreateClip(window, area);
     drawCheckBox(cr, state, shadow, style, widget, detail, area,
@@ -1993,7 +1998,7 @@ gtkDrawOption(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     QtcRect *area = (QtcRect*)_area;
     cairo_t *cr = Cairo::gdkCreateClip(window, area);
     drawRadioButton(cr, state, shadow, style, widget, detail, area,
@@ -2020,10 +2025,10 @@ gtkDrawLayout(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     const QtcRect *area = (QtcRect*)_area;
     cairo_t *cr = gdk_cairo_create(window);
-    if (GTK_IS_PROGRESS(widget) || oneOf(detail, "progressbar")) {
+    if (GTK_IS_PROGRESS(widget) || detail.type == DETAIL_PROGRESSBAR) {
         drawLayout(cr, style, state, use_text, area, x, y, layout);
     } else {
         Style *qtc_style = (Style*)style;
@@ -2055,7 +2060,7 @@ gtkDrawLayout(GtkStyle *style, GdkWindow *window, GtkStateType state,
             debugDisplayWidget(widget, 10);
         }
 
-        if (oneOf(detail, "cellrenderertext") && widget &&
+        if (detail.type == DETAIL_CELL_RENDERER_TEXT && widget &&
             gtk_widget_get_state(widget) == GTK_STATE_INSENSITIVE)
              state = GTK_STATE_INSENSITIVE;
 
@@ -2065,7 +2070,8 @@ gtkDrawLayout(GtkStyle *style, GdkWindow *window, GtkStateType state,
            if not used, when an item is selected it gets the selected text
            color - but when the window changes focus it gets the normal
            text color! */
-         if (oneOf(detail, "cellrenderertext") && state == GTK_STATE_ACTIVE)
+         if (detail.type == DETAIL_CELL_RENDERER_TEXT &&
+             state == GTK_STATE_ACTIVE)
              state = GTK_STATE_SELECTED;
 #endif
 
@@ -2256,7 +2262,7 @@ gtkDrawBoxGap(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     cairo_t *cr = Cairo::gdkCreateClip(window, area);
 
     if ((opts.thin & THIN_FRAMES) && gapX == 0) {
@@ -2269,7 +2275,8 @@ gtkDrawBoxGap(GtkStyle *style, GdkWindow *window, GtkStateType state,
                width, height, gapSide, gapX, gapWidth,
                opts.borderTab ? BORDER_LIGHT : BORDER_RAISED, true);
 
-    if (opts.windowDrag > WM_DRAG_MENU_AND_TOOLBAR && oneOf(detail, "notebook")) {
+    if (opts.windowDrag > WM_DRAG_MENU_AND_TOOLBAR &&
+        detail.type == DETAIL_NOTEBOOK) {
         WMMove::setup(widget);
     }
 
@@ -2287,7 +2294,7 @@ gtkDrawExtension(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
     if (qtSettings.debug == DEBUG_ALL) {
         printf(DEBUG_PREFIX "%s %d %d %d %d %d %d %d %s  ", __FUNCTION__, state,
                shadow, gapSide, x, y, width, height, _detail);
@@ -2295,7 +2302,7 @@ gtkDrawExtension(GtkStyle *style, GdkWindow *window, GtkStateType state,
     }
     sanitizeSize(window, &width, &height);
 
-    if (oneOf(detail, "tab")) {
+    if (detail.type == DETAIL_TAB) {
         QtcRect *area = (QtcRect*)_area;
         cairo_t *cr = Cairo::gdkCreateClip(window, area);
         drawTab(cr, state, style, widget, area, x, y, width, height, gapSide);
@@ -2315,9 +2322,9 @@ gtkDrawSlider(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
-    bool scrollbar = oneOf(detail, "slider");
-    bool scale = oneOf(detail, "hscale", "vscale");
+    const Detail &detail = classifyDetail(_detail);
+    bool scrollbar = detail.type == DETAIL_SLIDER;
+    bool scale = oneOf(detail.type, DETAIL_HSCALE, DETAIL_VSCALE);
 
     if (qtSettings.debug == DEBUG_ALL) {
         printf(DEBUG_PREFIX "%s %d %d %d %d %d %d %s  ", __FUNCTION__, state,
@@ -2366,7 +2373,7 @@ gtkDrawSlider(GtkStyle *style, GdkWindow *window, GtkStateType state,
             lastSlider.state=state;
             lastSlider.shadow=shadow;
             lastSlider.widget=widget;
-            lastSlider.detail=detail;
+            lastSlider.detail=_detail;
             lastSlider.x=x;
             lastSlider.y=y;
             lastSlider.width=width;
@@ -2461,8 +2468,8 @@ gtkDrawHLine(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
-    bool tbar = strcmp(detail, "toolbar");
+    const Detail &detail = classifyDetail(_detail);
+    bool tbar = detail.type != DETAIL_TOOLBAR;
     int light = 0;
     int dark = tbar ? (opts.toolbarSeparators == LINE_FLAT ? 4 : 3) : 5;
 
@@ -2503,7 +2510,7 @@ gtkDrawHLine(GtkStyle *style, GdkWindow *window, GtkStateType state,
                 }
             }
         }
-    } else if (oneOf(detail, "label")) {
+    } else if (detail.type == DETAIL_LABEL) {
         if (state == GTK_STATE_INSENSITIVE) {
             /* Cairo::hLine(cr, (x1 < x2 ? x1 : x2) + 1, y + 1, abs(x2 - x1), */
             /*              &qtcPalette.background[light]); */
@@ -2516,8 +2523,9 @@ gtkDrawHLine(GtkStyle *style, GdkWindow *window, GtkStateType state,
         drawFadedLine(cr, x1 < x2 ? x1 : x2, y, abs(x2 - x1), 1,
                       &qtcPalette.background[dark], (QtcRect*)area, nullptr,
                       true, true, true);
-    } else if (oneOf(detail, "menuitem") ||
-               (widget && oneOf(detail, "hseparator") && isMenuitem(widget))) {
+    } else if (detail.type == DETAIL_MENUITEM ||
+               (widget && detail.type == DETAIL_HSEPARATOR &&
+                isMenuitem(widget))) {
         int       offset=opts.menuStripe && (isMozilla() || (widget && GTK_IS_MENU_ITEM(widget))) ? 20 : 0;
         GdkColor *cols=qtcPalette.background;
 
@@ -2554,7 +2562,7 @@ gtkDrawVLine(GtkStyle *style, GdkWindow *window, GtkStateType state,
 {
     QTC_RET_IF_FAIL(GTK_IS_STYLE(style));
     QTC_RET_IF_FAIL(GDK_IS_DRAWABLE(window));
-    const char *detail = _detail ? _detail : "";
+    const Detail &detail = classifyDetail(_detail);
 
     if (qtSettings.debug == DEBUG_ALL) {
         printf(DEBUG_PREFIX "%s %d %d %d %d %s  ", __FUNCTION__, state, x, y1,
@@ -2564,9 +2572,9 @@ gtkDrawVLine(GtkStyle *style, GdkWindow *window, GtkStateType state,
 
     cairo_t *cr = Cairo::gdkCreateClip(window, area);
 
-    if (!(oneOf(detail, "vseparator") && isOnComboBox(widget, 0))) {
+    if (!(detail.type == DETAIL_VSEPARATOR && isOnComboBox(widget, 0))) {
          /* CPD: Combo handled in drawBox */
-        bool tbar = oneOf(detail, "toolbar");
+        bool tbar = detail.type == DETAIL_TOOLBAR;
         int dark = tbar ? 3 : 5;
         int light = 0;
 
@@ -3230,6 +3238,12 @@ rc_style_init(RcStyle*)
     lastSlider.widget = nullptr;
 #endif
     if (qtSettingsInit()) {
+        // Colors (and opts.xCheck) may have changed, drop the tinted images,
+        // shade palettes and gradients.
+        clearPixbufCache();
+        qtcClearShadeColorsCache();
+        clearGradientCache();
+        Ramp::clear();
         generateColors();
         if (qtSettings.useAlpha) {
             // Somehow GtkWidget is not loaded yet
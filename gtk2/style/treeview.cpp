@@ -25,14 +25,27 @@
 #include <qtcurve-utils/gtkprops.h>
 #include <qtcurve-cairo/utils.h>
 
+#include <string>
+#include <unordered_map>
+
 namespace QtCurve {
 namespace TreeView {
 
-typedef struct {
-    GtkTreePath *path;
-    GtkTreeViewColumn *column;
-    bool fullWidth;
-} QtCTreeView;
+// Enough for the visible rows of any reasonable view, the cache is simply
+// dropped when it grows beyond this.
+static const size_t maxLastMasks = 4096;
+
+struct QtCTreeView {
+    GtkTreePath *path = nullptr;
+    GtkTreeViewColumn *column = nullptr;
+    bool fullWidth = false;
+    // The model lastMasks was computed from, kept alive while it is cached.
+    GtkTreeModel *model = nullptr;
+    unsigned long modelSignals[3] = {0, 0, 0};
+    // isLastMask() of each row (and its ancestors), keyed by the indices of
+    // the row.
+    std::unordered_map<std::string, uint32_t> lastMasks;
+};
 
 static GHashTable *table = nullptr;
 
@@ -47,10 +60,7 @@ lookupHash(void *hash, bool create)
     rv = (QtCTreeView*)g_hash_table_lookup(table, hash);
 
     if (!rv && create) {
-        rv = qtcNew(QtCTreeView);
-        rv->path=nullptr;
-        rv->column=nullptr;
-        rv->fullWidth=false;
+        rv = new QtCTreeView;
         g_hash_table_insert(table, hash, rv);
         rv = (QtCTreeView*)g_hash_table_lookup(table, hash);
     }
@@ -58,6 +68,37 @@ lookupHash(void *hash, bool create)
     return rv;
 }
 
+static void
+clearLastMasks(QtCTreeView *tv)
+{
+    tv->lastMasks.clear();
+}
+
+// Start caching for \param model, any change in the structure of the model
+// invalidates the cache.
+static void
+setModel(QtCTreeView *tv, GtkTreeModel *model)
+{
+    if (tv->model) {
+        for (auto &id: tv->modelSignals) {
+            g_signal_handler_disconnect(tv->model, id);
+            id = 0;
+        }
+        g_object_unref(tv->model);
+    }
+    tv->lastMasks.clear();
+    tv->model = model;
+    if (model) {
+        g_object_ref(model);
+        const char *const signals[] = {"row-inserted", "row-deleted",
+                                       "rows-reordered"};
+        for (int i = 0;i < 3;i++) {
+            tv->modelSignals[i] = g_signal_connect_swapped(
+                model, signals[i], G_CALLBACK(clearLastMasks), tv);
+        }
+    }
+}
+
 static void
 removeFromHash(void *hash)
 {
@@ -66,7 +107,9 @@ removeFromHash(void *hash)
         if (tv) {
             if(tv->path)
                 gtk_tree_path_free(tv->path);
+            setModel(tv, nullptr);
             g_hash_table_remove(table, hash);
+            delete tv;
         }
     }
 }
@@ -288,6 +331,66 @@ isCellHovered(GtkWidget *widget, GtkTreePath *path, GtkTreeViewColumn *column)
             samePath(path, tv->path));
 }
 
+static bool
+rowIsLast(GtkTreeModel *model, GtkTreePath *path)
+{
+    GtkTreeIter iter;
+    return (gtk_tree_model_get_iter(model, &iter, path) &&
+            !gtk_tree_model_iter_next(model, &iter));
+}
+
+static inline std::string
+maskKey(const int *indices, int depth)
+{
+    return std::string((const char*)indices, sizeof(int) * depth);
+}
+
+uint32_t
+isLastMask(GtkTreeView *treeView, GtkTreePath *path)
+{
+    GtkTreeModel *model = gtk_tree_view_get_model(treeView);
+    int depth = path ? gtk_tree_path_get_depth(path) : 0;
+    if (!model || depth <= 0 || depth > 32) {
+        return 0;
+    }
+    QtCTreeView *tv = lookupHash(treeView, false);
+    if (tv && tv->model != model) {
+        setModel(tv, model);
+    }
+    const int *indices = gtk_tree_path_get_indices(path);
+    uint32_t mask = 0;
+    int level = depth;
+    // Walk up until we reach a row whose mask is known, the mask of a row
+    // covers all its ancestors.
+    GtkTreePath *p = gtk_tree_path_copy(path);
+    for (;level > 0;level--) {
+        if (tv) {
+            auto it = tv->lastMasks.find(maskKey(indices, level));
+            if (it != tv->lastMasks.end()) {
+                mask |= it->second;
+                break;
+            }
+        }
+        if (rowIsLast(model, p)) {
+            mask |= 1u << (level - 1);
+        }
+        gtk_tree_path_up(p);
+    }
+    gtk_tree_path_free(p);
+    if (tv) {
+        if (tv->lastMasks.size() >= maxLastMasks) {
+            tv->lastMasks.clear();
+        }
+        // Remember the rows we had to look at, bits above a row's depth
+        // belong to its descendants.
+        for (int i = level + 1;i <= depth;i++) {
+            uint32_t bits = i == 32 ? mask : mask & ((1u << i) - 1);
+            tv->lastMasks.emplace(maskKey(indices, i), bits);
+        }
+    }
+    return mask;
+}
+
 bool
 cellIsLeftOfExpanderColumn(GtkTreeView *treeView, GtkTreeViewColumn *column)
 {
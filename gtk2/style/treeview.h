@@ -24,6 +24,7 @@
 #define __QTC_TREE_VIEW_H__
 
 #include <gtk/gtk.h>
+#include <stdint.h>
 
 namespace QtCurve {
 namespace TreeView {
@@ -35,6 +36,13 @@ bool isCellHovered(GtkWidget *widget, GtkTreePath *path,
                    GtkTreeViewColumn *column);
 bool cellIsLeftOfExpanderColumn(GtkTreeView *treeView,
                                 GtkTreeViewColumn *column);
+/**
+ * Bit `i` is set if the ancestor of \param path at depth `i + 1` (or the row
+ * itself) is the last one of its siblings. Cached per view (once setup() has
+ * been called on it) until the structure of the model changes. Only works for
+ * paths of depth up to 32, 0 is returned otherwise.
+ */
+uint32_t isLastMask(GtkTreeView *treeView, GtkTreePath *path);
 
 }
 }
@@ -23,7 +23,6 @@
 #include "window.h"
 
 #include <qtcurve-utils/x11qtc.h>
-#include <qtcurve-utils/x11wrap.h>
 #include <qtcurve-utils/gtkprops.h>
 #include <qtcurve-utils/log.h>
 #include <qtcurve-cairo/utils.h>
@@ -317,25 +316,24 @@ static void
 setProperties(GtkWidget *w, unsigned short opacity)
 {
     GtkWindow *topLevel = GTK_WINDOW(gtk_widget_get_toplevel(w));
-    unsigned long prop = (qtcIsFlatBgnd(opts.bgndAppearance) ?
-                          (IMG_NONE != opts.bgndImage.type ?
-                           APPEARANCE_RAISED : APPEARANCE_FLAT) :
-                          opts.bgndAppearance) & 0xFF;
+    uint32_t prop = (qtcIsFlatBgnd(opts.bgndAppearance) ?
+                     (IMG_NONE != opts.bgndImage.type ?
+                      APPEARANCE_RAISED : APPEARANCE_FLAT) :
+                     opts.bgndAppearance) & 0xFF;
     //GtkRcStyle *rcStyle=gtk_widget_get_modifier_style(w);
     GdkColor *bgnd = /* rcStyle ? &rcStyle->bg[GTK_STATE_NORMAL] : */
         &qtcPalette.background[ORIGINAL_SHADE];
     xcb_window_t wid =
         GDK_WINDOW_XID(gtk_widget_get_window(GTK_WIDGET(topLevel)));
 
+    X11PropBatch batch;
     if (opacity != 100) {
-        qtcX11SetOpacity(wid, opacity);
+        batch.setOpacity(wid, opacity);
     }
     prop |= (((toQtColor(bgnd->red) & 0xFF) << 24) |
              ((toQtColor(bgnd->green) & 0xFF) << 16) |
              ((toQtColor(bgnd->blue) & 0xFF) << 8));
-    qtcX11ChangeProperty(XCB_PROP_MODE_REPLACE, wid, qtc_x11_qtc_bgnd,
-                         XCB_ATOM_CARDINAL, 32, 1, &prop);
-    qtcX11Flush();
+    batch.setBgnd(wid, prop);
 }
 
 static gboolean
@@ -0,0 +1,124 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "cachestats.h"
+#include "log.h"
+#include "strs.h"
+
+#include <mutex>
+
+namespace QtCurve {
+namespace CacheRegistry {
+
+struct Entry {
+    unsigned id;
+    std::string name;
+    Reporter reporter;
+};
+
+struct Registry {
+    std::mutex lock;
+    unsigned lastId = 0;
+    std::vector<Entry> entries;
+};
+
+// Never destroyed so that caches with static storage can still unregister
+// while the process exits.
+static Registry&
+registry()
+{
+    static Registry *res = new Registry;
+    return *res;
+}
+
+static void
+logReport(LogLevel _level, const std::string &name, const CacheReport &report)
+{
+    qtcLog(_level, "Cache %s: %llu lookups, %llu hits (%.1f%%), %llu misses, "
+           "%llu evictions, %llu entries, %llu bytes\n", name.c_str(),
+           (unsigned long long)report.lookups(),
+           (unsigned long long)report.hits,
+           report.lookups() ? 100.0 * report.hits / report.lookups() : 0.0,
+           (unsigned long long)report.misses,
+           (unsigned long long)report.evictions,
+           (unsigned long long)report.entries,
+           (unsigned long long)report.bytes);
+}
+
+QTC_EXPORT bool
+enabled()
+{
+    static bool res = Str::convert(getenv("QTCURVE_CACHE_STATS"), false);
+    return res;
+}
+
+QTC_EXPORT unsigned
+add(const char *name, Reporter reporter)
+{
+    static bool atExit = enabled() && atexit(dump) == 0;
+    (void)atExit;
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    reg.entries.push_back(Entry{++reg.lastId, name, std::move(reporter)});
+    return reg.lastId;
+}
+
+QTC_EXPORT void
+remove(unsigned id)
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (auto it = reg.entries.begin();it != reg.entries.end();++it) {
+        if (it->id == id) {
+            CacheReport report;
+            it->reporter(&report);
+            logReport(enabled() ? LogLevel::Force : LogLevel::Debug,
+                      it->name, report);
+            reg.entries.erase(it);
+            return;
+        }
+    }
+}
+
+QTC_EXPORT Reports
+collect()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    Reports res;
+    for (auto &entry: reg.entries) {
+        CacheReport report;
+        entry.reporter(&report);
+        res.emplace_back(entry.name, report);
+    }
+    return res;
+}
+
+QTC_EXPORT void
+dump()
+{
+    for (auto &report: collect()) {
+        logReport(LogLevel::Force, report.first, report.second);
+    }
+}
+
+}
+}
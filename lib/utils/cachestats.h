@@ -0,0 +1,124 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef _QTC_UTILS_CACHESTATS_H_
+#define _QTC_UTILS_CACHESTATS_H_
+
+#include "lrucache.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * \file cachestats.h
+ * \brief Registry of the statistics of the caches used by the styles.
+ *
+ * Each cache registers a callback that reports its current counters. The
+ * reports of all registered caches can be logged at any time with
+ * CacheRegistry::dump(). When the QTCURVE_CACHE_STATS environment variable is
+ * set to a true value, the final report of each cache is logged when it is
+ * unregistered and the remaining ones are dumped at exit. Otherwise the final
+ * reports are only logged at debug level (QTCURVE_DEBUG).
+ */
+
+namespace QtCurve {
+
+struct CacheReport {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+    uint64_t
+    lookups() const
+    {
+        return hits + misses;
+    }
+};
+
+/**
+ * Fill \param report with the counters of an LRUCache whose cost is in bytes.
+ */
+template<typename Cache>
+static inline void
+reportCache(const Cache &cache, CacheReport *report)
+{
+    const CacheStats &stats = cache.stats();
+    report->hits = stats.hits;
+    report->misses = stats.misses;
+    report->evictions = stats.evictions;
+    report->entries = cache.size();
+    report->bytes = cache.cost();
+}
+
+namespace CacheRegistry {
+
+typedef std::function<void(CacheReport*)> Reporter;
+typedef std::vector<std::pair<std::string, CacheReport> > Reports;
+
+/**
+ * Whether QTCURVE_CACHE_STATS asks for the statistics to be logged.
+ */
+bool enabled();
+/**
+ * Register the cache \param name. \param reporter is called (possibly from
+ * another thread, but never concurrently) whenever a report is needed until
+ * the returned id is passed to #remove.
+ */
+unsigned add(const char *name, Reporter reporter);
+/**
+ * Log the final report of the cache \param id and unregister it.
+ */
+void remove(unsigned id);
+/**
+ * Reports of all registered caches in the order they were added.
+ */
+Reports collect();
+/**
+ * Log the reports of all registered caches.
+ */
+void dump();
+
+}
+
+/**
+ * Keeps a cache registered for as long as it lives.
+ */
+class CacheRegistration {
+    CacheRegistration(const CacheRegistration&) = delete;
+    CacheRegistration &operator=(const CacheRegistration&) = delete;
+public:
+    CacheRegistration(const char *name, CacheRegistry::Reporter reporter)
+        : m_id(CacheRegistry::add(name, std::move(reporter)))
+    {
+    }
+    ~CacheRegistration()
+    {
+        CacheRegistry::remove(m_id);
+    }
+private:
+    unsigned m_id;
+};
+
+}
+
+#endif
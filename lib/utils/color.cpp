@@ -21,13 +21,122 @@
  *****************************************************************************/
 
 #include "color.h"
+#include "pixel.h"
+#include "lrucache.h"
+#include "cachestats.h"
+
+#include <mutex>
+
+namespace {
+
+/**
+ * The gamma curves are interpolated from tables instead of calling pow().
+ * Both are too steep around 0 to be interpolated linearly, so the tables are
+ * indexed by x^(1/4) and the gamma one holds x^0.2 (to be multiplied by x^2).
+ */
+struct HCYGammaTables {
+    static const int size = 1024;
+    double gamma[size + 1];
+    double igamma[size + 1];
+    HCYGammaTables()
+    {
+        for (int i = 0;i <= size;i++) {
+            double t = double(i) / size;
+            gamma[i] = pow(t, 0.8);
+            igamma[i] = pow(t, 4.0 / 2.2);
+        }
+    }
+};
+
+static inline const HCYGammaTables&
+hcyGammaTables()
+{
+    static const HCYGammaTables tables;
+    return tables;
+}
+
+static inline double
+hcyInterpolate(const double *table, double n)
+{
+    const int size = HCYGammaTables::size;
+    double f = sqrt(sqrt(n)) * size;
+    int i = qtcMin((int)f, size - 1);
+    double t = f - i;
+    // Exact at the table entries (in particular 0 and 1).
+    return table[i] * (1 - t) + table[i + 1] * t;
+}
+
+static inline double
+hcyGamma(double n)
+{
+    n = qtcBound(0, n, 1);
+    return n * n * hcyInterpolate(hcyGammaTables().gamma, n);
+}
+
+static inline double
+hcyIGamma(double n)
+{
+    return hcyInterpolate(hcyGammaTables().igamma, qtcBound(0, n, 1));
+}
+
+static inline double
+hcyLuma(const QtcColor *color)
+{
+    return qtcColorHCYLumag(hcyGamma(color->red), hcyGamma(color->green),
+                            hcyGamma(color->blue));
+}
+
+static inline uint64_t
+doubleBits(double v)
+{
+    // Make -0.0 and 0.0 (which compare equal) hash the same.
+    v += 0.0;
+    uint64_t res;
+    memcpy(&res, &v, sizeof(res));
+    return res;
+}
+
+static inline bool
+colorEqual(const QtcColor &c1, const QtcColor &c2)
+{
+    return (c1.red == c2.red && c1.green == c2.green &&
+            c1.blue == c2.blue);
+}
+
+static inline uint64_t
+colorHash(uint64_t seed, const QtcColor &color)
+{
+    seed = QtCurve::hashCombine(seed, doubleBits(color.red));
+    seed = QtCurve::hashCombine(seed, doubleBits(color.green));
+    return QtCurve::hashCombine(seed, doubleBits(color.blue));
+}
+
+}
+
+QTC_EXPORT double
+qtcColorHCYGamma(double n)
+{
+    return hcyGamma(n);
+}
+
+QTC_EXPORT double
+qtcColorHCYIGamma(double n)
+{
+    return hcyIGamma(n);
+}
+
+QTC_EXPORT double
+qtcColorHCYLuma(const QtcColor *color)
+{
+    return hcyLuma(color);
+}
 
 static void
 qtcColorHCYFromColor(const QtcColor *color, QtcColorHCY *hcy)
 {
-    double r = qtcColorHCYGamma(color->red);
-    double g = qtcColorHCYGamma(color->green);
-    double b = qtcColorHCYGamma(color->blue);
+    double r = hcyGamma(color->red);
+    double g = hcyGamma(color->green);
+    double b = hcyGamma(color->blue);
 
     // luma component
     hcy->y = qtcColorHCYLumag(r, g, b);
@@ -96,9 +205,9 @@ qtcColorHCYToColor(const QtcColorHCY *hcy, QtcColor *color)
         tn = _y - (1.0 - _y) * _c * tm / (1.0 - tm);
     }
 
-    tp = qtcColorHCYIGamma(tp);
-    to = qtcColorHCYIGamma(to);
-    tn = qtcColorHCYIGamma(tn);
+    tp = hcyIGamma(tp);
+    to = hcyIGamma(to);
+    tn = hcyIGamma(tn);
     // return RGB channels in appropriate order
     if (_hs < 1.0) {
         qtcColorFill(color, tp, to, tn);
@@ -115,11 +224,25 @@ qtcColorHCYToColor(const QtcColorHCY *hcy, QtcColor *color)
     }
 }
 
-static double
-qtcColorContrastRatio(const QtcColor *c1, const QtcColor *c2)
+QTC_EXPORT void
+qtcColorHCYFromColors(const QtcColor *colors, QtcColorHCY *hcys, size_t n)
+{
+    for (size_t i = 0;i < n;i++) {
+        qtcColorHCYFromColor(&colors[i], &hcys[i]);
+    }
+}
+
+QTC_EXPORT void
+qtcColorHCYToColors(const QtcColorHCY *hcys, QtcColor *colors, size_t n)
+{
+    for (size_t i = 0;i < n;i++) {
+        qtcColorHCYToColor(&hcys[i], &colors[i]);
+    }
+}
+
+static inline double
+qtcColorLumaRatio(double y1, double y2)
 {
-    double y1 = qtcColorHCYLuma(c1);
-    double y2 = qtcColorHCYLuma(c2);
     if (y1 > y2) {
         return (y1 + 0.05) / (y2 + 0.05);
     } else {
@@ -127,14 +250,39 @@ qtcColorContrastRatio(const QtcColor *c1, const QtcColor *c2)
     }
 }
 
+static inline void
+qtcColorHCYLighten(QtcColorHCY *hcy, double ky, double kc)
+{
+    hcy->y = 1.0 - qtcBound(0, (1.0 - hcy->y) * (1.0 - ky), 1);
+    hcy->c = 1.0 - qtcBound(0, (1.0 - hcy->c) * kc, 1);
+}
+
+static inline void
+qtcColorHCYDarken(QtcColorHCY *hcy, double ky, double kc)
+{
+    hcy->y = qtcBound(0, hcy->y * (1.0 - ky), 1);
+    hcy->c = qtcBound(0, hcy->c * kc, 1);
+}
+
+#define HCY_FACTOR 0.15
+
+// Shading::HCY of _qtcShade
+static inline void
+qtcColorHCYShade(QtcColorHCY *hcy, double k)
+{
+    if (k > 1) {
+        qtcColorHCYLighten(hcy, (k * (1 + HCY_FACTOR)) - 1.0, 1.0);
+    } else {
+        qtcColorHCYDarken(hcy, 1.0 - (k * (1 - HCY_FACTOR)), 1.0);
+    }
+}
+
 QTC_EXPORT void
 _qtcColorLighten(QtcColor *color, double ky, double kc)
 {
     QtcColorHCY hcy;
     qtcColorHCYFromColor(color, &hcy);
-
-    hcy.y = 1.0 - qtcBound(0, (1.0 - hcy.y) * (1.0 - ky), 1);
-    hcy.c = 1.0 - qtcBound(0, (1.0 - hcy.c) * kc, 1);
+    qtcColorHCYLighten(&hcy, ky, kc);
     qtcColorHCYToColor(&hcy, color);
 }
 
@@ -143,9 +291,7 @@ _qtcColorDarken(QtcColor *color, double ky, double kc)
 {
     QtcColorHCY hcy;
     qtcColorHCYFromColor(color, &hcy);
-
-    hcy.y = qtcBound(0, hcy.y * (1.0 - ky), 1);
-    hcy.c = qtcBound(0, hcy.c * kc, 1);
+    qtcColorHCYDarken(&hcy, ky, kc);
     qtcColorHCYToColor(&hcy, color);
 }
 
@@ -161,18 +307,78 @@ _qtcColorShade(QtcColor *color, double ky, double kc)
 }
 
 static void
-qtcColorTintHelper(const QtcColor *base, const QtcColor *col,
+qtcColorTintHelper(const QtcColor *base, double base_y, const QtcColor *col,
                    double amount, QtcColor *out)
 {
     QtcColor mixed;
     _qtcColorMix(base, col, pow(amount, 0.3), &mixed);
     QtcColorHCY hcy;
     qtcColorHCYFromColor(&mixed, &hcy);
-    hcy.y = qtcColorMixF(qtcColorHCYLuma(base), hcy.y, amount);
+    hcy.y = qtcColorMixF(base_y, hcy.y, amount);
 
     qtcColorHCYToColor(&hcy, out);
 }
 
+// Bisect for the mixing amount that gives the contrast ratio wanted for
+// \param amount.
+static void
+qtcColorTintSolve(const QtcColor *base, const QtcColor *col,
+                  double amount, QtcColor *out)
+{
+    double base_y = hcyLuma(base);
+    double ri = qtcColorLumaRatio(base_y, hcyLuma(col));
+    double rg = 1.0 + ((ri + 1.0) * amount * amount * amount);
+    double u = 1.0, l = 0.0;
+    int i;
+    for (i = 12;i;i--) {
+        double a = 0.5 * (l + u);
+        qtcColorTintHelper(base, base_y, col, a, out);
+        double ra = qtcColorLumaRatio(base_y, hcyLuma(out));
+        if (ra > rg) {
+            u = a;
+        } else {
+            l = a;
+        }
+    }
+}
+
+namespace {
+
+struct TintKey {
+    QtcColor base;
+    QtcColor col;
+    double amount;
+    bool
+    operator==(const TintKey &other) const
+    {
+        return (colorEqual(base, other.base) && colorEqual(col, other.col) &&
+                amount == other.amount);
+    }
+};
+
+struct TintHash {
+    size_t
+    operator()(const TintKey &key) const
+    {
+        return QtCurve::hashCombine(colorHash(colorHash(0, key.base), key.col),
+                                    doubleBits(key.amount));
+    }
+};
+
+}
+
+// Tints are only computed when (re)generating palettes, from a handful of
+// distinct colors.
+static const size_t tintCacheBudget = 64 * sizeof(QtcColor);
+static std::mutex tintCacheLock;
+static QtCurve::LRUCache<TintKey, QtcColor, TintHash> tintCache(
+    tintCacheBudget);
+static QtCurve::CacheRegistration tintCacheStats(
+    "color tints", [] (QtCurve::CacheReport *report) {
+        std::lock_guard<std::mutex> lock(tintCacheLock);
+        QtCurve::reportCache(tintCache, report);
+    });
+
 QTC_EXPORT void
 _qtcColorTint(const QtcColor *base, const QtcColor *col,
               double amount, QtcColor *out)
@@ -186,20 +392,14 @@ _qtcColorTint(const QtcColor *base, const QtcColor *col,
         return;
     }
 
-    double ri = qtcColorContrastRatio(base, col);
-    double rg = 1.0 + ((ri + 1.0) * amount * amount * amount);
-    double u = 1.0, l = 0.0;
-    int i;
-    for (i = 12;i;i--) {
-        double a = 0.5 * (l + u);
-        qtcColorTintHelper(base, col, a, out);
-        double ra = qtcColorContrastRatio(base, out);
-        if (ra > rg) {
-            u = a;
-        } else {
-            l = a;
-        }
-    }
+    const TintKey key = {*base, *col, amount};
+    std::lock_guard<std::mutex> lock(tintCacheLock);
+    *out = *tintCache.get(key, [&] (size_t *cost) {
+            *cost = sizeof(QtcColor);
+            QtcColor res;
+            qtcColorTintSolve(base, col, amount, &res);
+            return res;
+        });
 }
 
 QTC_EXPORT void
@@ -340,15 +540,143 @@ _qtcShade(const QtcColor *ca, QtcColor *cb, double k, Shading shading)
                      qtcLimit(b, 1.0));
         break;
     }
-    case Shading::HCY:
-#define HCY_FACTOR 0.15
-        *cb = *ca;
-        if (k > 1) {
-            _qtcColorLighten(cb, (k * (1 + HCY_FACTOR)) - 1.0, 1.0);
-        } else {
-            _qtcColorDarken(cb, 1.0 - (k * (1 - HCY_FACTOR)), 1.0);
+    case Shading::HCY: {
+        QtcColorHCY hcy;
+        qtcColorHCYFromColor(ca, &hcy);
+        qtcColorHCYShade(&hcy, k);
+        qtcColorHCYToColor(&hcy, cb);
+        break;
+    }
+    }
+}
+
+namespace {
+
+struct ShadeKey {
+    QtcColor base;
+    QtcShadeParams params;
+    bool
+    operator==(const ShadeKey &other) const
+    {
+        if (!colorEqual(base, other.base) ||
+            params.highlight != other.params.highlight ||
+            params.shading != other.params.shading) {
+            return false;
+        }
+        for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
+            if (params.factors[i] != other.params.factors[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct ShadeHash {
+    size_t
+    operator()(const ShadeKey &key) const
+    {
+        uint64_t res = colorHash(0, key.base);
+        for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
+            res = QtCurve::hashCombine(res, doubleBits(key.params.factors[i]));
+        }
+        res = QtCurve::hashCombine(res, doubleBits(key.params.highlight));
+        return QtCurve::hashCombine(res, uint64_t(key.params.shading));
+    }
+};
+
+struct ShadePalette {
+    QtcColor colors[QTC_NUM_PALETTE_SHADES];
+};
+
+}
+
+// A palette is 240 bytes, styles use a few dozen distinct ones (more with
+// per widget colors).
+static const size_t shadeCacheBudget = 256 * sizeof(ShadePalette);
+static std::mutex shadeCacheLock;
+static QtCurve::LRUCache<ShadeKey, ShadePalette, ShadeHash> shadeCache(
+    shadeCacheBudget);
+static QtCurve::CacheRegistration shadeCacheStats(
+    "shade palettes", [] (QtCurve::CacheReport *report) {
+        std::lock_guard<std::mutex> lock(shadeCacheLock);
+        QtCurve::reportCache(shadeCache, report);
+    });
+
+// Same as qtcShadePaletteFill with Shading::HCY but converting the base
+// color to HCY only once.
+static void
+qtcShadePaletteFillHCY(const QtcColor *base, const QtcShadeParams *params,
+                       QtcColor *vals)
+{
+    QtcColorHCY base_hcy;
+    qtcColorHCYFromColors(base, &base_hcy, 1);
+    QtcColorHCY hcys[QTC_NUM_STD_SHADES + 1];
+    for (int i = 0;i <= QTC_NUM_STD_SHADES;i++) {
+        hcys[i] = base_hcy;
+        qtcColorHCYShade(&hcys[i], (i < QTC_NUM_STD_SHADES ?
+                                    params->factors[i] : params->highlight));
+    }
+    qtcColorHCYToColors(hcys, vals, QTC_NUM_STD_SHADES + 1);
+    for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
+        if (qtcEqual(params->factors[i], 1.0)) {
+            vals[i] = *base;
         }
     }
+    if (qtcEqual(params->highlight, 1.0)) {
+        vals[QTC_NUM_STD_SHADES] = *base;
+        vals[QTC_NUM_STD_SHADES + 1] = vals[4];
+        vals[QTC_NUM_STD_SHADES + 2] = vals[2];
+        return;
+    }
+    const QtcColor highlighted[] = {vals[4], vals[2]};
+    qtcColorHCYFromColors(highlighted, hcys, 2);
+    for (int i = 0;i < 2;i++) {
+        qtcColorHCYShade(&hcys[i], params->highlight);
+    }
+    qtcColorHCYToColors(hcys, &vals[QTC_NUM_STD_SHADES + 1], 2);
+}
+
+static void
+qtcShadePaletteFill(const QtcColor *base, const QtcShadeParams *params,
+                    QtcColor *vals)
+{
+    vals[QTC_NUM_PALETTE_SHADES - 1] = *base;
+    if (params->shading == Shading::HCY) {
+        qtcShadePaletteFillHCY(base, params, vals);
+        return;
+    }
+    for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
+        _qtcShade(base, &vals[i], params->factors[i], params->shading);
+    }
+    _qtcShade(base, &vals[QTC_NUM_STD_SHADES], params->highlight,
+              params->shading);
+    _qtcShade(&vals[4], &vals[QTC_NUM_STD_SHADES + 1], params->highlight,
+              params->shading);
+    _qtcShade(&vals[2], &vals[QTC_NUM_STD_SHADES + 2], params->highlight,
+              params->shading);
+}
+
+QTC_EXPORT void
+_qtcShadeColors(const QtcColor *base, const QtcShadeParams *params,
+                QtcColor *vals)
+{
+    const ShadeKey key = {*base, *params};
+    std::lock_guard<std::mutex> lock(shadeCacheLock);
+    const ShadePalette *palette = shadeCache.get(key, [&] (size_t *cost) {
+            *cost = sizeof(ShadePalette);
+            ShadePalette res;
+            qtcShadePaletteFill(base, params, res.colors);
+            return res;
+        });
+    memcpy(vals, palette->colors, sizeof(palette->colors));
+}
+
+QTC_EXPORT void
+qtcClearShadeColorsCache()
+{
+    std::lock_guard<std::mutex> lock(shadeCacheLock);
+    shadeCache.clear();
 }
 
 QTC_EXPORT double
@@ -379,42 +707,9 @@ qtcAdjustPix(unsigned char *data, int numChannels, int w, int h, int stride,
              int ro, int go, int bo, double shade,
              QtcPixelByteOrder byte_order)
 {
-    int width = w * numChannels;
-    int offset = 0;
-    int r = (int)(ro * shade + 0.5);
-    int g = (int)(go * shade + 0.5);
-    int b = (int)(bo * shade + 0.5);
-
-    for (int row = 0;row < h;row++) {
-        for (int column = 0;column < width;column += numChannels) {
-            unsigned char source = data[offset + column + 1];
-            int new_r = qtcBound(0, r - source, 255);
-            int new_g = qtcBound(0, g - source, 255);
-            int new_b = qtcBound(0, b - source, 255);
-            switch (byte_order) {
-            case QTC_PIXEL_ARGB:
-                /* ARGB */
-                data[offset + column + 1] = new_r;
-                data[offset + column + 2] = new_g;
-                data[offset + column + 3] = new_b;
-                break;
-            case QTC_PIXEL_BGRA:
-                /* BGRA */
-                data[offset + column] = new_b;
-                data[offset + column + 1] = new_g;
-                data[offset + column + 2] = new_r;
-                break;
-            default:
-            case QTC_PIXEL_RGBA:
-                /* GdkPixbuf is RGBA */
-                data[offset + column] = new_r;
-                data[offset + column + 1] = new_g;
-                data[offset + column + 2] = new_b;
-                break;
-            }
-        }
-        offset += stride;
-    }
+    QtCurve::Pixel::adjust(data, numChannels, w, h, stride,
+                           (int)(ro * shade + 0.5), (int)(go * shade + 0.5),
+                           (int)(bo * shade + 0.5), byte_order);
 }
 
 QTC_ALWAYS_INLINE static inline int
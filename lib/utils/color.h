@@ -25,6 +25,7 @@
 
 #include "utils.h"
 #include "options.h"
+#include "shade.h"
 
 // Using c99 function in c++ mode seems to cause trouble on some OSX versions.
 #include <cmath>
@@ -67,17 +68,11 @@ qtcColorMixF(double a, double b, double bias)
     return a + (b - a) * bias;
 }
 
-QTC_ALWAYS_INLINE static inline double
-qtcColorHCYGamma(double n)
-{
-    return pow(qtcBound(0, n, 1), 2.2);
-}
-
-QTC_ALWAYS_INLINE static inline double
-qtcColorHCYIGamma(double n)
-{
-    return pow(qtcBound(0, n, 1), 1.0 / 2.2);
-}
+/**
+ * The HCY gamma (x^2.2) and inverse gamma (x^(1/2.2)), within 1e-6 of pow().
+ */
+double qtcColorHCYGamma(double n);
+double qtcColorHCYIGamma(double n);
 
 QTC_ALWAYS_INLINE static inline double
 qtcColorHCYLumag(double r, double g, double b)
@@ -93,13 +88,7 @@ qtcColorFill(QtcColor *color, double r, double g, double b)
     color->blue = b;
 }
 
-QTC_ALWAYS_INLINE static inline double
-qtcColorHCYLuma(const QtcColor *color)
-{
-    return qtcColorHCYLumag(qtcColorHCYGamma(color->red),
-                            qtcColorHCYGamma(color->green),
-                            qtcColorHCYGamma(color->blue));
-}
+double qtcColorHCYLuma(const QtcColor *color);
 
 static inline void
 qtcHsvToRgb(double *r, double *g, double *b, double h, double s, double v)
@@ -182,6 +171,9 @@ qtcRgbToHsv(double r, double g, double b, double *h, double *s, double *v)
     }
 }
 
+void qtcColorHCYFromColors(const QtcColor *colors, QtcColorHCY *hcys,
+                           size_t n);
+void qtcColorHCYToColors(const QtcColorHCY *hcys, QtcColor *colors, size_t n);
 void _qtcColorLighten(QtcColor *color, double ky, double kc);
 void _qtcColorDarken(QtcColor *color, double ky, double kc);
 void _qtcColorShade(QtcColor *color, double ky, double kc);
@@ -190,6 +182,32 @@ void _qtcColorTint(const QtcColor *base, const QtcColor *col,
 void _qtcColorMix(const QtcColor *c1, const QtcColor *c2,
                   double bias, QtcColor *out);
 void _qtcShade(const QtcColor *ca, QtcColor *cb, double k, Shading shading);
+
+/**
+ * Number of colors in a shade palette, the QTC_NUM_STD_SHADES shades followed
+ * by the highlighted base color, highlighted shade 4, highlighted shade 2 and
+ * the base color itself. (i.e. ORIGINAL_SHADE + 1 of the styles)
+ */
+#define QTC_NUM_PALETTE_SHADES (QTC_NUM_STD_SHADES + 4)
+
+typedef struct {
+    double factors[QTC_NUM_STD_SHADES];
+    double highlight;
+    Shading shading;
+} QtcShadeParams;
+
+/**
+ * Fill \param vals with the shade palette of \param base. Palettes are
+ * memoized process wide (in a bounded cache) so this is cheap to call on
+ * every paint.
+ */
+void _qtcShadeColors(const QtcColor *base, const QtcShadeParams *params,
+                     QtcColor *vals);
+/**
+ * Drop all memoized shade palettes, should be called when the options are
+ * reloaded.
+ */
+void qtcClearShadeColorsCache();
 double _qtcShineAlpha(const QtcColor *bgnd);
 void _qtcCalcRingAlphas(const QtcColor *bgnd);
 void qtcColorFromStr(QtcColor *color, const char *str);
@@ -295,6 +313,19 @@ qtcShade(const QColor *ca, QColor *cb, double k, Shading shading)
     cb->setRgbF(qtc_cb.red, qtc_cb.green, qtc_cb.blue, ca->alphaF());
 }
 
+QTC_ALWAYS_INLINE static inline void
+qtcShadeColors(const QColor *base, const QtcShadeParams *params, QColor *vals)
+{
+    const QtcColor qtc_base = {base->redF(), base->greenF(), base->blueF()};
+    QtcColor qtc_vals[QTC_NUM_PALETTE_SHADES];
+    _qtcShadeColors(&qtc_base, params, qtc_vals);
+    for (int i = 0;i < QTC_NUM_PALETTE_SHADES - 1;i++) {
+        vals[i].setRgbF(qtc_vals[i].red, qtc_vals[i].green, qtc_vals[i].blue,
+                        base->alphaF());
+    }
+    vals[QTC_NUM_PALETTE_SHADES - 1] = *base;
+}
+
 QTC_ALWAYS_INLINE static inline double
 qtcShineAlpha(const QColor *bgnd)
 {
@@ -411,6 +442,29 @@ qtcShade(const GdkColor *ca, GdkColor *cb, double k, Shading shading)
     *cb = _qtcColorToGdk(&qtc_cb);
 }
 
+QTC_ALWAYS_INLINE static inline void
+qtcShadeColors(const GdkColor *base, const QtcShadeParams *params,
+               GdkColor *vals)
+{
+    QtcColor qtc_base = _qtc_color_from_gdk(base);
+    QtcColor qtc_vals[QTC_NUM_PALETTE_SHADES];
+    _qtcShadeColors(&qtc_base, params, qtc_vals);
+    // Converting back to GdkColor truncates, copy the unchanged colors
+    // (factor 1) instead so that they don't drift.
+    for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
+        vals[i] = (qtcEqual(params->factors[i], 1.0) ? *base :
+                   _qtcColorToGdk(&qtc_vals[i]));
+    }
+    bool noHighlight = qtcEqual(params->highlight, 1.0);
+    const GdkColor *highlighted[] = {base, &vals[4], &vals[2]};
+    for (int i = 0;i < 3;i++) {
+        vals[QTC_NUM_STD_SHADES + i] =
+            (noHighlight ? *highlighted[i] :
+             _qtcColorToGdk(&qtc_vals[QTC_NUM_STD_SHADES + i]));
+    }
+    vals[QTC_NUM_PALETTE_SHADES - 1] = *base;
+}
+
 QTC_ALWAYS_INLINE static inline double
 qtcShineAlpha(const GdkColor *bgnd)
 {
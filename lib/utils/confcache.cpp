@@ -0,0 +1,282 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "confcache.h"
+#include "lrucache.h"
+#include "log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace QtCurve {
+namespace ConfCache {
+
+// Bump when the file format (not the Options layout) changes.
+static const uint32_t formatVersion = 1;
+static const char magic[8] = {'Q', 'T', 'C', 'C', 'O', 'N', 'F', '\0'};
+static const uint32_t nullStr = 0xffffffff;
+
+struct Header {
+    char magic[8];
+    uint32_t format;
+    uint32_t headerSize;
+    uint64_t key;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+
+static uint64_t
+hashData(uint64_t seed, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char*)data;
+    uint64_t h = hashCombine(seed, len);
+    for (;len >= 8;len -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        h = hashCombine(h, v);
+    }
+    if (len) {
+        uint64_t v = 0;
+        memcpy(&v, p, len);
+        h = hashCombine(h, v);
+    }
+    return h;
+}
+
+static uint64_t
+hashStr(uint64_t seed, const char *str)
+{
+    return hashData(seed, str, strlen(str));
+}
+
+// Mix the stat (and content if \param content) of \param file into \param key.
+// A file that doesn't exist is a valid state but one that can't be read is not.
+static bool
+stampSource(uint64_t *key, const char *file, bool content)
+{
+    if (!file) {
+        *key = hashCombine(*key, 0);
+        return true;
+    }
+    uint64_t h = hashStr(*key, file);
+    struct stat st;
+    if (stat(file, &st) != 0) {
+        *key = hashCombine(h, 1);
+        return errno == ENOENT || errno == ENOTDIR;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        return false;
+    }
+    h = hashCombine(h, st.st_size);
+    h = hashCombine(h, st.st_mtime);
+    h = hashCombine(h, st.st_ctime);
+    h = hashCombine(h, st.st_ino);
+    if (!content) {
+        *key = h;
+        return true;
+    }
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    std::string data(st.st_size, '\0');
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = read(fd, &data[done], data.size() - done);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += n;
+    }
+    close(fd);
+    if (done != data.size()) {
+        return false;
+    }
+    *key = hashData(h, data.data(), data.size());
+    return true;
+}
+
+QTC_EXPORT void
+Writer::putData(const void *data, size_t len)
+{
+    m_data.append((const char*)data, len);
+}
+
+QTC_EXPORT void
+Writer::putStr(const char *str, size_t len)
+{
+    if (!str) {
+        put<uint32_t>(nullStr);
+        return;
+    }
+    put<uint32_t>(len);
+    putData(str, len);
+}
+
+QTC_EXPORT bool
+Reader::getData(void *data, size_t len)
+{
+    if (!m_ok || size_t(m_end - m_cur) < len) {
+        return m_ok = false;
+    }
+    memcpy(data, m_cur, len);
+    m_cur += len;
+    return true;
+}
+
+QTC_EXPORT bool
+Reader::getStr(const char **str, size_t *len)
+{
+    uint32_t size;
+    if (!get(&size)) {
+        return false;
+    }
+    if (size == nullStr) {
+        *str = nullptr;
+        *len = 0;
+        return true;
+    }
+    if (size_t(m_end - m_cur) < size) {
+        return m_ok = false;
+    }
+    *str = m_cur;
+    *len = size;
+    m_cur += size;
+    return true;
+}
+
+QTC_EXPORT
+File::File(const std::string &path, std::initializer_list<const char*> sources,
+           uint64_t layout, bool checkContent)
+    : m_path(path),
+      m_key(0),
+      m_valid(!path.empty()),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_payload(nullptr),
+      m_payloadSize(0)
+{
+    if (!m_valid) {
+        return;
+    }
+    m_key = hashStr(hashCombine(formatVersion, layout), qtcVersion());
+    for (auto source: sources) {
+        if (!stampSource(&m_key, source, checkContent)) {
+            m_valid = false;
+            return;
+        }
+    }
+}
+
+QTC_EXPORT
+File::~File()
+{
+    if (m_map) {
+        munmap(m_map, m_mapSize);
+    }
+}
+
+QTC_EXPORT bool
+File::load()
+{
+    if (!m_valid || m_map) {
+        return m_payload != nullptr;
+    }
+    int fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        size_t(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    m_map = map;
+    m_mapSize = st.st_size;
+    Header header;
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+        header.format != formatVersion ||
+        header.headerSize != sizeof(Header) || header.key != m_key ||
+        header.payloadSize != m_mapSize - sizeof(Header)) {
+        return false;
+    }
+    const char *payload = (const char*)map + sizeof(Header);
+    if (hashData(m_key, payload, header.payloadSize) != header.payloadHash) {
+        qtcDebug("Corrupted config cache %s\n", m_path.c_str());
+        return false;
+    }
+    m_payload = payload;
+    m_payloadSize = header.payloadSize;
+    return true;
+}
+
+QTC_EXPORT bool
+File::save(const Writer &payload) const
+{
+    if (!m_valid) {
+        return false;
+    }
+    const std::string &data = payload.data();
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.format = formatVersion;
+    header.headerSize = sizeof(Header);
+    header.key = m_key;
+    header.payloadSize = data.size();
+    header.payloadHash = hashData(m_key, data.data(), data.size());
+
+    std::string tmp = m_path + ".XXXXXX";
+    int fd = mkstemp(&tmp[0]);
+    if (fd < 0) {
+        return false;
+    }
+    bool res = (write(fd, &header, sizeof(header)) == sizeof(header) &&
+                write(fd, data.data(), data.size()) == ssize_t(data.size()));
+    res = close(fd) == 0 && res;
+    if (res && rename(tmp.c_str(), m_path.c_str()) == 0) {
+        return true;
+    }
+    unlink(tmp.c_str());
+    return false;
+}
+
+QTC_EXPORT std::string
+File::path(const char *config, const char *tag)
+{
+    return std::string(config) + '.' + tag + ".cache";
+}
+
+}
+}
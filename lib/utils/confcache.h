@@ -0,0 +1,180 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef _QTC_UTILS_CONFCACHE_H_
+#define _QTC_UTILS_CONFCACHE_H_
+
+#include "utils.h"
+
+#include <string>
+#include <initializer_list>
+
+/**
+ * \file confcache.h
+ * \brief Binary snapshot of a parsed config file.
+ *
+ * Each toolkit serializes its resolved Options into a Writer after parsing
+ * the text config and saves it next to the config file. The next process
+ * maps the snapshot and restores the options from a Reader instead of parsing
+ * again. A snapshot is only used if it was written by the same build for the
+ * same Options layout and none of the source files has changed since
+ * (compared by stat and, optionally, content hash).
+ */
+
+namespace QtCurve {
+namespace ConfCache {
+
+class Writer {
+public:
+    void putData(const void *data, size_t len);
+    /**
+     * Append the raw bytes in [\param begin, \param end).
+     */
+    void
+    putRange(const void *begin, const void *end)
+    {
+        putData(begin, (const char*)end - (const char*)begin);
+    }
+    template<typename T>
+    void
+    put(T val)
+    {
+        putData(&val, sizeof(val));
+    }
+    /**
+     * Append a string, \param str may be NULL.
+     */
+    void putStr(const char *str, size_t len);
+    void
+    putStr(const char *str)
+    {
+        putStr(str, str ? strlen(str) : 0);
+    }
+    const std::string&
+    data() const
+    {
+        return m_data;
+    }
+private:
+    std::string m_data;
+};
+
+/**
+ * Bounds checked reads from a snapshot. Once a read fails all following reads
+ * fail as well so that the caller only needs to check ok() at the end.
+ */
+class Reader {
+public:
+    Reader(const void *data=nullptr, size_t len=0)
+        : m_cur((const char*)data),
+          m_end((const char*)data + len),
+          m_ok(data != nullptr)
+    {
+    }
+    bool getData(void *data, size_t len);
+    bool
+    getRange(void *begin, void *end)
+    {
+        return getData(begin, (char*)end - (char*)begin);
+    }
+    template<typename T>
+    bool
+    get(T *val)
+    {
+        return getData(val, sizeof(T));
+    }
+    /**
+     * Read a string written by Writer::putStr. \param str points into the
+     * mapped snapshot (and is not NUL terminated) or is NULL if a NULL string
+     * was written.
+     */
+    bool getStr(const char **str, size_t *len);
+    bool
+    ok() const
+    {
+        return m_ok;
+    }
+    bool
+    atEnd() const
+    {
+        return m_ok && m_cur == m_end;
+    }
+private:
+    const char *m_cur;
+    const char *m_end;
+    bool m_ok;
+};
+
+class File {
+public:
+    /**
+     * \param path the snapshot file, an empty path disables the cache.
+     * \param sources the files the options are read from, NULL entries are
+     * allowed and stand for a file that is not used.
+     * \param layout a signature of the serialized structure.
+     * \param checkContent whether the content of the sources is hashed as
+     * well, otherwise only their stat is compared.
+     *
+     * The sources are checked here so that a config that changes while it
+     * is being parsed invalidates the snapshot saved afterward. A source that
+     * doesn't exist is fine (creating it invalidates the snapshot), one that
+     * can't be read disables the cache.
+     */
+    File(const std::string &path, std::initializer_list<const char*> sources,
+         uint64_t layout, bool checkContent=true);
+    ~File();
+    /**
+     * Map the snapshot and check that it is still valid.
+     */
+    bool load();
+    /**
+     * The payload of a loaded snapshot, valid as long as this object.
+     */
+    Reader
+    reader() const
+    {
+        return Reader(m_payload, m_payloadSize);
+    }
+    /**
+     * Atomically replace the snapshot with \param payload.
+     */
+    bool save(const Writer &payload) const;
+    /**
+     * The snapshot path used for the config file \param config by \param tag.
+     */
+    static std::string path(const char *config, const char *tag);
+private:
+    File(const File&) = delete;
+    File &operator=(const File&) = delete;
+
+    std::string m_path;
+    uint64_t m_key;
+    bool m_valid;
+    void *m_map;
+    size_t m_mapSize;
+    const void *m_payload;
+    size_t m_payloadSize;
+};
+
+}
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include "dirs.h"
 #include "log.h"
 #include "strs.h"
+#include "process.h"
 
 #include <config.h>
 
@@ -32,6 +33,7 @@
 #include <sys/types.h>
 #include <dirent.h>
 #include <libgen.h>
+#include <ctype.h>
 
 namespace QtCurve {
 
@@ -142,6 +144,184 @@ getKDE4Home()
     return homes;
 }
 
+// kde4-config on $PATH, empty if there isn't one.
+static const std::string&
+kde4ConfigPath()
+{
+    static const std::string path = [] {
+        const char *env = getenv("PATH");
+        while (env && *env) {
+            const char *delim = strchr(env, ':');
+            size_t len = delim ? size_t(delim - env) : strlen(env);
+            if (len && env[0] == '/') {
+                std::string file(env, len);
+                file += "/kde4-config";
+                if (isRegFile(file.c_str()) && access(file.c_str(), X_OK) == 0) {
+                    return file;
+                }
+            }
+            env = delim ? delim + 1 : nullptr;
+        }
+        return std::string();
+    }();
+    return path;
+}
+
+// Answers of kde4-config are remembered in the config directory for as long
+// as the kde4-config binary (and the environment it depends on) stays the
+// same so that it is run at most once per query.
+static std::string
+kde4ConfigStamp()
+{
+    struct stat st;
+    if (stat(kde4ConfigPath().c_str(), &st) != 0) {
+        return std::string();
+    }
+    const char *home = getenv(getuid() ? "KDEHOME" : "KDEROOTHOME");
+    char buff[64];
+    snprintf(buff, sizeof(buff), " %lld %lld ", (long long)st.st_mtime,
+             (long long)st.st_size);
+    return kde4ConfigPath() + buff + (home ? home : "");
+}
+
+static std::string
+kde4ConfigQuery(const char *key, const char *const *args)
+{
+    const std::string stamp = kde4ConfigStamp();
+    if (stamp.empty()) {
+        return std::string();
+    }
+    const std::string cacheFile = getConfFile(std::string("kde4-config.cache"));
+    const std::string prefix = std::string(key) + '=';
+    std::string content;
+    if (FILE *f = fopen(cacheFile.c_str(), "r")) {
+        char line[1024];
+        bool valid = false;
+        bool first = true;
+        while (fgets(line, sizeof(line), f)) {
+            size_t len = strcspn(line, "\n");
+            line[len] = '\0';
+            if (first) {
+                first = false;
+                valid = stamp == line;
+                if (!valid) {
+                    break;
+                }
+            } else if (Str::startsWith(line, prefix.c_str())) {
+                fclose(f);
+                return line + prefix.size();
+            }
+            content.append(line, len).append("\n");
+        }
+        fclose(f);
+        if (!valid) {
+            content.clear();
+        }
+    }
+#ifdef QTC_ENABLE_KDE4_CONFIG_FALLBACK
+    size_t len = 0;
+    uniqueStr res(qtcPopenStdout(args[0], args, 300, &len));
+    if (!res) {
+        return std::string();
+    }
+    std::string val(res.get(), strcspn(res.get(), "\n"));
+    while (!val.empty() && isspace(val.back())) {
+        val.pop_back();
+    }
+    if (content.empty()) {
+        content = stamp + '\n';
+    }
+    content += prefix + val + '\n';
+    std::string tmp = cacheFile + ".XXXXXX";
+    int fd = mkstemp(&tmp[0]);
+    if (fd >= 0) {
+        bool ok = (write(fd, content.data(), content.size()) ==
+                   ssize_t(content.size()));
+        if (close(fd) != 0 || !ok ||
+            rename(tmp.c_str(), cacheFile.c_str()) != 0) {
+            unlink(tmp.c_str());
+        }
+    }
+    return val;
+#else
+    QTC_UNUSED(args);
+    return std::string();
+#endif
+}
+
+QTC_EXPORT const char*
+getKDE4LocalPrefix()
+{
+    static uniqueStr dir = [] {
+        const char *env = getenv(getuid() ? "KDEHOME" : "KDEROOTHOME");
+        if (env && env[0] == '/') {
+            return Str::cat(env, "/");
+        }
+#ifndef QTC_KDE4_DEFAULT_HOME_DEFAULT
+        uniqueStr def(Str::cat(getHome(), QTC_KDE4_DEFAULT_HOME "/"));
+        if (isDir(def.get())) {
+            return def.release();
+        }
+#endif
+        // Only ask kde4-config when both (or neither) of the usual
+        // directories exist.
+        uniqueStr kde(Str::cat(getHome(), ".kde/"));
+        uniqueStr kde4(Str::cat(getHome(), ".kde4/"));
+        bool hasKde = isDir(kde.get());
+        bool hasKde4 = isDir(kde4.get());
+        if (hasKde != hasKde4) {
+            return hasKde ? kde.release() : kde4.release();
+        }
+        const char *const args[] = {"kde4-config", "--localprefix", nullptr};
+        std::string res = kde4ConfigQuery("localprefix", args);
+        if (res[0] == '/') {
+            if (res.back() != '/') {
+                res += '/';
+            }
+            return strdup(res.c_str());
+        }
+#ifndef QTC_KDE4_DEFAULT_HOME_DEFAULT
+        return def.release();
+#else
+        // ~/.kde is the default of kdecore/kernel/kstandarddirs.h
+        return kde.release();
+#endif
+    };
+    return dir.get();
+}
+
+QTC_EXPORT const char*
+getKDE4IconsPrefix()
+{
+    static uniqueStr dir = [] {
+        const std::string &kde4Config = kde4ConfigPath();
+        const char *binDir = "/bin/kde4-config";
+        if (Str::endsWith(kde4Config.c_str(), binDir)) {
+            // The icons are installed to the same prefix as kde4-config.
+            std::string icons(kde4Config, 0,
+                              kde4Config.size() - strlen(binDir));
+            icons += "/share/icons";
+            if (isDir(icons.c_str())) {
+                return strdup(icons.c_str());
+            }
+        }
+        if (!kde4Config.empty()) {
+            const char *const args[] = {"kde4-config", "--install", "icon",
+                                        nullptr};
+            std::string res = kde4ConfigQuery("icon", args);
+            while (res.size() > 1 && res.back() == '/') {
+                res.pop_back();
+            }
+            if (res[0] == '/') {
+                return strdup(res.c_str());
+            }
+        }
+        return strdup(strlen(QTC_KDE4_ICONS_PREFIX) > 2 ?
+                      QTC_KDE4_ICONS_PREFIX : "/usr/share/icons");
+    };
+    return dir.get();
+}
+
 QTC_EXPORT const char*
 getConfDir()
 {
@@ -61,6 +61,22 @@ const char *getXDGDataHome();
  */
 const char *getXDGConfigHome();
 
+/**
+ * Get the KDE4 local prefix (`kde4-config --localprefix`), usually `~/.kde/`.
+ * It is worked out from the environment and the existing directories,
+ * kde4-config is only run (once, the answer is cached in the QtCurve
+ * configure directory) if that is ambiguous. The returned string is
+ * guaranteed to end with '/'
+ */
+const char *getKDE4LocalPrefix();
+
+/**
+ * Get the directory KDE4 icons are installed to (`kde4-config --install icon`)
+ * in the same way as getKDE4LocalPrefix. The returned string does not end
+ * with '/'
+ */
+const char *getKDE4IconsPrefix();
+
 /**
  * Return the absolute path of \param file with the QtCurve configure directory
  * as the current directory. If the optional argument \param buff is not NULL
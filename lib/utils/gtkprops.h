@@ -102,6 +102,7 @@ class GtkWidgetProps {
         unsigned short windowOpacity;
 
         int widgetMask;
+        DEF_WIDGET_SIG_CONN_PROPS(widgetMaskUnrealize);
         DEF_WIDGET_SIG_CONN_PROPS(shadowDestroy);
 
         DEF_WIDGET_SIG_CONN_PROPS(entryEnter);
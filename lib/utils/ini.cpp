@@ -0,0 +1,207 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "ini.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace QtCurve {
+
+static inline bool
+isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline void
+trim(const char **begin, const char **end)
+{
+    while (*begin < *end && isBlank(**begin)) {
+        ++*begin;
+    }
+    while (*end > *begin && isBlank((*end)[-1])) {
+        --*end;
+    }
+}
+
+QTC_EXPORT bool
+IniFile::load(const char *file)
+{
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    parse((const char*)map, st.st_size);
+    munmap(map, st.st_size);
+    return true;
+}
+
+QTC_EXPORT void
+IniFile::parse(const char *data, size_t len)
+{
+    // Entries are collected per file first so that the first duplicate wins
+    // here while the later file wins in the merge.
+    std::map<std::string, Group, CaseLess> groups;
+    Group *group = &groups[""];
+    const char *end = data + len;
+    for (const char *line = data;line < end;) {
+        const char *eol = (const char*)memchr(line, '\n', end - line);
+        if (!eol) {
+            eol = end;
+        }
+        const char *begin = line;
+        const char *lineEnd = eol;
+        line = eol + 1;
+        trim(&begin, &lineEnd);
+        if (begin == lineEnd || *begin == '#') {
+            continue;
+        }
+        if (*begin == '[') {
+            const char *close = lineEnd;
+            while (close > begin && close[-1] != ']') {
+                --close;
+            }
+            if (close > begin + 1) {
+                group = &groups[std::string(begin + 1, close - 1)];
+            }
+            continue;
+        }
+        const char *eq = (const char*)memchr(begin, '=', lineEnd - begin);
+        if (!eq) {
+            continue;
+        }
+        const char *keyEnd = eq;
+        const char *val = eq + 1;
+        trim(&begin, &keyEnd);
+        trim(&val, &lineEnd);
+        // Drop KDE's [$e], [$i]... flags, the entry itself is still used.
+        while (keyEnd - begin > 3 && keyEnd[-1] == ']') {
+            const char *open = keyEnd - 2;
+            while (open > begin && *open != '[') {
+                --open;
+            }
+            if (open[0] != '[' || open[1] != '$') {
+                break;
+            }
+            keyEnd = open;
+        }
+        if (begin == keyEnd) {
+            continue;
+        }
+        group->emplace(std::string(begin, keyEnd),
+                       std::string(val, lineEnd));
+    }
+    for (auto &item: groups) {
+        if (item.second.empty()) {
+            continue;
+        }
+        Group &dest = m_groups[item.first];
+        for (auto &entry: item.second) {
+            dest[entry.first] = std::move(entry.second);
+        }
+    }
+}
+
+QTC_EXPORT const char*
+IniFile::value(const char *group, const char *key) const
+{
+    auto g = m_groups.find(group);
+    if (g == m_groups.end()) {
+        return nullptr;
+    }
+    auto entry = g->second.find(key);
+    if (entry == g->second.end()) {
+        return nullptr;
+    }
+    return entry->second.c_str();
+}
+
+QTC_EXPORT void
+IniFile::clear()
+{
+    m_groups.clear();
+}
+
+QTC_EXPORT void
+IniFile::serialize(ConfCache::Writer &w) const
+{
+    w.put<uint32_t>(m_groups.size());
+    for (auto &group: m_groups) {
+        w.putStr(group.first.data(), group.first.size());
+        w.put<uint32_t>(group.second.size());
+        for (auto &entry: group.second) {
+            w.putStr(entry.first.data(), entry.first.size());
+            w.putStr(entry.second.data(), entry.second.size());
+        }
+    }
+}
+
+QTC_EXPORT bool
+IniFile::deserialize(ConfCache::Reader &r)
+{
+    std::map<std::string, Group, CaseLess> groups;
+    uint32_t numGroups = 0;
+    r.get(&numGroups);
+    for (uint32_t i = 0;i < numGroups && r.ok();i++) {
+        const char *name = nullptr;
+        size_t nameLen = 0;
+        uint32_t numEntries = 0;
+        if (!r.getStr(&name, &nameLen) || !name || !r.get(&numEntries)) {
+            return false;
+        }
+        Group &group = groups[std::string(name, nameLen)];
+        for (uint32_t j = 0;j < numEntries;j++) {
+            const char *key = nullptr;
+            const char *val = nullptr;
+            size_t keyLen = 0;
+            size_t valLen = 0;
+            if (!r.getStr(&key, &keyLen) || !r.getStr(&val, &valLen) ||
+                !key || !val) {
+                return false;
+            }
+            group[std::string(key, keyLen)] = std::string(val, valLen);
+        }
+    }
+    if (!r.ok()) {
+        return false;
+    }
+    m_groups.swap(groups);
+    return true;
+}
+
+}
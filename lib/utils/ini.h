@@ -0,0 +1,86 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef _QTC_UTILS_INI_H_
+#define _QTC_UTILS_INI_H_
+
+#include "confcache.h"
+
+#include <map>
+#include <string>
+
+/**
+ * \file ini.h
+ * \brief Merged view of KDE style ini files (kdeglobals, kwinrc...).
+ *
+ * Each file is mapped and parsed in a single pass into a table indexed by
+ * group and key. Loading several files merges them the way KDE cascades its
+ * config files, i.e. an entry in a later file overrides the same entry from
+ * an earlier one. Group and key names are compared case insensitively.
+ */
+
+namespace QtCurve {
+
+class IniFile {
+public:
+    /**
+     * Merge the entries of \param file. Returns false if the file doesn't
+     * exist or can't be read, in which case nothing is changed.
+     */
+    bool load(const char *file);
+    /**
+     * Merge the entries of the ini data in [\param data, \param data + len).
+     * Within one file the first of duplicated entries is used.
+     */
+    void parse(const char *data, size_t len);
+    /**
+     * The value of \param key in \param group, NULL if there is no such entry.
+     * The returned string is valid until the next call that modifies this
+     * object.
+     */
+    const char *value(const char *group, const char *key) const;
+    bool
+    empty() const
+    {
+        return m_groups.empty();
+    }
+    void clear();
+    void serialize(ConfCache::Writer &w) const;
+    /**
+     * Replace the content with the one serialized in \param r. Nothing is
+     * changed if it is not a valid serialization.
+     */
+    bool deserialize(ConfCache::Reader &r);
+private:
+    struct CaseLess {
+        bool
+        operator()(const std::string &a, const std::string &b) const
+        {
+            return strcasecmp(a.c_str(), b.c_str()) < 0;
+        }
+    };
+    typedef std::map<std::string, std::string, CaseLess> Group;
+    std::map<std::string, Group, CaseLess> m_groups;
+};
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef _QTC_UTILS_LRUCACHE_H_
+#define _QTC_UTILS_LRUCACHE_H_
+
+#include "utils.h"
+
+#include <list>
+#include <unordered_map>
+
+/**
+ * \file lrucache.h
+ * \brief A cost bounded least-recently-used cache.
+ */
+
+namespace QtCurve {
+
+/**
+ * Mix the bits of \param v so that keys which only differ in a few (low)
+ * bits end up in different buckets. (The finalizer of splitmix64.)
+ */
+static inline uint64_t
+hashMix(uint64_t v)
+{
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+    return v ^ (v >> 31);
+}
+
+static inline uint64_t
+hashCombine(uint64_t seed, uint64_t v)
+{
+    return hashMix(seed ^ (v + 0x9e3779b97f4a7c15ull + (seed << 6) +
+                           (seed >> 2)));
+}
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+/**
+ * Map from \param Key to \param Value holding at most \param budget worth of
+ * cost (usually bytes). When inserting would exceed the budget, the least
+ * recently used entries are dropped. The entry just inserted is never
+ * dropped, even if it alone is larger than the budget.
+ *
+ * Pointers returned by #find and #insert stay valid until the entry is
+ * evicted, i.e. until the next #insert, #setBudget or #clear.
+ */
+template<typename Key, typename Value, typename Hash=std::hash<Key>,
+         typename Equal=std::equal_to<Key> >
+class LRUCache {
+    struct Entry {
+        Key key;
+        Value value;
+        size_t cost;
+    };
+    typedef std::list<Entry> List;
+    typedef typename List::iterator Iter;
+    LRUCache(const LRUCache&) = delete;
+public:
+    explicit LRUCache(size_t budget)
+        : m_budget(budget),
+          m_cost(0)
+    {
+    }
+    Value*
+    find(const Key &key)
+    {
+        auto it = m_map.find(key);
+        if (it == m_map.end()) {
+            m_stats.misses++;
+            return nullptr;
+        }
+        m_stats.hits++;
+        m_list.splice(m_list.begin(), m_list, it->second);
+        return &it->second->value;
+    }
+    Value*
+    insert(const Key &key, Value &&value, size_t cost)
+    {
+        auto it = m_map.find(key);
+        if (it != m_map.end()) {
+            m_cost -= it->second->cost;
+            m_list.erase(it->second);
+            m_map.erase(it);
+        }
+        m_list.push_front(Entry{key, std::move(value), cost});
+        m_map.emplace(key, m_list.begin());
+        m_cost += cost;
+        shrink();
+        return &m_list.front().value;
+    }
+    /**
+     * Look up \param key and call \param create to build the value if it is
+     * not in the cache. \param create receives a `size_t*` where it should
+     * store the cost of the value it returns.
+     */
+    template<typename Create>
+    Value*
+    get(const Key &key, Create &&create)
+    {
+        if (Value *res = find(key)) {
+            return res;
+        }
+        size_t cost = 1;
+        Value value = create(&cost);
+        return insert(key, std::move(value), cost);
+    }
+    void
+    clear()
+    {
+        m_map.clear();
+        m_list.clear();
+        m_cost = 0;
+    }
+    void
+    setBudget(size_t budget)
+    {
+        m_budget = budget;
+        shrink();
+    }
+    size_t
+    budget() const
+    {
+        return m_budget;
+    }
+    size_t
+    cost() const
+    {
+        return m_cost;
+    }
+    size_t
+    size() const
+    {
+        return m_map.size();
+    }
+    const CacheStats&
+    stats() const
+    {
+        return m_stats;
+    }
+private:
+    void
+    shrink()
+    {
+        while (m_cost > m_budget && m_list.size() > 1) {
+            Entry &last = m_list.back();
+            m_cost -= last.cost;
+            m_map.erase(last.key);
+            m_list.pop_back();
+            m_stats.evictions++;
+        }
+    }
+    size_t m_budget;
+    size_t m_cost;
+    List m_list;
+    std::unordered_map<Key, Iter, Hash, Equal> m_map;
+    CacheStats m_stats;
+};
+
+}
+
+#endif
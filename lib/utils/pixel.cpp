@@ -0,0 +1,469 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "pixel.h"
+#include "number.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define QTC_PIXEL_X86 1
+#  include <immintrin.h>
+#  define QTC_TARGET(arch) __attribute__((target(arch)))
+#else
+#  define QTC_PIXEL_X86 0
+#endif
+
+namespace QtCurve {
+namespace Pixel {
+
+namespace {
+
+// Index of each channel within a pixel.
+template<QtcPixelByteOrder order>
+struct Layout;
+
+template<>
+struct Layout<QTC_PIXEL_ARGB> {
+    enum {A = 0, R = 1, G = 2, B = 3};
+};
+
+template<>
+struct Layout<QTC_PIXEL_BGRA> {
+    enum {B = 0, G = 1, R = 2, A = 3};
+};
+
+template<>
+struct Layout<QTC_PIXEL_RGBA> {
+    enum {R = 0, G = 1, B = 2, A = 3};
+};
+
+// Shadow color as 0-255 floats, the mixed color is base + delta * bias
+// (with bias limited to 1).
+struct ShadowColor {
+    float base[3];
+    float delta[3];
+};
+
+typedef void (*AdjustFunc)(unsigned char *data, int numChannels, int w,
+                           int h, int stride, int r, int g, int b);
+typedef void (*ShadowFunc)(unsigned char *data, const float *bias, size_t n,
+                           const ShadowColor &color);
+
+struct Kernels {
+    Impl impl;
+    AdjustFunc adjust[3];
+    ShadowFunc shadow[3];
+};
+
+// floor(x / 255) for 0 <= x <= 255 * 255
+static inline unsigned
+div255(unsigned x)
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+template<QtcPixelByteOrder order>
+static inline void
+adjustRow(unsigned char *pixel, int numChannels, int w, int r, int g, int b)
+{
+    typedef Layout<order> L;
+    for (int i = 0;i < w;i++, pixel += numChannels) {
+        int source = pixel[1];
+        pixel[L::R] = qtcBound(0, r - source, 255);
+        pixel[L::G] = qtcBound(0, g - source, 255);
+        pixel[L::B] = qtcBound(0, b - source, 255);
+    }
+}
+
+template<QtcPixelByteOrder order>
+static void
+adjustScalar(unsigned char *data, int numChannels, int w, int h, int stride,
+             int r, int g, int b)
+{
+    for (int row = 0;row < h;row++) {
+        adjustRow<order>(data + row * stride, numChannels, w, r, g, b);
+    }
+}
+
+template<QtcPixelByteOrder order>
+static inline void
+shadowSpan(unsigned char *pixel, const float *bias, size_t n,
+           const ShadowColor &color)
+{
+    typedef Layout<order> L;
+    for (size_t i = 0;i < n;i++, pixel += 4) {
+        float k = bias[i];
+        unsigned alpha = qtcBound(0.0f, 255.0f * k, 255.0f);
+        k = qtcMin(k, 1.0f);
+        unsigned red = qtcBound(0.0f, color.base[0] + color.delta[0] * k,
+                                255.0f);
+        unsigned green = qtcBound(0.0f, color.base[1] + color.delta[1] * k,
+                                  255.0f);
+        unsigned blue = qtcBound(0.0f, color.base[2] + color.delta[2] * k,
+                                 255.0f);
+        pixel[L::A] = alpha;
+        pixel[L::R] = div255(red * alpha);
+        pixel[L::G] = div255(green * alpha);
+        pixel[L::B] = div255(blue * alpha);
+    }
+}
+
+template<QtcPixelByteOrder order>
+static void
+shadowScalar(unsigned char *data, const float *bias, size_t n,
+             const ShadowColor &color)
+{
+    shadowSpan<order>(data, bias, n, color);
+}
+
+static const Kernels scalarKernels = {
+    Impl::Scalar,
+    {adjustScalar<QTC_PIXEL_ARGB>, adjustScalar<QTC_PIXEL_BGRA>,
+     adjustScalar<QTC_PIXEL_RGBA>},
+    {shadowScalar<QTC_PIXEL_ARGB>, shadowScalar<QTC_PIXEL_BGRA>,
+     shadowScalar<QTC_PIXEL_RGBA>},
+};
+
+#if QTC_PIXEL_X86
+
+// All x86 kernels work on little endian 32bit pixels, i.e. the channel at
+// index i of a pixel is at bit 8 * i of the word.
+template<QtcPixelByteOrder order>
+static inline uint32_t
+colorMask()
+{
+    typedef Layout<order> L;
+    return ~(uint32_t(0xff) << (8 * L::A));
+}
+
+/**
+ * SSE2
+ */
+
+// Per pixel (16bit lanes) the color minus the second channel of the pixel.
+QTC_TARGET("sse2") static inline __m128i
+adjustHalfSSE2(__m128i pixels, __m128i color)
+{
+    __m128i source = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0x55),
+                                         0x55);
+    return _mm_sub_epi16(color, source);
+}
+
+template<QtcPixelByteOrder order>
+QTC_TARGET("sse2") static void
+adjustSSE2(unsigned char *data, int numChannels, int w, int h, int stride,
+           int r, int g, int b)
+{
+    if (numChannels != 4) {
+        adjustScalar<order>(data, numChannels, w, h, stride, r, g, b);
+        return;
+    }
+    typedef Layout<order> L;
+    short c[4] = {0, 0, 0, 0};
+    c[L::R] = r;
+    c[L::G] = g;
+    c[L::B] = b;
+    const __m128i color = _mm_setr_epi16(c[0], c[1], c[2], c[3],
+                                         c[0], c[1], c[2], c[3]);
+    const __m128i mask = _mm_set1_epi32(colorMask<order>());
+    const __m128i zero = _mm_setzero_si128();
+    for (int row = 0;row < h;row++) {
+        unsigned char *pixel = data + row * stride;
+        int i = 0;
+        for (;i + 4 <= w;i += 4, pixel += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)pixel);
+            __m128i lo = adjustHalfSSE2(_mm_unpacklo_epi8(v, zero), color);
+            __m128i hi = adjustHalfSSE2(_mm_unpackhi_epi8(v, zero), color);
+            __m128i res = _mm_packus_epi16(lo, hi);
+            res = _mm_or_si128(_mm_and_si128(mask, res),
+                               _mm_andnot_si128(mask, v));
+            _mm_storeu_si128((__m128i*)pixel, res);
+        }
+        adjustRow<order>(pixel, 4, w - i, r, g, b);
+    }
+}
+
+QTC_TARGET("sse2") static inline __m128i
+shadowChannelSSE2(__m128 base, __m128 delta, __m128 k, __m128i alpha)
+{
+    __m128 v = _mm_add_ps(base, _mm_mul_ps(delta, k));
+    v = _mm_max_ps(_mm_min_ps(v, _mm_set1_ps(255)), _mm_setzero_ps());
+    // Both factors are < 256 so the 16bit multiplication doesn't overflow
+    // and leaves the high half of each 32bit lane zero.
+    __m128i x = _mm_mullo_epi16(_mm_cvttps_epi32(v), alpha);
+    x = _mm_add_epi32(_mm_add_epi32(x, _mm_set1_epi32(1)),
+                      _mm_srli_epi32(x, 8));
+    return _mm_srli_epi32(x, 8);
+}
+
+template<QtcPixelByteOrder order>
+QTC_TARGET("sse2") static void
+shadowSSE2(unsigned char *data, const float *bias, size_t n,
+           const ShadowColor &color)
+{
+    typedef Layout<order> L;
+    const __m128 base_r = _mm_set1_ps(color.base[0]);
+    const __m128 base_g = _mm_set1_ps(color.base[1]);
+    const __m128 base_b = _mm_set1_ps(color.base[2]);
+    const __m128 delta_r = _mm_set1_ps(color.delta[0]);
+    const __m128 delta_g = _mm_set1_ps(color.delta[1]);
+    const __m128 delta_b = _mm_set1_ps(color.delta[2]);
+    const __m128 max = _mm_set1_ps(255);
+    size_t i = 0;
+    for (;i + 4 <= n;i += 4) {
+        __m128 k = _mm_loadu_ps(bias + i);
+        __m128i alpha = _mm_cvttps_epi32(
+            _mm_max_ps(_mm_min_ps(_mm_mul_ps(max, k), max),
+                       _mm_setzero_ps()));
+        k = _mm_min_ps(k, _mm_set1_ps(1));
+        __m128i red = shadowChannelSSE2(base_r, delta_r, k, alpha);
+        __m128i green = shadowChannelSSE2(base_g, delta_g, k, alpha);
+        __m128i blue = shadowChannelSSE2(base_b, delta_b, k, alpha);
+        __m128i res = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(alpha, 8 * L::A),
+                         _mm_slli_epi32(red, 8 * L::R)),
+            _mm_or_si128(_mm_slli_epi32(green, 8 * L::G),
+                         _mm_slli_epi32(blue, 8 * L::B)));
+        _mm_storeu_si128((__m128i*)(data + i * 4), res);
+    }
+    shadowSpan<order>(data + i * 4, bias + i, n - i, color);
+}
+
+static const Kernels sse2Kernels = {
+    Impl::SSE2,
+    {adjustSSE2<QTC_PIXEL_ARGB>, adjustSSE2<QTC_PIXEL_BGRA>,
+     adjustSSE2<QTC_PIXEL_RGBA>},
+    {shadowSSE2<QTC_PIXEL_ARGB>, shadowSSE2<QTC_PIXEL_BGRA>,
+     shadowSSE2<QTC_PIXEL_RGBA>},
+};
+
+/**
+ * AVX2, same as the SSE2 version with twice as many pixels per iteration.
+ * (Unpacking and packing both work within 128bit lanes so the order of the
+ * pixels is preserved.)
+ */
+
+QTC_TARGET("avx2") static inline __m256i
+adjustHalfAVX2(__m256i pixels, __m256i color)
+{
+    __m256i source = _mm256_shufflehi_epi16(
+        _mm256_shufflelo_epi16(pixels, 0x55), 0x55);
+    return _mm256_sub_epi16(color, source);
+}
+
+template<QtcPixelByteOrder order>
+QTC_TARGET("avx2") static void
+adjustAVX2(unsigned char *data, int numChannels, int w, int h, int stride,
+           int r, int g, int b)
+{
+    if (numChannels != 4) {
+        adjustScalar<order>(data, numChannels, w, h, stride, r, g, b);
+        return;
+    }
+    typedef Layout<order> L;
+    short c[4] = {0, 0, 0, 0};
+    c[L::R] = r;
+    c[L::G] = g;
+    c[L::B] = b;
+    const __m256i color = _mm256_setr_epi16(
+        c[0], c[1], c[2], c[3], c[0], c[1], c[2], c[3],
+        c[0], c[1], c[2], c[3], c[0], c[1], c[2], c[3]);
+    const __m256i mask = _mm256_set1_epi32(colorMask<order>());
+    const __m256i zero = _mm256_setzero_si256();
+    for (int row = 0;row < h;row++) {
+        unsigned char *pixel = data + row * stride;
+        int i = 0;
+        for (;i + 8 <= w;i += 8, pixel += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)pixel);
+            __m256i lo = adjustHalfAVX2(_mm256_unpacklo_epi8(v, zero), color);
+            __m256i hi = adjustHalfAVX2(_mm256_unpackhi_epi8(v, zero), color);
+            __m256i res = _mm256_packus_epi16(lo, hi);
+            res = _mm256_or_si256(_mm256_and_si256(mask, res),
+                                  _mm256_andnot_si256(mask, v));
+            _mm256_storeu_si256((__m256i*)pixel, res);
+        }
+        adjustRow<order>(pixel, 4, w - i, r, g, b);
+    }
+}
+
+QTC_TARGET("avx2") static inline __m256i
+shadowChannelAVX2(__m256 base, __m256 delta, __m256 k, __m256i alpha)
+{
+    __m256 v = _mm256_add_ps(base, _mm256_mul_ps(delta, k));
+    v = _mm256_max_ps(_mm256_min_ps(v, _mm256_set1_ps(255)),
+                      _mm256_setzero_ps());
+    __m256i x = _mm256_mullo_epi16(_mm256_cvttps_epi32(v), alpha);
+    x = _mm256_add_epi32(_mm256_add_epi32(x, _mm256_set1_epi32(1)),
+                         _mm256_srli_epi32(x, 8));
+    return _mm256_srli_epi32(x, 8);
+}
+
+template<QtcPixelByteOrder order>
+QTC_TARGET("avx2") static void
+shadowAVX2(unsigned char *data, const float *bias, size_t n,
+           const ShadowColor &color)
+{
+    typedef Layout<order> L;
+    const __m256 base_r = _mm256_set1_ps(color.base[0]);
+    const __m256 base_g = _mm256_set1_ps(color.base[1]);
+    const __m256 base_b = _mm256_set1_ps(color.base[2]);
+    const __m256 delta_r = _mm256_set1_ps(color.delta[0]);
+    const __m256 delta_g = _mm256_set1_ps(color.delta[1]);
+    const __m256 delta_b = _mm256_set1_ps(color.delta[2]);
+    const __m256 max = _mm256_set1_ps(255);
+    size_t i = 0;
+    for (;i + 8 <= n;i += 8) {
+        __m256 k = _mm256_loadu_ps(bias + i);
+        __m256i alpha = _mm256_cvttps_epi32(
+            _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(max, k), max),
+                          _mm256_setzero_ps()));
+        k = _mm256_min_ps(k, _mm256_set1_ps(1));
+        __m256i red = shadowChannelAVX2(base_r, delta_r, k, alpha);
+        __m256i green = shadowChannelAVX2(base_g, delta_g, k, alpha);
+        __m256i blue = shadowChannelAVX2(base_b, delta_b, k, alpha);
+        __m256i res = _mm256_or_si256(
+            _mm256_or_si256(_mm256_slli_epi32(alpha, 8 * L::A),
+                            _mm256_slli_epi32(red, 8 * L::R)),
+            _mm256_or_si256(_mm256_slli_epi32(green, 8 * L::G),
+                            _mm256_slli_epi32(blue, 8 * L::B)));
+        _mm256_storeu_si256((__m256i*)(data + i * 4), res);
+    }
+    shadowSpan<order>(data + i * 4, bias + i, n - i, color);
+}
+
+static const Kernels avx2Kernels = {
+    Impl::AVX2,
+    {adjustAVX2<QTC_PIXEL_ARGB>, adjustAVX2<QTC_PIXEL_BGRA>,
+     adjustAVX2<QTC_PIXEL_RGBA>},
+    {shadowAVX2<QTC_PIXEL_ARGB>, shadowAVX2<QTC_PIXEL_BGRA>,
+     shadowAVX2<QTC_PIXEL_RGBA>},
+};
+
+#endif
+
+static const Kernels*
+kernelsFor(Impl impl)
+{
+    switch (impl) {
+#if QTC_PIXEL_X86
+    case Impl::AVX2:
+        return &avx2Kernels;
+    case Impl::SSE2:
+        return &sse2Kernels;
+#endif
+    default:
+        return &scalarKernels;
+    }
+}
+
+static Impl
+detectImpl()
+{
+    for (Impl impl: {Impl::AVX2, Impl::SSE2}) {
+        if (supported(impl)) {
+            return impl;
+        }
+    }
+    return Impl::Scalar;
+}
+
+static const Kernels *&
+currentKernels()
+{
+    static const Kernels *kernels = kernelsFor(detectImpl());
+    return kernels;
+}
+
+static inline unsigned
+orderIndex(QtcPixelByteOrder order)
+{
+    return order <= QTC_PIXEL_RGBA ? order : QTC_PIXEL_RGBA;
+}
+
+}
+
+QTC_EXPORT bool
+supported(Impl impl)
+{
+    switch (impl) {
+    case Impl::Scalar:
+        return true;
+#if QTC_PIXEL_X86
+    case Impl::SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case Impl::AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+QTC_EXPORT Impl
+impl()
+{
+    return currentKernels()->impl;
+}
+
+QTC_EXPORT bool
+setImpl(Impl impl)
+{
+    if (!supported(impl)) {
+        return false;
+    }
+    currentKernels() = kernelsFor(impl);
+    return true;
+}
+
+QTC_EXPORT void
+adjust(unsigned char *data, int numChannels, int w, int h, int stride,
+       int r, int g, int b, QtcPixelByteOrder order)
+{
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    // Since the subtracted value is in [0, 255], limiting the colors to
+    // [0, 510] doesn't change the (clamped) result and lets the vectorized
+    // versions work on 16bit integers.
+    r = qtcBound(0, r, 510);
+    g = qtcBound(0, g, 510);
+    b = qtcBound(0, b, 510);
+    currentKernels()->adjust[orderIndex(order)](data, numChannels, w, h,
+                                                stride, r, g, b);
+}
+
+QTC_EXPORT void
+fillShadow(unsigned char *data, const float *bias, size_t n,
+           const QtcColor *c1, const QtcColor *c2, QtcPixelByteOrder order)
+{
+    const ShadowColor color = {
+        {float(0xff * c2->red), float(0xff * c2->green),
+         float(0xff * c2->blue)},
+        {float(0xff * (c1->red - c2->red)),
+         float(0xff * (c1->green - c2->green)),
+         float(0xff * (c1->blue - c2->blue))},
+    };
+    currentKernels()->shadow[orderIndex(order)](data, bias, n, color);
+}
+
+}
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef _QTC_UTILS_PIXEL_H_
+#define _QTC_UTILS_PIXEL_H_
+
+#include "color.h"
+
+/**
+ * \file pixel.h
+ * \brief Vectorized pixel kernels with runtime CPU dispatch.
+ *
+ * The kernel set is picked once (the first time any of the functions is
+ * called) from the features of the running CPU. The byte order is a template
+ * parameter of every kernel so that the inner loops don't branch on it.
+ */
+
+namespace QtCurve {
+namespace Pixel {
+
+enum class Impl {
+    Scalar,
+    SSE2,
+    AVX2,
+};
+
+/**
+ * The kernel set currently in use.
+ */
+Impl impl();
+/**
+ * Whether \param impl can be used on this CPU.
+ */
+bool supported(Impl impl);
+/**
+ * Force a kernel set, mainly for tests and benchmarks. Not thread safe.
+ * \return false if \param impl is not supported by the CPU.
+ */
+bool setImpl(Impl impl);
+
+/**
+ * Replace the color channels of each pixel with (\param r, \param g,
+ * \param b) minus the second byte of the pixel, clamped to [0, 255].
+ * The alpha channel (if any) is left untouched. (See qtcAdjustPix)
+ */
+void adjust(unsigned char *data, int numChannels, int w, int h, int stride,
+            int r, int g, int b, QtcPixelByteOrder order);
+/**
+ * Fill \param n premultiplied 4 channel pixels mixing from \param c2 to
+ * \param c1 with alpha and mixing factor taken from \param bias.
+ */
+void fillShadow(unsigned char *data, const float *bias, size_t n,
+                const QtcColor *c1, const QtcColor *c2,
+                QtcPixelByteOrder order);
+
+}
+}
+
+#endif
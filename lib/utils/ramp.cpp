@@ -0,0 +1,148 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "ramp.h"
+#include "lrucache.h"
+#include "cachestats.h"
+#include "number.h"
+
+#include <mutex>
+
+namespace QtCurve {
+
+// A ramp of a builtin appearance has 2 to 8 stops (~40 bytes each). Most
+// styles draw with a few dozen color and gradient combinations.
+static const size_t rampCacheBudget = 64 * 1024;
+
+struct RampHash {
+    size_t
+    operator()(const Ramp &ramp) const
+    {
+        return ramp.hash();
+    }
+};
+
+static std::mutex rampCacheLock;
+static LRUCache<Ramp, RampStops, RampHash> rampCache(rampCacheBudget);
+static CacheRegistration rampCacheStats("shaded ramps",
+                                        [] (CacheReport *report) {
+                                            std::lock_guard<std::mutex> lock(
+                                                rampCacheLock);
+                                            reportCache(rampCache, report);
+                                        });
+
+static inline uint64_t
+doubleBits(double v)
+{
+    // Make -0.0 and 0.0 (which compare equal) hash the same.
+    v += 0.0;
+    uint64_t res;
+    memcpy(&res, &v, sizeof(res));
+    return res;
+}
+
+// Same as the qtcShade() of the toolkits.
+static inline void
+shade(const QtcColor &base, QtcColor *res, double k, Shading shading)
+{
+    if (qtcEqual(k, 1.0)) {
+        *res = base;
+    } else {
+        _qtcShade(&base, res, k, shading);
+    }
+}
+
+QTC_EXPORT
+Ramp::Ramp(const QtcColor &base, Shading shading, int flags)
+    : m_base(base),
+      m_shading(shading),
+      m_flags(flags)
+{
+    m_hash = hashCombine(doubleBits(base.red), doubleBits(base.green));
+    m_hash = hashCombine(m_hash, doubleBits(base.blue));
+    m_hash = hashCombine(m_hash, (uint64_t(shading) << 32) | unsigned(flags));
+}
+
+QTC_EXPORT void
+Ramp::add(double pos, double val, double alpha)
+{
+    m_stops.push_back(Source{pos, val, alpha});
+    m_hash = hashCombine(m_hash, doubleBits(pos));
+    m_hash = hashCombine(m_hash, doubleBits(val));
+    m_hash = hashCombine(m_hash, doubleBits(alpha));
+}
+
+QTC_EXPORT bool
+Ramp::operator==(const Ramp &other) const
+{
+    if (m_hash != other.m_hash || m_shading != other.m_shading ||
+        m_flags != other.m_flags || m_base.red != other.m_base.red ||
+        m_base.green != other.m_base.green ||
+        m_base.blue != other.m_base.blue ||
+        m_stops.size() != other.m_stops.size()) {
+        return false;
+    }
+    for (size_t i = 0;i < m_stops.size();i++) {
+        const Source &s1 = m_stops[i];
+        const Source &s2 = other.m_stops[i];
+        if (s1.pos != s2.pos || s1.val != s2.val || s1.alpha != s2.alpha) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QTC_EXPORT RampStops
+Ramp::stops() const
+{
+    std::lock_guard<std::mutex> lock(rampCacheLock);
+    return *rampCache.get(*this, [&] (size_t *cost) {
+            auto res = std::make_shared<std::vector<RampStop> >();
+            res->reserve(m_stops.size());
+            for (size_t i = 0;i < m_stops.size();i++) {
+                const Source &src = m_stops[i];
+                RampStop stop;
+                stop.pos = m_flags & Reverse ? 1.0 - src.pos : src.pos;
+                stop.alpha = m_flags & Opaque ? 1.0 : src.alpha;
+                if (m_flags & BaseEnd && i == m_stops.size() - 1) {
+                    stop.color = m_base;
+                } else {
+                    // INVERT_SHADE() of the styles.
+                    double val = (m_flags & Invert ?
+                                  qtcMax(2.0 - src.val, 0.9) : src.val);
+                    shade(m_base, &stop.color, val, m_shading);
+                }
+                res->push_back(stop);
+            }
+            *cost = (sizeof(Ramp) + sizeof(*res) +
+                     m_stops.size() * (sizeof(Source) + sizeof(RampStop)));
+            return RampStops(std::move(res));
+        });
+}
+
+QTC_EXPORT void
+Ramp::clear()
+{
+    std::lock_guard<std::mutex> lock(rampCacheLock);
+    rampCache.clear();
+}
+
+}
@@ -0,0 +1,124 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef _QTC_UTILS_RAMP_H_
+#define _QTC_UTILS_RAMP_H_
+
+#include "color.h"
+
+#include <iterator>
+#include <memory>
+#include <vector>
+
+/**
+ * \file ramp.h
+ * \brief Gradient stops shaded for a base color.
+ *
+ * The stops of an appearance only give the shade of each position relative
+ * to the color being drawn. A Ramp collects the stops of one gradient and
+ * shades them for its base color. The result is kept in a process wide
+ * (bounded) cache so that all the widgets drawn with the same color and
+ * gradient share it instead of shading every stop for every draw.
+ */
+
+namespace QtCurve {
+
+struct RampStop {
+    double pos;
+    QtcColor color;
+    double alpha;
+};
+
+typedef std::shared_ptr<const std::vector<RampStop> > RampStops;
+
+class Ramp {
+public:
+    enum {
+        /**
+         * Mirror the positions (bottom tabs).
+         */
+        Reverse = 1 << 0,
+        /**
+         * Invert the shades, never going below 0.9 (inverted bottom tabs).
+         */
+        Invert = 1 << 1,
+        /**
+         * Use the base color for the last stop (tabs and title bars, which
+         * blend into what is below them).
+         */
+        BaseEnd = 1 << 2,
+        /**
+         * Ignore the alpha of the stops.
+         */
+        Opaque = 1 << 3
+    };
+    Ramp(const QtcColor &base, Shading shading, int flags=0);
+    /**
+     * Make room for \param n stops, ramps are built for every draw.
+     */
+    void
+    reserve(size_t n)
+    {
+        m_stops.reserve(n);
+    }
+    void add(double pos, double val, double alpha);
+    template<typename Stops>
+    Ramp&
+    addAll(const Stops &stops)
+    {
+        reserve(m_stops.size() +
+                std::distance(std::begin(stops), std::end(stops)));
+        for (const auto &stop: stops) {
+            add(stop.pos, stop.val, stop.alpha);
+        }
+        return *this;
+    }
+    /**
+     * The shaded stops, in the order they were added.
+     */
+    RampStops stops() const;
+    /**
+     * Drop all cached ramps.
+     */
+    static void clear();
+
+    bool operator==(const Ramp &other) const;
+    uint64_t
+    hash() const
+    {
+        return m_hash;
+    }
+private:
+    struct Source {
+        double pos;
+        double val;
+        double alpha;
+    };
+    QtcColor m_base;
+    Shading m_shading;
+    int m_flags;
+    std::vector<Source> m_stops;
+    uint64_t m_hash;
+};
+
+}
+
+#endif
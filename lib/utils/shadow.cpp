@@ -20,6 +20,7 @@
  *****************************************************************************/
 
 #include "shadow_p.h"
+#include "pixel.h"
 #include "log.h"
 
 #include <cstdlib>
@@ -33,44 +34,6 @@ qtcCreateShadowGradient(float *buff, size_t size)
     }
 }
 
-static void
-qtcFillShadowPixel(uint8_t *pixel, const QtcColor *c1,
-                   const QtcColor *c2, double bias, QtcPixelByteOrder order)
-{
-    uint8_t alpha = qtcBound(0, 0xff * bias, 0xff);
-    if (alpha == 0) {
-        memset(pixel, 0, 4);
-        return;
-    }
-    QtcColor color;
-    // c1 is the start color, c2 the end color
-    _qtcColorMix(c2, c1, bias, &color);
-    uint8_t red = qtcBound(0, 0xff * color.red, 0xff) * alpha / 0xff;
-    uint8_t green = qtcBound(0, 0xff * color.green, 0xff) * alpha / 0xff;
-    uint8_t blue = qtcBound(0, 0xff * color.blue, 0xff) * alpha / 0xff;
-    switch (order) {
-    case QTC_PIXEL_ARGB:
-        pixel[0] = alpha;
-        pixel[1] = red;
-        pixel[2] = green;
-        pixel[3] = blue;
-        break;
-    case QTC_PIXEL_BGRA:
-        pixel[0] = blue;
-        pixel[1] = green;
-        pixel[2] = red;
-        pixel[3] = alpha;
-        break;
-    default:
-    case QTC_PIXEL_RGBA:
-        pixel[0] = red;
-        pixel[1] = green;
-        pixel[2] = blue;
-        pixel[3] = alpha;
-        break;
-    }
-}
-
 static inline float
 _qtcDistance(int x, int y, int x0, int y0, bool square)
 {
@@ -110,13 +73,14 @@ qtcShadowSubImage(size_t size, float *gradient, int vertical_align,
     int width = horizontal_align ? size : 1;
     int x0 = horizontal_align == -1 ? width - 1 : 0;
     auto *res = new QtCurve::Image(width, height, 4);
-    for (int x = 0;x < width;x++) {
-        for (int y = 0;y < height;y++) {
-            qtcFillShadowPixel(
-                &res->data[(x + y * width) * 4], c1, c2,
-                _qtcGradientGetValue(
-                    gradient, size, _qtcDistance(x, y, x0, y0, square)), order);
+    QtCurve::LocalBuff<float, 128> bias(width);
+    for (int y = 0;y < height;y++) {
+        for (int x = 0;x < width;x++) {
+            bias[x] = _qtcGradientGetValue(
+                gradient, size, _qtcDistance(x, y, x0, y0, square));
         }
+        QtCurve::Pixel::fillShadow(&res->data[y * width * 4], bias.get(),
+                                   width, c1, c2, order);
     }
     return res;
 }
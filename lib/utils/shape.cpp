@@ -0,0 +1,82 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "shape.h"
+#include "number.h"
+
+namespace QtCurve {
+namespace Shape {
+
+// How far the first rows of a corner are cut in.
+static const int fullInsets[] = {4, 2, 1, 1};
+static const int slightInsets[] = {2, 1};
+
+template<size_t N>
+static inline int
+rowInset(const int (&insets)[N], int row, int h)
+{
+    int inset = 0;
+    if (size_t(row) < N) {
+        inset = insets[row];
+    }
+    if (size_t(h - 1 - row) < N) {
+        inset = qtcMax(inset, insets[h - 1 - row]);
+    }
+    return inset;
+}
+
+template<size_t N>
+static size_t
+roundedRects(const int (&insets)[N], int w, int h, ShapeRect *rects)
+{
+    size_t num = 0;
+    int lastInset = -1;
+    for (int row = 0;row < h;row++) {
+        int inset = rowInset(insets, row, h);
+        if (inset == lastInset) {
+            rects[num - 1].height++;
+        } else if (w > inset * 2) {
+            rects[num++] = ShapeRect{inset, row, w - inset * 2, 1};
+            lastInset = inset;
+        } else {
+            lastInset = -1;
+        }
+        // Skip the rows in the middle that are all the full width.
+        if (inset == 0 && row < h - 1 - int(N)) {
+            rects[num - 1].height += h - 1 - int(N) - row;
+            row = h - 1 - int(N);
+        }
+    }
+    return num;
+}
+
+QTC_EXPORT size_t
+rounded(int w, int h, bool full, ShapeRect *rects)
+{
+    if (w <= 0 || h <= 0) {
+        return 0;
+    }
+    return (full ? roundedRects(fullInsets, w, h, rects) :
+            roundedRects(slightInsets, w, h, rects));
+}
+
+}
+}
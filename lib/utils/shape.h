@@ -1,5 +1,5 @@
 /*****************************************************************************
- *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
  *                                                                           *
  *   This program is free software; you can redistribute it and/or modify    *
  *   it under the terms of the GNU Lesser General Public License as          *
@@ -19,11 +19,46 @@
  *   see <http://www.gnu.org/licenses/>.                                     *
  *****************************************************************************/
 
-#ifndef _QTC_UTILS_X11SHADOW_P_H_
-#define _QTC_UTILS_X11SHADOW_P_H_
+#ifndef _QTC_UTILS_SHAPE_H_
+#define _QTC_UTILS_SHAPE_H_
 
-#include "x11shadow.h"
+#include "utils.h"
 
-void qtcX11ShadowInit();
+/**
+ * \file shape.h
+ * \brief Rectangle lists for the shape of windows with rounded corners.
+ *
+ * Popup menus and tooltips that can't use an alpha channel are shaped with
+ * these rectangles instead of a bitmap so that (re)shaping them only sends
+ * a handful of rectangles to the X server.
+ */
+
+namespace QtCurve {
+
+struct ShapeRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+namespace Shape {
+
+/**
+ * The largest number of rectangles returned by #rounded.
+ */
+static const size_t maxRects = 7;
+
+/**
+ * Fill \param rects with the rectangles whose union is a \param w x \param h
+ * window with rounded corners, \param full for the full rounding and the
+ * slight one otherwise. The rectangles are sorted by y, don't overlap and
+ * each covers the whole width of its rows (i.e. they are YX-banded). Returns
+ * the number of rectangles (at most #maxRects).
+ */
+size_t rounded(int w, int h, bool full, ShapeRect *rects);
+
+}
+}
 
 #endif
@@ -0,0 +1,184 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include "trace.h"
+#include "thread.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <unistd.h>
+
+namespace QtCurve {
+namespace Trace {
+
+// Spans kept per thread, older ones are overwritten.
+static const size_t bufferSize = 1 << 14;
+
+struct Event {
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+};
+
+struct Buffer {
+    std::mutex lock;
+    unsigned tid;
+    size_t next = 0;
+    bool wrapped = false;
+    Event events[bufferSize];
+};
+
+struct Registry {
+    std::mutex lock;
+    std::string path;
+    std::unordered_set<std::string> names;
+    std::vector<Buffer*> buffers;
+};
+
+// Never destroyed since the buffers are written at exit.
+static Registry&
+registry()
+{
+    static Registry *res = new Registry;
+    return *res;
+}
+
+// The buffer of a thread belongs to the registry and outlives the thread.
+struct ThreadBuffer {
+    Buffer *buff;
+    ThreadBuffer()
+        : buff(new Buffer)
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        buff->tid = reg.buffers.size() + 1;
+        reg.buffers.push_back(buff);
+    }
+};
+
+static ThreadLocal<ThreadBuffer> threadBuffer;
+
+static void
+flushAtExit()
+{
+    flush();
+}
+
+static bool
+init()
+{
+    const char *prefix = getenv("QTCURVE_TRACE");
+    if (!prefix || !*prefix) {
+        return false;
+    }
+    Registry &reg = registry();
+    {
+        std::lock_guard<std::mutex> guard(reg.lock);
+        reg.path = (std::string(prefix) + '-' + std::to_string(getpid()) +
+                    ".json");
+    }
+    atexit(flushAtExit);
+    return true;
+}
+
+QTC_EXPORT bool
+enabled()
+{
+    // Only checked when a trace site is first reached.
+    static const bool res = init();
+    return res;
+}
+
+QTC_EXPORT const char*
+intern(const char *name)
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    return reg.names.insert(name).first->c_str();
+}
+
+QTC_EXPORT void
+record(const char *name, uint64_t start)
+{
+    uint64_t end = getTime();
+    Buffer *buff = threadBuffer->buff;
+    std::lock_guard<std::mutex> guard(buff->lock);
+    buff->events[buff->next] = Event{name, start, end - start};
+    if (++buff->next == bufferSize) {
+        buff->next = 0;
+        buff->wrapped = true;
+    }
+}
+
+static void
+writeEvent(FILE *file, bool &first, unsigned tid, const Event &event)
+{
+    // Names are string literals in the source, only escape what would break
+    // the JSON string.
+    fputs(first ? "\n" : ",\n", file);
+    first = false;
+    fputs("{\"name\":\"", file);
+    for (const char *p = event.name;*p;p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*p, file);
+    }
+    fprintf(file, "\",\"cat\":\"qtcurve\",\"ph\":\"X\",\"ts\":%.3f,"
+            "\"dur\":%.3f,\"pid\":%d,\"tid\":%u}", event.start / 1000.0,
+            event.duration / 1000.0, (int)getpid(), tid);
+}
+
+QTC_EXPORT bool
+flush()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    if (reg.path.empty()) {
+        return false;
+    }
+    FILE *file = fopen(reg.path.c_str(), "w");
+    if (!file) {
+        qtcWarn("Cannot write trace to %s\n", reg.path.c_str());
+        return false;
+    }
+    fputs("{\"traceEvents\":[", file);
+    bool first = true;
+    for (auto buff: reg.buffers) {
+        std::lock_guard<std::mutex> buffGuard(buff->lock);
+        if (buff->wrapped) {
+            for (size_t i = buff->next;i < bufferSize;i++) {
+                writeEvent(file, first, buff->tid, buff->events[i]);
+            }
+        }
+        for (size_t i = 0;i < buff->next;i++) {
+            writeEvent(file, first, buff->tid, buff->events[i]);
+        }
+    }
+    fputs("\n]}\n", file);
+    return fclose(file) == 0;
+}
+
+}
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#ifndef _QTC_UTILS_TRACE_H_
+#define _QTC_UTILS_TRACE_H_
+
+#include "timer.h"
+
+/**
+ * \file trace.h
+ * \brief Scoped tracing spans in the Chrome trace event format.
+ *
+ * Tracing is enabled by setting QTCURVE_TRACE to a path prefix, the trace of
+ * each process is then written to <prefix>-<pid>.json at exit (or whenever
+ * Trace::flush() is called) and can be loaded in chrome://tracing. Each
+ * thread records into its own ring buffer so only the latest spans are kept.
+ * When tracing is disabled a span costs a load and a branch.
+ */
+
+#define __QTC_TRACE_CAT_(a, b) a##b
+#define __QTC_TRACE_CAT(a, b) __QTC_TRACE_CAT_(a, b)
+
+/**
+ * Trace the rest of the enclosing scope as \param name, which must be a
+ * string literal.
+ */
+#define qtcTrace(name)                                                  \
+    static const QtCurve::TraceSite                                     \
+    __QTC_TRACE_CAT(__qtc_trace_site_, __LINE__)(name);                \
+    const QtCurve::TraceSpan                                            \
+    __QTC_TRACE_CAT(__qtc_trace_span_, __LINE__)(                      \
+        __QTC_TRACE_CAT(__qtc_trace_site_, __LINE__))
+
+namespace QtCurve {
+namespace Trace {
+
+/**
+ * Whether QTCURVE_TRACE is set, read once per process.
+ */
+bool enabled();
+/**
+ * A copy of \param name that stays valid after the caller is unloaded.
+ */
+const char *intern(const char *name);
+/**
+ * Record a span \param name from \param start until now.
+ */
+void record(const char *name, uint64_t start);
+/**
+ * Write the recorded spans of all threads.
+ */
+bool flush();
+
+}
+
+class TraceSite {
+    TraceSite(const TraceSite&) = delete;
+public:
+    explicit TraceSite(const char *name)
+        : m_name(Trace::enabled() ? Trace::intern(name) : nullptr)
+    {
+    }
+    const char*
+    name() const
+    {
+        return m_name;
+    }
+private:
+    const char *m_name;
+};
+
+class TraceSpan {
+    TraceSpan(const TraceSpan&) = delete;
+public:
+    explicit TraceSpan(const TraceSite &site)
+        : m_name(site.name()),
+          m_start(qtcUnlikely(m_name) ? getTime() : 0)
+    {
+    }
+    ~TraceSpan()
+    {
+        if (qtcUnlikely(m_name)) {
+            Trace::record(m_name, m_start);
+        }
+    }
+private:
+    const char *m_name;
+    uint64_t m_start;
+};
+
+}
+
+#endif
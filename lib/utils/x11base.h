@@ -35,7 +35,13 @@ extern xcb_atom_t qtc_x11_qtc_opacity;
 extern xcb_atom_t qtc_x11_qtc_bgnd;
 
 bool qtcX11Enabled();
-void qtcX11InitXcb(xcb_connection_t *conn, int screen_no);
+/**
+ * \param disp is the Xlib display \param conn belongs to, if any. Only its
+ * name is kept (to reach the same server from another connection), use
+ * qtcX11InitXlib() to make requests through Xlib.
+ */
+void qtcX11InitXcb(xcb_connection_t *conn, int screen_no,
+                   void *disp=nullptr);
 void qtcX11InitXlib(void *disp);
 xcb_connection_t *qtcX11GetConn();
 void *qtcX11GetDisp();
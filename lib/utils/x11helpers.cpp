@@ -21,7 +21,7 @@
 
 #include "config.h"
 
-#include "x11shadow_p.h"
+#include "x11shadow.h"
 #include "x11wmmove.h"
 #include "x11blur.h"
 #include "x11qtc.h"
@@ -33,6 +33,7 @@ static int shadow_size = 30;
 
 #include "log.h"
 #include "number.h"
+#include "trace.h"
 #include "shadow_p.h"
 #include "x11utils_p.h"
 #include <X11/Xlib.h>
@@ -43,6 +44,10 @@ static int shadow_size = 30;
  * http://community.kde.org/KWin/Shadow
  **/
 
+// Bump when the look of the tiles changes so that tiles published by another
+// version are not picked up.
+#define QTC_SHADOW_VERSION 1
+
 static uint32_t shadow_xpixmaps[8];
 static uint32_t shadow_data_xcb[8 + 4];
 /**
@@ -55,27 +60,33 @@ static uint32_t shadow_data_xcb[8 + 4];
  * two separate data buffers.
  **/
 static unsigned long shadow_data_xlib[8 + 4];
+static bool shadow_ready = false;
+/**
+ * Shared tiles are kept by the server for the whole session and used by
+ * other processes as well, they must never be freed.
+ **/
+static bool shadow_shared = false;
 
 static xcb_pixmap_t
-qtcX11ShadowCreatePixmap(const QtCurve::Image *data)
+qtcX11ShadowCreatePixmap(xcb_connection_t *conn, xcb_window_t root,
+                         const QtCurve::Image *data)
 {
-    xcb_pixmap_t pixmap = qtcX11GenerateId();
+    xcb_pixmap_t pixmap = xcb_generate_id(conn);
 
     // create X11 pixmap
-    qtcX11CallVoid(create_pixmap, 32, pixmap, qtc_root_window,
-                   data->width, data->height);
-    xcb_gcontext_t cid = qtcX11GenerateId();
-    qtcX11CallVoid(create_gc, cid, pixmap, 0, (const uint32_t*)0);
-    qtcX11CallVoid(put_image, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, cid,
-                   data->width, data->height, 0, 0, 0, 32, data->data.size(),
-                   (unsigned char*)&data->data[0]);
-    qtcX11CallVoid(free_gc, cid);
-    qtcX11Flush();
+    xcb_create_pixmap(conn, 32, pixmap, root, data->width, data->height);
+    xcb_gcontext_t cid = xcb_generate_id(conn);
+    xcb_create_gc(conn, cid, pixmap, 0, (const uint32_t*)0);
+    xcb_put_image(conn, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, cid,
+                  data->width, data->height, 0, 0, 0, 32, data->data.size(),
+                  (unsigned char*)&data->data[0]);
+    xcb_free_gc(conn, cid);
     return pixmap;
 }
 
-void
-qtcX11ShadowInit()
+static void
+qtcX11ShadowCreatePixmaps(xcb_connection_t *conn, xcb_window_t root,
+                          uint32_t pixmaps[8])
 {
     int shadow_radius = 4;
     QtcColor c1 = {0.4, 0.4, 0.4};
@@ -84,9 +95,140 @@ qtcX11ShadowInit()
     qtcShadowCreate(shadow_size, &c1, &c2, shadow_radius, false,
                     QTC_PIXEL_XCB, shadow_images);
     for (int i = 0;i < 8;i++) {
-        shadow_xpixmaps[i] = qtcX11ShadowCreatePixmap(shadow_images[i]);
+        pixmaps[i] = qtcX11ShadowCreatePixmap(conn, root, shadow_images[i]);
         delete shadow_images[i];
     }
+}
+
+// The root window property the tiles of the current size are published on.
+static xcb_atom_t
+qtcX11ShadowAtom(xcb_connection_t *conn)
+{
+    char name[64];
+    sprintf(name, "_QTCURVE_SHADOW_%d_%d_", QTC_SHADOW_VERSION, shadow_size);
+    xcb_intern_atom_reply_t *r = xcb_intern_atom_reply(
+        conn, xcb_intern_atom(conn, 0, strlen(name), name), nullptr);
+    xcb_atom_t atom = r ? r->atom : 0;
+    free(r);
+    return atom;
+}
+
+// Read the tiles published with \param atom and check they are still alive.
+static bool
+qtcX11ShadowFind(xcb_connection_t *conn, xcb_atom_t atom, uint32_t pixmaps[8])
+{
+    xcb_get_property_reply_t *reply = xcb_get_property_reply(
+        conn, xcb_get_property(conn, 0, qtc_root_window, atom,
+                               XCB_ATOM_PIXMAP, 0, 8), nullptr);
+    bool found = (reply && reply->format == 32 &&
+                  xcb_get_property_value_length(reply) == 8 * 4);
+    if (found) {
+        memcpy(pixmaps, xcb_get_property_value(reply), 8 * 4);
+    }
+    free(reply);
+    if (!found) {
+        return false;
+    }
+    xcb_get_geometry_cookie_t cookies[8];
+    for (int i = 0;i < 8;i++) {
+        cookies[i] = xcb_get_geometry(conn, pixmaps[i]);
+    }
+    for (int i = 0;i < 8;i++) {
+        xcb_generic_error_t *err = nullptr;
+        xcb_get_geometry_reply_t *geom =
+            xcb_get_geometry_reply(conn, cookies[i], &err);
+        if (!geom || geom->depth != 32 || geom->width > shadow_size ||
+            geom->height > shadow_size) {
+            found = false;
+        }
+        free(geom);
+        free(err);
+    }
+    return found;
+}
+
+// Whether \param conn talks to the same server (and screen) as the main
+// connection. The setup of both must match, not only the root window id.
+static bool
+qtcX11SameServer(xcb_connection_t *conn, int screen_no)
+{
+    const xcb_setup_t *setup = xcb_get_setup(conn);
+    const xcb_setup_t *main_setup = xcb_get_setup(qtc_xcb_conn);
+    int vendor_len = xcb_setup_vendor_length(setup);
+    if (setup->release_number != main_setup->release_number ||
+        setup->roots_len != main_setup->roots_len ||
+        vendor_len != xcb_setup_vendor_length(main_setup) ||
+        memcmp(xcb_setup_vendor(setup), xcb_setup_vendor(main_setup),
+               vendor_len) != 0 || screen_no != qtc_default_screen_no) {
+        return false;
+    }
+    auto iter = xcb_setup_roots_iterator(setup);
+    for (;iter.rem && screen_no > 0;screen_no--) {
+        xcb_screen_next(&iter);
+    }
+    const xcb_screen_t *screen = iter.rem ? iter.data : nullptr;
+    const xcb_screen_t *main_screen = qtc_default_screen;
+    return (screen && main_screen && screen->root == main_screen->root &&
+            screen->root_visual == main_screen->root_visual &&
+            screen->width_in_pixels == main_screen->width_in_pixels &&
+            screen->height_in_pixels == main_screen->height_in_pixels &&
+            screen->root_depth == main_screen->root_depth);
+}
+
+// Create the tiles from a connection of their own that the server keeps
+// after it is closed and advertise them on the root window. The server is
+// grabbed so that only one process does this.
+// NOTE: The 8 pixmaps of each published shadow size stay in the server (as
+// RetainPermanent resources) until it is reset, i.e. for the whole session.
+static void
+qtcX11ShadowPublish(xcb_atom_t atom)
+{
+    int screen_no = 0;
+    // Same display as the main connection (nullptr means $DISPLAY).
+    xcb_connection_t *conn = xcb_connect(qtc_disp_name, &screen_no);
+    if (!xcb_connection_has_error(conn) &&
+        qtcX11SameServer(conn, screen_no)) {
+        uint32_t pixmaps[8];
+        xcb_grab_server(conn);
+        if (!qtcX11ShadowFind(conn, atom, pixmaps)) {
+            xcb_set_close_down_mode(conn, XCB_CLOSE_DOWN_RETAIN_PERMANENT);
+            qtcX11ShadowCreatePixmaps(conn, qtc_root_window, pixmaps);
+            xcb_change_property(conn, XCB_PROP_MODE_REPLACE, qtc_root_window,
+                                atom, XCB_ATOM_PIXMAP, 32, 8, pixmaps);
+        }
+        xcb_ungrab_server(conn);
+        free(xcb_get_input_focus_reply(conn, xcb_get_input_focus(conn),
+                                       nullptr));
+    }
+    xcb_disconnect(conn);
+}
+
+// The tiles are only generated when the first shadow is installed. Tiles
+// published on the root window by another process are reused, otherwise
+// they are generated and published for the following processes.
+static bool
+qtcX11ShadowEnsure()
+{
+    if (qtcLikely(shadow_ready)) {
+        return true;
+    }
+    qtcTrace("qtcX11ShadowEnsure");
+    QTC_RET_IF_FAIL(qtc_xcb_conn, false);
+    xcb_atom_t atom = qtcX11ShadowAtom(qtc_xcb_conn);
+    shadow_shared = false;
+    if (atom) {
+        shadow_shared = qtcX11ShadowFind(qtc_xcb_conn, atom, shadow_xpixmaps);
+        if (!shadow_shared) {
+            qtcX11ShadowPublish(atom);
+            shadow_shared = qtcX11ShadowFind(qtc_xcb_conn, atom,
+                                             shadow_xpixmaps);
+        }
+    }
+    if (!shadow_shared) {
+        qtcX11ShadowCreatePixmaps(qtc_xcb_conn, qtc_root_window,
+                                  shadow_xpixmaps);
+        qtcX11Flush();
+    }
 
     memcpy(shadow_data_xcb, shadow_xpixmaps, sizeof(shadow_xpixmaps));
     for (int i = 0;i < 8;i++) {
@@ -95,13 +237,18 @@ qtcX11ShadowInit()
     for (int i = 8;i < 12;i++) {
         shadow_data_xlib[i] = shadow_data_xcb[i] = shadow_size - 1;
     }
+    shadow_ready = true;
+    return true;
 }
 
-// Necessary?
-void
+static void
 qtcX11ShadowDestroy()
 {
-    QTC_RET_IF_FAIL(qtc_xcb_conn);
+    if (!shadow_ready) {
+        return;
+    }
+    shadow_ready = false;
+    QTC_RET_IF_FAIL(qtc_xcb_conn && !shadow_shared);
     for (unsigned int i = 0;
          i < sizeof(shadow_xpixmaps) / sizeof(shadow_xpixmaps[0]);i++) {
         qtcX11CallVoid(free_pixmap, shadow_xpixmaps[i]);
@@ -112,11 +259,13 @@ qtcX11ShadowDestroy()
 QTC_EXPORT void
 qtcX11ShadowInstall(xcb_window_t win, const int margins[4])
 {
+    qtcTrace("qtcX11ShadowInstall");
     QTC_RET_IF_FAIL(win);
     if (qtcUnlikely(!margins)) {
         qtcX11ShadowInstall(win);
         return;
     }
+    QTC_RET_IF_FAIL(qtcX11ShadowEnsure());
     // In principle, I should check for _KDE_NET_WM_SHADOW in _NET_SUPPORTED.
     // However, it's complicated and we will gain nothing.
     xcb_atom_t atom = qtc_x11_kde_net_wm_shadow;
@@ -143,7 +292,8 @@ qtcX11ShadowInstall(xcb_window_t win, const int margins[4])
 QTC_EXPORT void
 qtcX11ShadowInstall(xcb_window_t win)
 {
-    QTC_RET_IF_FAIL(win);
+    qtcTrace("qtcX11ShadowInstall");
+    QTC_RET_IF_FAIL(win && qtcX11ShadowEnsure());
     // In principle, I should check for _KDE_NET_WM_SHADOW in _NET_SUPPORTED.
     // However, it's complicated and we will gain nothing.
     xcb_atom_t atom = qtc_x11_kde_net_wm_shadow;
@@ -160,6 +310,7 @@ qtcX11ShadowInstall(xcb_window_t win)
 QTC_EXPORT void
 qtcX11ShadowUninstall(xcb_window_t win)
 {
+    qtcTrace("qtcX11ShadowUninstall");
     QTC_RET_IF_FAIL(win);
     qtcX11CallVoid(delete_property, win, qtc_x11_kde_net_wm_shadow);
     qtcX11Flush();
@@ -169,6 +320,7 @@ qtcX11ShadowUninstall(xcb_window_t win)
 QTC_EXPORT void
 qtcX11MoveTrigger(xcb_window_t wid, uint32_t x, uint32_t y)
 {
+    qtcTrace("qtcX11MoveTrigger");
     QTC_RET_IF_FAIL(wid);
     qtcX11FlushXlib();
     qtcX11CallVoid(ungrab_pointer, XCB_TIME_CURRENT_TIME);
@@ -200,6 +352,7 @@ QTC_EXPORT void
 qtcX11BlurTrigger(xcb_window_t wid, bool enable, unsigned prop_num,
                   const uint32_t *props)
 {
+    qtcTrace("qtcX11BlurTrigger");
     QTC_RET_IF_FAIL(wid);
     xcb_atom_t atom = qtc_x11_kde_net_wm_blur_behind_region;
     if (enable) {
@@ -221,56 +374,160 @@ qtcX11BlurTrigger(xcb_window_t wid, bool enable, unsigned prop_num,
     qtcX11Flush();
 }
 
-QTC_EXPORT int32_t
-qtcX11GetShortProp(xcb_window_t win, xcb_atom_t atom)
+QTC_EXPORT
+QtCurve::X11PropBatch::X11PropBatch()
+    : m_dirty(false)
 {
-    QTC_RET_IF_FAIL(qtc_xcb_conn && win, -1);
-    int32_t res = -1;
-    xcb_get_property_reply_t *reply =
-        qtcX11GetProperty(0, win, atom, XCB_ATOM_CARDINAL, 0, 1);
-    QTC_RET_IF_FAIL(reply, -1);
-    if (xcb_get_property_value_length(reply) > 0) {
-        uint32_t val = *(int32_t*)xcb_get_property_value(reply);
-        if (val < 512) {
-            res = val;
+}
+
+QTC_EXPORT
+QtCurve::X11PropBatch::~X11PropBatch()
+{
+    flush();
+    for (auto &get: m_gets) {
+        if (get.pending && qtc_xcb_conn) {
+            xcb_discard_reply(qtc_xcb_conn, get.cookie.sequence);
         }
     }
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::setShort(xcb_window_t win, xcb_atom_t atom,
+                                unsigned short val)
+{
+    QTC_RET_IF_FAIL(qtc_xcb_conn && win);
+    qtcX11CallVoid(change_property, XCB_PROP_MODE_REPLACE, win, atom,
+                   XCB_ATOM_CARDINAL, 16, 1, &val);
+    m_dirty = true;
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::setCardinal(xcb_window_t win, xcb_atom_t atom,
+                                   uint32_t val)
+{
+    QTC_RET_IF_FAIL(qtc_xcb_conn && win);
+    qtcX11CallVoid(change_property, XCB_PROP_MODE_REPLACE, win, atom,
+                   XCB_ATOM_CARDINAL, 32, 1, &val);
+    m_dirty = true;
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::remove(xcb_window_t win, xcb_atom_t atom)
+{
+    QTC_RET_IF_FAIL(qtc_xcb_conn && win);
+    qtcX11CallVoid(delete_property, win, atom);
+    m_dirty = true;
+}
+
+QTC_EXPORT unsigned
+QtCurve::X11PropBatch::get(xcb_window_t win, xcb_atom_t atom,
+                           const Callback &cb)
+{
+    Get get = {xcb_get_property_cookie_t(), false, false, 0, cb};
+    if (qtc_xcb_conn && win) {
+        get.cookie = xcb_get_property(qtc_xcb_conn, 0, win, atom,
+                                      XCB_ATOM_CARDINAL, 0, 1);
+        get.pending = true;
+        m_dirty = true;
+    }
+    m_gets.push_back(get);
+    return m_gets.size() - 1;
+}
+
+void
+QtCurve::X11PropBatch::resolve(Get &get)
+{
+    if (!get.pending) {
+        return;
+    }
+    get.pending = false;
+    xcb_get_property_reply_t *reply =
+        xcb_get_property_reply(qtc_xcb_conn, get.cookie, nullptr);
+    QTC_RET_IF_FAIL(reply);
+    const void *data = xcb_get_property_value(reply);
+    int len = xcb_get_property_value_length(reply);
+    if (reply->format == 32 && len >= 4) {
+        get.value = *(const uint32_t*)data;
+        get.found = true;
+    } else if (reply->format == 16 && len >= 2) {
+        get.value = *(const uint16_t*)data;
+        get.found = true;
+    } else if (reply->format == 8 && len >= 1) {
+        get.value = *(const uint8_t*)data;
+        get.found = true;
+    }
     free(reply);
-    return res;
 }
 
-static inline void
-qtcX11SetShortProp(xcb_window_t win, xcb_atom_t atom, unsigned short prop)
+QTC_EXPORT bool
+QtCurve::X11PropBatch::value(unsigned cookie, uint32_t *val)
 {
-    qtcX11ChangeProperty(XCB_PROP_MODE_REPLACE, win, atom,
-                         XCB_ATOM_CARDINAL, 16, 1, &prop);
-    qtcX11Flush();
+    QTC_RET_IF_FAIL(cookie < m_gets.size(), false);
+    Get &get = m_gets[cookie];
+    resolve(get);
+    if (get.found) {
+        *val = get.value;
+    }
+    return get.found;
+}
+
+QTC_EXPORT int32_t
+QtCurve::X11PropBatch::shortValue(unsigned cookie)
+{
+    uint32_t val;
+    if (value(cookie, &val) && val < 512) {
+        return val;
+    }
+    return -1;
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::flush()
+{
+    qtcTrace("X11PropBatch::flush");
+    if (m_dirty) {
+        m_dirty = false;
+        qtcX11Flush();
+    }
+    for (auto &get: m_gets) {
+        if (get.cb) {
+            resolve(get);
+            Callback cb;
+            std::swap(cb, get.cb);
+            cb(get.found, get.value);
+        }
+    }
+}
+
+QTC_EXPORT int32_t
+qtcX11GetShortProp(xcb_window_t win, xcb_atom_t atom)
+{
+    QtCurve::X11PropBatch batch;
+    return batch.shortValue(batch.get(win, atom));
 }
 
 QTC_EXPORT void
 qtcX11SetMenubarSize(xcb_window_t win, unsigned short s)
 {
-    qtcX11SetShortProp(win, qtc_x11_qtc_menubar_size, s);
+    QtCurve::X11PropBatch().setMenubarSize(win, s);
 }
 
 QTC_EXPORT void
 qtcX11SetStatusBar(xcb_window_t win)
 {
-    qtcX11SetShortProp(win, qtc_x11_qtc_statusbar, 1);
+    QtCurve::X11PropBatch().setStatusBar(win);
 }
 
 QTC_EXPORT void
 qtcX11SetOpacity(xcb_window_t win, unsigned short o)
 {
-    qtcX11SetShortProp(win, qtc_x11_qtc_opacity, o);
+    QtCurve::X11PropBatch().setOpacity(win, o);
 }
 
 QTC_EXPORT void
 qtcX11SetBgnd(xcb_window_t win, uint32_t prop)
 {
-    qtcX11ChangeProperty(XCB_PROP_MODE_REPLACE, win, qtc_x11_qtc_bgnd,
-                         XCB_ATOM_CARDINAL, 32, 1, &prop);
-    qtcX11Flush();
+    QtCurve::X11PropBatch().setBgnd(win, prop);
 }
 
 #else
@@ -302,6 +559,68 @@ qtcX11BlurTrigger(xcb_window_t, bool, unsigned, const uint32_t*)
 {
 }
 
+QTC_EXPORT
+QtCurve::X11PropBatch::X11PropBatch()
+    : m_dirty(false)
+{
+}
+
+QTC_EXPORT
+QtCurve::X11PropBatch::~X11PropBatch()
+{
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::setShort(xcb_window_t, xcb_atom_t, unsigned short)
+{
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::setCardinal(xcb_window_t, xcb_atom_t, uint32_t)
+{
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::remove(xcb_window_t, xcb_atom_t)
+{
+}
+
+QTC_EXPORT unsigned
+QtCurve::X11PropBatch::get(xcb_window_t, xcb_atom_t, const Callback &cb)
+{
+    m_gets.push_back({xcb_get_property_cookie_t(), false, false, 0, cb});
+    return m_gets.size() - 1;
+}
+
+void
+QtCurve::X11PropBatch::resolve(Get&)
+{
+}
+
+QTC_EXPORT bool
+QtCurve::X11PropBatch::value(unsigned, uint32_t*)
+{
+    return false;
+}
+
+QTC_EXPORT int32_t
+QtCurve::X11PropBatch::shortValue(unsigned)
+{
+    return -1;
+}
+
+QTC_EXPORT void
+QtCurve::X11PropBatch::flush()
+{
+    for (auto &get: m_gets) {
+        if (get.cb) {
+            Callback cb;
+            std::swap(cb, get.cb);
+            cb(false, 0);
+        }
+    }
+}
+
 QTC_EXPORT int32_t
 qtcX11GetShortProp(xcb_window_t, xcb_atom_t)
 {
@@ -337,7 +656,6 @@ qtcX11SetShadowSize(int size)
         shadow_size = size;
 #ifdef QTC_ENABLE_X11
         qtcX11ShadowDestroy();
-        qtcX11ShadowInit();
 #endif
     }
 }
@@ -24,10 +24,95 @@
 
 #include "x11base.h"
 
+#include <vector>
+#include <functional>
+
 int32_t qtcX11GetShortProp(xcb_window_t win, xcb_atom_t atom);
 void qtcX11SetMenubarSize(xcb_window_t win, unsigned short s);
 void qtcX11SetStatusBar(xcb_window_t win);
 void qtcX11SetOpacity(xcb_window_t win, unsigned short o);
 void qtcX11SetBgnd(xcb_window_t win, uint32_t prop);
 
+namespace QtCurve {
+
+/**
+ * A batch of window property requests that share a single flush.
+ *
+ * Setting a property only queues the request. Getting one only sends the
+ * request and returns a cookie, the reply is read when the value is first
+ * asked for (or passed to the callback in flush()), so any number of gets in
+ * a batch costs a single round trip. Everything still queued is flushed when
+ * the batch is destroyed.
+ */
+class X11PropBatch {
+public:
+    /**
+     * Called with whether the property is set and its value.
+     */
+    typedef std::function<void(bool, uint32_t)> Callback;
+
+    X11PropBatch();
+    ~X11PropBatch();
+    void setShort(xcb_window_t win, xcb_atom_t atom, unsigned short val);
+    void setCardinal(xcb_window_t win, xcb_atom_t atom, uint32_t val);
+    void remove(xcb_window_t win, xcb_atom_t atom);
+    void
+    setMenubarSize(xcb_window_t win, unsigned short s)
+    {
+        setShort(win, qtc_x11_qtc_menubar_size, s);
+    }
+    void
+    setStatusBar(xcb_window_t win)
+    {
+        setShort(win, qtc_x11_qtc_statusbar, 1);
+    }
+    void
+    setOpacity(xcb_window_t win, unsigned short o)
+    {
+        setShort(win, qtc_x11_qtc_opacity, o);
+    }
+    void
+    setBgnd(xcb_window_t win, uint32_t prop)
+    {
+        setCardinal(win, qtc_x11_qtc_bgnd, prop);
+    }
+    /**
+     * Request the CARDINAL property \param atom of \param win. The returned
+     * cookie can be passed to value() or shortValue().
+     */
+    unsigned get(xcb_window_t win, xcb_atom_t atom,
+                 const Callback &cb=Callback());
+    /**
+     * The value of the property requested with \param cookie, blocks if the
+     * reply hasn't been read yet. Returns false if the property is not set.
+     */
+    bool value(unsigned cookie, uint32_t *val);
+    /**
+     * Same as value() for the small QtCurve properties (menubar and statusbar
+     * sizes, opacity), returns -1 if the property is not set or invalid.
+     */
+    int32_t shortValue(unsigned cookie);
+    /**
+     * Send all the queued requests and run the callbacks of the gets.
+     */
+    void flush();
+private:
+    X11PropBatch(const X11PropBatch&) = delete;
+    X11PropBatch &operator=(const X11PropBatch&) = delete;
+
+    struct Get {
+        xcb_get_property_cookie_t cookie;
+        bool pending;
+        bool found;
+        uint32_t value;
+        Callback cb;
+    };
+    void resolve(Get &get);
+
+    std::vector<Get> m_gets;
+    bool m_dirty;
+};
+
+}
+
 #endif
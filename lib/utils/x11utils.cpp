@@ -35,15 +35,19 @@ QTC_EXPORT xcb_atom_t qtc_x11_qtc_bgnd;
 
 #ifdef QTC_ENABLE_X11
 
-#include "x11shadow_p.h"
 #include "x11wrap.h"
 #include "log.h"
 #include "x11utils_p.h"
 #include <X11/Xlib-xcb.h>
+#ifdef QTC_HAVE_XFIXES
+#  include <xcb/xfixes.h>
+#endif
+#include <unordered_map>
 // #include <X11/Xutil.h>
 // #include <X11/extensions/Xrender.h>
 
 void *qtc_disp = nullptr;
+char *qtc_disp_name = nullptr;
 xcb_connection_t *qtc_xcb_conn = nullptr;
 int qtc_default_screen_no = -1;
 xcb_window_t qtc_root_window = {0};
@@ -149,13 +153,16 @@ qtcX11GetScreen(int screen_no)
 }
 
 QTC_EXPORT void
-qtcX11InitXcb(xcb_connection_t *conn, int screen_no)
+qtcX11InitXcb(xcb_connection_t *conn, int screen_no, void *disp)
 {
     QTC_RET_IF_FAIL(!qtc_xcb_conn && conn);
     if (screen_no < 0) {
         screen_no = 0;
     }
     qtc_xcb_conn = conn;
+    if (disp) {
+        qtc_disp_name = strdup(DisplayString((Display*)disp));
+    }
     qtc_default_screen_no = screen_no;
     qtc_default_screen = screen_of_display(conn, screen_no);
     if (qtc_default_screen) {
@@ -164,7 +171,6 @@ qtcX11InitXcb(xcb_connection_t *conn, int screen_no)
     const size_t base_len = strlen("_NET_WM_CM_S");
     sprintf(wm_cm_s_atom_name + base_len, "%d", screen_no);
     qtcX11AtomsInit();
-    qtcX11ShadowInit();
 }
 
 QTC_EXPORT void
@@ -172,7 +178,8 @@ qtcX11InitXlib(void *disp)
 {
     QTC_RET_IF_FAIL(!qtc_xcb_conn && disp);
     qtc_disp = disp;
-    qtcX11InitXcb(XGetXCBConnection((Display*)disp), DefaultScreen(disp));
+    qtcX11InitXcb(XGetXCBConnection((Display*)disp), DefaultScreen(disp),
+                  disp);
 }
 
 QTC_EXPORT xcb_connection_t*
@@ -196,16 +203,112 @@ qtcX11MapRaised(xcb_window_t win)
     qtcX11CallVoid(map_window, win);
 }
 
-QTC_EXPORT bool
-qtcX11CompositingActive()
+// Compositing state, only kept up to date after qtcX11TrackCompositing().
+static bool cm_tracking = false;
+static xcb_window_t cm_owner = 0;
+#ifdef QTC_HAVE_XFIXES
+static uint8_t cm_xfixes_event = 0;
+#endif
+
+// The depth of a window never changes, forget it when the window is destroyed
+// (in case the id is reused). Bounded in case we never see the destroy.
+static std::unordered_map<xcb_window_t, uint8_t> win_depths;
+static const size_t max_win_depths = 256;
+
+static xcb_window_t
+qtcX11GetCMOwner()
 {
-    QTC_RET_IF_FAIL(qtc_xcb_conn, false);
     xcb_get_selection_owner_reply_t *reply =
         qtcX11Call(get_selection_owner, qtc_x11_net_wm_cm_s_default);
-    QTC_RET_IF_FAIL(reply, false);
-    bool res = (reply->owner != 0);
+    QTC_RET_IF_FAIL(reply, 0);
+    xcb_window_t owner = reply->owner;
     free(reply);
-    return res;
+    return owner;
+}
+
+QTC_EXPORT void
+qtcX11TrackCompositing()
+{
+    QTC_RET_IF_FAIL(qtc_xcb_conn && qtc_root_window);
+    if (cm_tracking) {
+        return;
+    }
+#ifdef QTC_HAVE_XFIXES
+    // XFixes reports every change of the selection owner, including the
+    // owner's window being destroyed or its client going away. Without it
+    // qtcX11CompositingActive() keeps asking the server.
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data(qtc_xcb_conn, &xcb_xfixes_id);
+    if (!ext || !ext->present) {
+        return;
+    }
+    xcb_xfixes_query_version_reply_t *version =
+        qtcX11Call(xfixes_query_version, XCB_XFIXES_MAJOR_VERSION,
+                   XCB_XFIXES_MINOR_VERSION);
+    QTC_RET_IF_FAIL(version);
+    free(version);
+    // Select before asking for the current owner so that no change can be
+    // missed in between.
+    xcb_generic_error_t *err = xcb_request_check(
+        qtc_xcb_conn, xcb_xfixes_select_selection_input_checked(
+            qtc_xcb_conn, qtc_root_window, qtc_x11_net_wm_cm_s_default,
+            XCB_XFIXES_SELECTION_EVENT_MASK_SET_SELECTION_OWNER |
+            XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_WINDOW_DESTROY |
+            XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_CLIENT_CLOSE));
+    if (err) {
+        free(err);
+        return;
+    }
+    cm_xfixes_event = ext->first_event + XCB_XFIXES_SELECTION_NOTIFY;
+    cm_owner = qtcX11GetCMOwner();
+    cm_tracking = true;
+#endif
+}
+
+QTC_EXPORT void
+qtcX11UntrackCompositing()
+{
+    if (!cm_tracking) {
+        return;
+    }
+    cm_tracking = false;
+    cm_owner = 0;
+#ifdef QTC_HAVE_XFIXES
+    qtcX11CallVoid(xfixes_select_selection_input, qtc_root_window,
+                   qtc_x11_net_wm_cm_s_default, 0);
+    qtcX11Flush();
+#endif
+}
+
+QTC_EXPORT void
+qtcX11FilterEvent(const xcb_generic_event_t *event)
+{
+    uint8_t type = event->response_type & ~0x80;
+    if (type == XCB_DESTROY_NOTIFY) {
+        auto destroy = (const xcb_destroy_notify_event_t*)event;
+        win_depths.erase(destroy->window);
+        return;
+    }
+#ifdef QTC_HAVE_XFIXES
+    if (cm_tracking && type == cm_xfixes_event) {
+        auto notify = (const xcb_xfixes_selection_notify_event_t*)event;
+        if (notify->window == qtc_root_window &&
+            notify->selection == qtc_x11_net_wm_cm_s_default) {
+            // None when the owner's window or client went away.
+            cm_owner = notify->owner;
+        }
+    }
+#endif
+}
+
+QTC_EXPORT bool
+qtcX11CompositingActive()
+{
+    QTC_RET_IF_FAIL(qtc_xcb_conn, false);
+    if (cm_tracking) {
+        return cm_owner != 0;
+    }
+    return qtcX11GetCMOwner() != 0;
 }
 
 QTC_EXPORT bool
@@ -215,11 +318,19 @@ qtcX11HasAlpha(xcb_window_t win)
     if (!qtcX11CompositingActive()) {
         return false;
     }
+    auto it = win_depths.find(win);
+    if (it != win_depths.end()) {
+        return it->second == 32;
+    }
     xcb_get_geometry_reply_t *reply = qtcX11Call(get_geometry, win);
     QTC_RET_IF_FAIL(reply, false);
-    bool res = (reply->depth == 32);
+    uint8_t depth = reply->depth;
     free(reply);
-    return res;
+    if (win_depths.size() >= max_win_depths) {
+        win_depths.clear();
+    }
+    win_depths[win] = depth;
+    return depth == 32;
 }
 
 QTC_EXPORT bool
@@ -303,7 +414,7 @@ qtcX11GetScreen(int)
 }
 
 QTC_EXPORT void
-qtcX11InitXcb(xcb_connection_t*, int)
+qtcX11InitXcb(xcb_connection_t*, int, void*)
 {
 }
 
@@ -329,6 +440,21 @@ qtcX11MapRaised(xcb_window_t)
 {
 }
 
+QTC_EXPORT void
+qtcX11TrackCompositing()
+{
+}
+
+QTC_EXPORT void
+qtcX11UntrackCompositing()
+{
+}
+
+QTC_EXPORT void
+qtcX11FilterEvent(const xcb_generic_event_t*)
+{
+}
+
 QTC_EXPORT bool
 qtcX11CompositingActive()
 {
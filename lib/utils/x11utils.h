@@ -25,6 +25,19 @@
 #include "x11base.h"
 
 void qtcX11MapRaised(xcb_window_t win);
+/**
+ * Keep the compositing state up to date from X events instead of asking the
+ * server on every qtcX11CompositingActive() call. The toolkit must pass the
+ * events it receives to qtcX11FilterEvent(). Does nothing if the server
+ * lacks the XFixes extension or qtcurve-utils is built without xcb-xfixes.
+ */
+void qtcX11TrackCompositing();
+/**
+ * Go back to asking the server, for when the toolkit stops passing events to
+ * qtcX11FilterEvent().
+ */
+void qtcX11UntrackCompositing();
+void qtcX11FilterEvent(const xcb_generic_event_t *event);
 bool qtcX11CompositingActive();
 bool qtcX11HasAlpha(xcb_window_t win);
 bool qtcX11IsEmbed(xcb_window_t win);
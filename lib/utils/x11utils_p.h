@@ -25,6 +25,7 @@
 #define _QTC_UTILS_X11UTILS_P_H_
 
 extern void *qtc_disp;
+extern char *qtc_disp_name;
 extern xcb_connection_t *qtc_xcb_conn;
 extern int qtc_default_screen_no;
 extern xcb_window_t qtc_root_window;
@@ -27,5 +27,9 @@ typedef struct xcb_screen_t xcb_screen_t;
 typedef uint32_t xcb_window_t;
 typedef struct xcb_query_tree_reply_t xcb_query_tree_reply_t;
 typedef struct xcb_get_property_reply_t xcb_get_property_reply_t;
+typedef struct xcb_generic_event_t xcb_generic_event_t;
+typedef struct {
+    unsigned int sequence;
+} xcb_get_property_cookie_t;
 #define XCB_ATOM_CARDINAL 6
 #define XCB_PROP_MODE_REPLACE 0
@@ -921,8 +921,10 @@ Style::Style()
 
 void Style::init(bool initial)
 {
-    if (!initial)
+    if (!initial) {
         freeColors();
+        qtcClearShadeColorsCache();
+    }
 
 #ifdef QTC_QT4_ENABLE_KDE
     if (initial) {
@@ -12756,17 +12758,17 @@ void Style::colorTab(QPainter *p, const QRect &r, bool horiz, EWidget tab, int r
 
 void Style::shadeColors(const QColor &base, QColor *vals) const
 {
+    static_assert(QTC_NUM_PALETTE_SHADES == ORIGINAL_SHADE + 1, "");
     bool useCustom(USE_CUSTOM_SHADES(opts));
-    double hl = TO_FACTOR(opts.highlightFactor);
+    QtcShadeParams params;
 
     for(int i=0; i<QTC_NUM_STD_SHADES; ++i)
-        shade(base, &vals[i], useCustom ? opts.customShades[i] :
-              qtcShadeGetIntern(opts.contrast, i,
-                                opts.darkerBorders, opts.shading));
-    shade(base, &vals[SHADE_ORIG_HIGHLIGHT], hl);
-    shade(vals[4], &vals[SHADE_4_HIGHLIGHT], hl);
-    shade(vals[2], &vals[SHADE_2_HIGHLIGHT], hl);
-    vals[ORIGINAL_SHADE]=base;
+        params.factors[i] = useCustom ? opts.customShades[i] :
+            qtcShadeGetIntern(opts.contrast, i, opts.darkerBorders,
+                              opts.shading);
+    params.highlight = TO_FACTOR(opts.highlightFactor);
+    params.shading = opts.shading;
+    qtcShadeColors(&base, &params, vals);
 }
 
 const QColor * Style::buttonColors(const QStyleOption *option) const
@@ -0,0 +1,630 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+// Headless rendering benchmark for the Qt5 style.
+//
+// Loads the freshly built style plugin, and draws every primitive, control
+// and complex control into an offscreen QImage for a set of widget states,
+// sizes and presets. For each combination the average time per call and
+// the number of heap allocations per call are reported, followed by the
+// statistics of the style's caches for each preset.
+//
+// Usage: qtcurve-qt5-benchmark [-n iterations] [-s plugin] [preset files...]
+// Without preset files, the current user configuration and all installed
+// presets are measured.
+
+#include <qtcurve-utils/timer.h>
+#include <qtcurve-utils/dirs.h>
+#include <qtcurve-utils/cachestats.h>
+
+#include <QAbstractSpinBox>
+#include <QApplication>
+#include <QFrame>
+#include <QImage>
+#include <QPainter>
+#include <QPluginLoader>
+#include <QSlider>
+#include <QStyle>
+#include <QStylePlugin>
+#include <QStyleOption>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Count heap allocations done by the calling process. Qt allocates through
+// both `operator new` and `malloc` directly, so hook the latter.
+static std::atomic<uint64_t> alloc_count(0);
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void*
+malloc(size_t size) noexcept
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void*
+calloc(size_t n, size_t size) noexcept
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void*
+realloc(void *ptr, size_t size) noexcept
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace {
+
+#define QTC_BENCH_ELEM(e) {QStyle::e, #e}
+
+template<typename T>
+struct Element {
+    T id;
+    const char *name;
+};
+
+static const Element<QStyle::PrimitiveElement> primitives[] = {
+    QTC_BENCH_ELEM(PE_Frame),
+    QTC_BENCH_ELEM(PE_FrameDefaultButton),
+    QTC_BENCH_ELEM(PE_FrameDockWidget),
+    QTC_BENCH_ELEM(PE_FrameFocusRect),
+    QTC_BENCH_ELEM(PE_FrameGroupBox),
+    QTC_BENCH_ELEM(PE_FrameLineEdit),
+    QTC_BENCH_ELEM(PE_FrameMenu),
+    QTC_BENCH_ELEM(PE_FrameStatusBarItem),
+    QTC_BENCH_ELEM(PE_FrameTabWidget),
+    QTC_BENCH_ELEM(PE_FrameWindow),
+    QTC_BENCH_ELEM(PE_FrameButtonBevel),
+    QTC_BENCH_ELEM(PE_FrameButtonTool),
+    QTC_BENCH_ELEM(PE_FrameTabBarBase),
+    QTC_BENCH_ELEM(PE_PanelButtonCommand),
+    QTC_BENCH_ELEM(PE_PanelButtonBevel),
+    QTC_BENCH_ELEM(PE_PanelButtonTool),
+    QTC_BENCH_ELEM(PE_PanelMenuBar),
+    QTC_BENCH_ELEM(PE_PanelToolBar),
+    QTC_BENCH_ELEM(PE_PanelLineEdit),
+    QTC_BENCH_ELEM(PE_IndicatorArrowDown),
+    QTC_BENCH_ELEM(PE_IndicatorArrowLeft),
+    QTC_BENCH_ELEM(PE_IndicatorArrowRight),
+    QTC_BENCH_ELEM(PE_IndicatorArrowUp),
+    QTC_BENCH_ELEM(PE_IndicatorBranch),
+    QTC_BENCH_ELEM(PE_IndicatorButtonDropDown),
+    QTC_BENCH_ELEM(PE_IndicatorViewItemCheck),
+    QTC_BENCH_ELEM(PE_IndicatorCheckBox),
+    QTC_BENCH_ELEM(PE_IndicatorDockWidgetResizeHandle),
+    QTC_BENCH_ELEM(PE_IndicatorHeaderArrow),
+    QTC_BENCH_ELEM(PE_IndicatorMenuCheckMark),
+    QTC_BENCH_ELEM(PE_IndicatorProgressChunk),
+    QTC_BENCH_ELEM(PE_IndicatorRadioButton),
+    QTC_BENCH_ELEM(PE_IndicatorSpinDown),
+    QTC_BENCH_ELEM(PE_IndicatorSpinMinus),
+    QTC_BENCH_ELEM(PE_IndicatorSpinPlus),
+    QTC_BENCH_ELEM(PE_IndicatorSpinUp),
+    QTC_BENCH_ELEM(PE_IndicatorToolBarHandle),
+    QTC_BENCH_ELEM(PE_IndicatorToolBarSeparator),
+    QTC_BENCH_ELEM(PE_PanelTipLabel),
+    QTC_BENCH_ELEM(PE_IndicatorTabTear),
+    QTC_BENCH_ELEM(PE_PanelScrollAreaCorner),
+    QTC_BENCH_ELEM(PE_Widget),
+    QTC_BENCH_ELEM(PE_IndicatorColumnViewArrow),
+    QTC_BENCH_ELEM(PE_IndicatorItemViewItemDrop),
+    QTC_BENCH_ELEM(PE_PanelItemViewItem),
+    QTC_BENCH_ELEM(PE_PanelItemViewRow),
+    QTC_BENCH_ELEM(PE_PanelStatusBar),
+    QTC_BENCH_ELEM(PE_IndicatorTabClose),
+    QTC_BENCH_ELEM(PE_PanelMenu),
+};
+
+static const Element<QStyle::ControlElement> controls[] = {
+    QTC_BENCH_ELEM(CE_PushButton),
+    QTC_BENCH_ELEM(CE_PushButtonBevel),
+    QTC_BENCH_ELEM(CE_PushButtonLabel),
+    QTC_BENCH_ELEM(CE_CheckBox),
+    QTC_BENCH_ELEM(CE_CheckBoxLabel),
+    QTC_BENCH_ELEM(CE_RadioButton),
+    QTC_BENCH_ELEM(CE_RadioButtonLabel),
+    QTC_BENCH_ELEM(CE_TabBarTab),
+    QTC_BENCH_ELEM(CE_TabBarTabShape),
+    QTC_BENCH_ELEM(CE_TabBarTabLabel),
+    QTC_BENCH_ELEM(CE_ProgressBar),
+    QTC_BENCH_ELEM(CE_ProgressBarGroove),
+    QTC_BENCH_ELEM(CE_ProgressBarContents),
+    QTC_BENCH_ELEM(CE_ProgressBarLabel),
+    QTC_BENCH_ELEM(CE_MenuItem),
+    QTC_BENCH_ELEM(CE_MenuScroller),
+    QTC_BENCH_ELEM(CE_MenuVMargin),
+    QTC_BENCH_ELEM(CE_MenuHMargin),
+    QTC_BENCH_ELEM(CE_MenuTearoff),
+    QTC_BENCH_ELEM(CE_MenuEmptyArea),
+    QTC_BENCH_ELEM(CE_MenuBarItem),
+    QTC_BENCH_ELEM(CE_MenuBarEmptyArea),
+    QTC_BENCH_ELEM(CE_ToolButtonLabel),
+    QTC_BENCH_ELEM(CE_Header),
+    QTC_BENCH_ELEM(CE_HeaderSection),
+    QTC_BENCH_ELEM(CE_HeaderLabel),
+    QTC_BENCH_ELEM(CE_ToolBoxTab),
+    QTC_BENCH_ELEM(CE_SizeGrip),
+    QTC_BENCH_ELEM(CE_Splitter),
+    QTC_BENCH_ELEM(CE_RubberBand),
+    QTC_BENCH_ELEM(CE_DockWidgetTitle),
+    QTC_BENCH_ELEM(CE_ScrollBarAddLine),
+    QTC_BENCH_ELEM(CE_ScrollBarSubLine),
+    QTC_BENCH_ELEM(CE_ScrollBarAddPage),
+    QTC_BENCH_ELEM(CE_ScrollBarSubPage),
+    QTC_BENCH_ELEM(CE_ScrollBarSlider),
+    QTC_BENCH_ELEM(CE_ScrollBarFirst),
+    QTC_BENCH_ELEM(CE_ScrollBarLast),
+    QTC_BENCH_ELEM(CE_FocusFrame),
+    QTC_BENCH_ELEM(CE_ComboBoxLabel),
+    QTC_BENCH_ELEM(CE_ToolBar),
+    QTC_BENCH_ELEM(CE_ToolBoxTabShape),
+    QTC_BENCH_ELEM(CE_ToolBoxTabLabel),
+    QTC_BENCH_ELEM(CE_HeaderEmptyArea),
+    QTC_BENCH_ELEM(CE_ColumnViewGrip),
+    QTC_BENCH_ELEM(CE_ItemViewItem),
+    QTC_BENCH_ELEM(CE_ShapedFrame),
+};
+
+static const Element<QStyle::ComplexControl> complexControls[] = {
+    QTC_BENCH_ELEM(CC_SpinBox),
+    QTC_BENCH_ELEM(CC_ComboBox),
+    QTC_BENCH_ELEM(CC_ScrollBar),
+    QTC_BENCH_ELEM(CC_Slider),
+    QTC_BENCH_ELEM(CC_ToolButton),
+    QTC_BENCH_ELEM(CC_TitleBar),
+    QTC_BENCH_ELEM(CC_Dial),
+    QTC_BENCH_ELEM(CC_GroupBox),
+    QTC_BENCH_ELEM(CC_MdiControls),
+};
+
+#undef QTC_BENCH_ELEM
+
+static const struct {
+    QStyle::State state;
+    const char *name;
+} states[] = {
+    {QStyle::State_Enabled | QStyle::State_Active, "normal"},
+    {QStyle::State_Enabled | QStyle::State_Active |
+     QStyle::State_MouseOver, "hover"},
+    {QStyle::State_Enabled | QStyle::State_Active | QStyle::State_Sunken |
+     QStyle::State_On, "sunken"},
+    {QStyle::State_Enabled | QStyle::State_Active |
+     QStyle::State_HasFocus, "focus"},
+    {QStyle::State_None, "disabled"},
+};
+
+static const QSize sizes[] = {
+    QSize(16, 16),
+    QSize(120, 28),
+    QSize(400, 300),
+};
+
+static const QString benchText = QStringLiteral("QtCurve");
+
+// Create an option of the type the style expects for the given element,
+// with enough of its fields filled in to take the usual drawing paths.
+static QStyleOption*
+createOption(QStyle::PrimitiveElement pe)
+{
+    switch (pe) {
+    case QStyle::PE_FrameFocusRect:
+        return new QStyleOptionFocusRect;
+    case QStyle::PE_IndicatorCheckBox:
+    case QStyle::PE_IndicatorRadioButton:
+    case QStyle::PE_PanelButtonCommand:
+    case QStyle::PE_PanelButtonBevel:
+    case QStyle::PE_FrameDefaultButton:
+    case QStyle::PE_FrameButtonBevel: {
+        auto opt = new QStyleOptionButton;
+        opt->text = benchText;
+        return opt;
+    }
+    case QStyle::PE_PanelButtonTool:
+    case QStyle::PE_FrameButtonTool:
+    case QStyle::PE_IndicatorButtonDropDown:
+        return new QStyleOptionToolButton;
+    case QStyle::PE_Frame:
+    case QStyle::PE_FrameDockWidget:
+    case QStyle::PE_FrameGroupBox:
+    case QStyle::PE_FrameLineEdit:
+    case QStyle::PE_FrameMenu:
+    case QStyle::PE_FrameWindow:
+    case QStyle::PE_PanelLineEdit:
+    case QStyle::PE_PanelMenu:
+    case QStyle::PE_PanelMenuBar:
+    case QStyle::PE_PanelTipLabel: {
+        auto opt = new QStyleOptionFrame;
+        opt->lineWidth = 1;
+        opt->midLineWidth = 0;
+        return opt;
+    }
+    case QStyle::PE_FrameTabWidget:
+        return new QStyleOptionTabWidgetFrame;
+    case QStyle::PE_FrameTabBarBase:
+        return new QStyleOptionTabBarBase;
+    case QStyle::PE_IndicatorHeaderArrow: {
+        auto opt = new QStyleOptionHeader;
+        opt->sortIndicator = QStyleOptionHeader::SortUp;
+        return opt;
+    }
+    case QStyle::PE_PanelToolBar:
+        return new QStyleOptionToolBar;
+    case QStyle::PE_IndicatorProgressChunk:
+        return new QStyleOptionProgressBar;
+    case QStyle::PE_PanelItemViewItem:
+    case QStyle::PE_PanelItemViewRow:
+    case QStyle::PE_IndicatorViewItemCheck: {
+        auto opt = new QStyleOptionViewItem;
+        opt->text = benchText;
+        opt->features = QStyleOptionViewItem::HasDisplay;
+        return opt;
+    }
+    default:
+        return new QStyleOption;
+    }
+}
+
+static QStyleOption*
+createOption(QStyle::ControlElement ce)
+{
+    switch (ce) {
+    case QStyle::CE_PushButton:
+    case QStyle::CE_PushButtonBevel:
+    case QStyle::CE_PushButtonLabel:
+    case QStyle::CE_CheckBox:
+    case QStyle::CE_CheckBoxLabel:
+    case QStyle::CE_RadioButton:
+    case QStyle::CE_RadioButtonLabel: {
+        auto opt = new QStyleOptionButton;
+        opt->text = benchText;
+        return opt;
+    }
+    case QStyle::CE_TabBarTab:
+    case QStyle::CE_TabBarTabShape:
+    case QStyle::CE_TabBarTabLabel: {
+        auto opt = new QStyleOptionTab;
+        opt->text = benchText;
+        opt->position = QStyleOptionTab::Middle;
+        return opt;
+    }
+    case QStyle::CE_ProgressBar:
+    case QStyle::CE_ProgressBarGroove:
+    case QStyle::CE_ProgressBarContents:
+    case QStyle::CE_ProgressBarLabel: {
+        auto opt = new QStyleOptionProgressBar;
+        opt->minimum = 0;
+        opt->maximum = 100;
+        opt->progress = 42;
+        opt->text = QStringLiteral("42%");
+        opt->textVisible = true;
+        return opt;
+    }
+    case QStyle::CE_MenuItem:
+    case QStyle::CE_MenuScroller:
+    case QStyle::CE_MenuVMargin:
+    case QStyle::CE_MenuHMargin:
+    case QStyle::CE_MenuTearoff:
+    case QStyle::CE_MenuEmptyArea:
+    case QStyle::CE_MenuBarItem:
+    case QStyle::CE_MenuBarEmptyArea: {
+        auto opt = new QStyleOptionMenuItem;
+        opt->text = benchText;
+        opt->menuItemType = QStyleOptionMenuItem::Normal;
+        opt->checkType = QStyleOptionMenuItem::NonExclusive;
+        return opt;
+    }
+    case QStyle::CE_ToolButtonLabel: {
+        auto opt = new QStyleOptionToolButton;
+        opt->text = benchText;
+        opt->toolButtonStyle = Qt::ToolButtonTextOnly;
+        return opt;
+    }
+    case QStyle::CE_Header:
+    case QStyle::CE_HeaderSection:
+    case QStyle::CE_HeaderLabel:
+    case QStyle::CE_HeaderEmptyArea: {
+        auto opt = new QStyleOptionHeader;
+        opt->text = benchText;
+        opt->position = QStyleOptionHeader::Middle;
+        return opt;
+    }
+    case QStyle::CE_ToolBoxTab:
+    case QStyle::CE_ToolBoxTabShape:
+    case QStyle::CE_ToolBoxTabLabel: {
+        auto opt = new QStyleOptionToolBox;
+        opt->text = benchText;
+        return opt;
+    }
+    case QStyle::CE_SizeGrip:
+        return new QStyleOptionSizeGrip;
+    case QStyle::CE_RubberBand:
+        return new QStyleOptionRubberBand;
+    case QStyle::CE_DockWidgetTitle: {
+        auto opt = new QStyleOptionDockWidget;
+        opt->title = benchText;
+        return opt;
+    }
+    case QStyle::CE_ScrollBarAddLine:
+    case QStyle::CE_ScrollBarSubLine:
+    case QStyle::CE_ScrollBarAddPage:
+    case QStyle::CE_ScrollBarSubPage:
+    case QStyle::CE_ScrollBarSlider:
+    case QStyle::CE_ScrollBarFirst:
+    case QStyle::CE_ScrollBarLast: {
+        auto opt = new QStyleOptionSlider;
+        opt->minimum = 0;
+        opt->maximum = 100;
+        opt->sliderPosition = opt->sliderValue = 30;
+        opt->pageStep = 10;
+        return opt;
+    }
+    case QStyle::CE_ComboBoxLabel: {
+        auto opt = new QStyleOptionComboBox;
+        opt->currentText = benchText;
+        return opt;
+    }
+    case QStyle::CE_ToolBar:
+        return new QStyleOptionToolBar;
+    case QStyle::CE_ItemViewItem: {
+        auto opt = new QStyleOptionViewItem;
+        opt->text = benchText;
+        opt->features = QStyleOptionViewItem::HasDisplay;
+        return opt;
+    }
+    case QStyle::CE_ShapedFrame: {
+        auto opt = new QStyleOptionFrame;
+        opt->frameShape = QFrame::StyledPanel;
+        opt->lineWidth = 1;
+        return opt;
+    }
+    default:
+        return new QStyleOption;
+    }
+}
+
+static QStyleOption*
+createOption(QStyle::ComplexControl cc)
+{
+    QStyleOptionComplex *res;
+    switch (cc) {
+    case QStyle::CC_SpinBox: {
+        auto opt = new QStyleOptionSpinBox;
+        opt->frame = true;
+        opt->stepEnabled = (QAbstractSpinBox::StepUpEnabled |
+                            QAbstractSpinBox::StepDownEnabled);
+        res = opt;
+        break;
+    }
+    case QStyle::CC_ComboBox: {
+        auto opt = new QStyleOptionComboBox;
+        opt->currentText = benchText;
+        opt->frame = true;
+        res = opt;
+        break;
+    }
+    case QStyle::CC_ScrollBar:
+    case QStyle::CC_Slider:
+    case QStyle::CC_Dial: {
+        auto opt = new QStyleOptionSlider;
+        opt->minimum = 0;
+        opt->maximum = 100;
+        opt->sliderPosition = opt->sliderValue = 30;
+        opt->pageStep = 10;
+        opt->tickPosition = QSlider::TicksBelow;
+        opt->tickInterval = 10;
+        res = opt;
+        break;
+    }
+    case QStyle::CC_ToolButton: {
+        auto opt = new QStyleOptionToolButton;
+        opt->text = benchText;
+        opt->toolButtonStyle = Qt::ToolButtonTextOnly;
+        opt->features = QStyleOptionToolButton::MenuButtonPopup;
+        res = opt;
+        break;
+    }
+    case QStyle::CC_TitleBar: {
+        auto opt = new QStyleOptionTitleBar;
+        opt->text = benchText;
+        opt->titleBarFlags = (Qt::WindowTitleHint | Qt::WindowSystemMenuHint |
+                              Qt::WindowMinMaxButtonsHint |
+                              Qt::WindowCloseButtonHint);
+        res = opt;
+        break;
+    }
+    case QStyle::CC_GroupBox: {
+        auto opt = new QStyleOptionGroupBox;
+        opt->text = benchText;
+        opt->lineWidth = 1;
+        res = opt;
+        break;
+    }
+    default:
+        res = new QStyleOptionComplex;
+        break;
+    }
+    res->subControls = QStyle::SC_All;
+    return res;
+}
+
+struct Result {
+    uint64_t ns;
+    uint64_t allocs;
+};
+
+class Bench {
+public:
+    Bench(int iterations)
+        : m_iterations(iterations),
+          m_image(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1],
+                  QImage::Format_ARGB32_Premultiplied)
+    {
+    }
+    template<typename T, typename Draw>
+    void
+    run(const char *preset, const Element<T> &elem, Draw &&draw)
+    {
+        std::unique_ptr<QStyleOption> opt(createOption(elem.id));
+        for (const auto &state: states) {
+            for (const auto &size: sizes) {
+                opt->state = state.state;
+                opt->rect = QRect(QPoint(0, 0), size);
+                opt->palette = QApplication::palette();
+                opt->palette.setCurrentColorGroup(
+                    (state.state & QStyle::State_Enabled) ?
+                    QPalette::Active : QPalette::Disabled);
+                opt->direction = Qt::LeftToRight;
+                opt->fontMetrics = QApplication::fontMetrics();
+                Result res = measure(opt.get(), draw);
+                printf("%s\t%s\t%s\t%dx%d\t%.1f\t%.2f\n", preset, elem.name,
+                       state.name, size.width(), size.height(),
+                       double(res.ns) / m_iterations,
+                       double(res.allocs) / m_iterations);
+            }
+        }
+    }
+private:
+    template<typename Draw>
+    Result
+    measure(const QStyleOption *opt, Draw &draw)
+    {
+        m_image.fill(Qt::transparent);
+        QPainter painter(&m_image);
+        // Warm up the caches so that we measure the steady state.
+        draw(opt, &painter);
+        uint64_t allocs = alloc_count.load(std::memory_order_relaxed);
+        uint64_t start = QtCurve::getTime();
+        for (int i = 0;i < m_iterations;i++) {
+            draw(opt, &painter);
+        }
+        Result res;
+        res.ns = QtCurve::getElapse(start);
+        res.allocs = alloc_count.load(std::memory_order_relaxed) - allocs;
+        return res;
+    }
+    int m_iterations;
+    QImage m_image;
+};
+
+static QStyle*
+loadStyle(const QString &plugin_path)
+{
+    QPluginLoader loader(plugin_path);
+    auto plugin = qobject_cast<QStylePlugin*>(loader.instance());
+    if (!plugin) {
+        fprintf(stderr, "Cannot load style plugin %s: %s\n",
+                qPrintable(plugin_path), qPrintable(loader.errorString()));
+        return nullptr;
+    }
+    return plugin->create(QStringLiteral("qtcurve"));
+}
+
+static void
+benchStyle(const char *preset, int iterations, const QString &plugin_path)
+{
+    QStyle *style = loadStyle(plugin_path);
+    if (!style) {
+        return;
+    }
+    // The application takes ownership of the style, polishes the palette
+    // and deletes the previous style instance.
+    QApplication::setStyle(style);
+    Bench bench(iterations);
+    for (const auto &pe: primitives) {
+        bench.run(preset, pe, [&] (const QStyleOption *opt, QPainter *p) {
+                style->drawPrimitive(pe.id, opt, p, nullptr);
+            });
+    }
+    for (const auto &ce: controls) {
+        bench.run(preset, ce, [&] (const QStyleOption *opt, QPainter *p) {
+                style->drawControl(ce.id, opt, p, nullptr);
+            });
+    }
+    for (const auto &cc: complexControls) {
+        bench.run(preset, cc, [&] (const QStyleOption *opt, QPainter *p) {
+                style->drawComplexControl(
+                    cc.id, static_cast<const QStyleOptionComplex*>(opt),
+                    p, nullptr);
+            });
+    }
+    // E.g. how many of the rounded outlines were shared instead of built.
+    for (const auto &cache: QtCurve::CacheRegistry::collect()) {
+        const auto &report = cache.second;
+        printf("# %s\tcache %s\t%" PRIu64 " hits\t%" PRIu64 " misses\t"
+               "%" PRIu64 " evictions\t%" PRIu64 " bytes\n", preset,
+               cache.first.c_str(), report.hits, report.misses,
+               report.evictions, report.bytes);
+    }
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    int iterations = 100;
+    QString plugin_path = QStringLiteral(QTC_BENCHMARK_STYLE_PLUGIN);
+    std::vector<std::pair<std::string, std::string> > presets;
+    for (int i = 1;i < argc;i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = qMax(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            plugin_path = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            presets.emplace_back(argv[i], argv[i]);
+        }
+    }
+    if (presets.empty()) {
+        // An empty file name makes the style read the user configuration.
+        presets.emplace_back("default", "");
+        for (const auto &preset: QtCurve::getPresets()) {
+            presets.push_back(preset);
+        }
+    }
+
+    printf("# preset\telement\tstate\tsize\tns/op\tallocs/op\n");
+    for (const auto &preset: presets) {
+        if (preset.second.empty()) {
+            unsetenv("QTCURVE_CONFIG_FILE");
+        } else {
+            setenv("QTCURVE_CONFIG_FILE", preset.second.c_str(), 1);
+        }
+        benchStyle(preset.first.c_str(), iterations, plugin_path);
+    }
+    return 0;
+}
@@ -43,6 +43,8 @@
 #include <QApplication>
 #include <map>
 #include <set>
+#include <vector>
+#include <algorithm>
 #include <QString>
 #include <QFont>
 #include <QPixmap>
@@ -681,19 +683,37 @@ typedef struct
         sides;
 } WindowBorders;
 
-struct GradientStopCont : public std::set<GradientStop>
+// Sorted and without duplicates like a std::set, but contiguous so that
+// drawing a gradient walks a plain array.
+struct GradientStopCont : public std::vector<GradientStop>
 {
+    using std::vector<GradientStop>::erase;
+
+    std::pair<iterator, bool> insert(const GradientStop &stop)
+    {
+        iterator it(std::lower_bound(begin(), end(), stop));
+        if(it!=end() && !(stop<*it))
+            return std::make_pair(it, false);
+        return std::make_pair(std::vector<GradientStop>::insert(it, stop), true);
+    }
+
+    size_type erase(const GradientStop &stop)
+    {
+        iterator it(std::lower_bound(begin(), end(), stop));
+        if(it==end() || stop<*it)
+            return 0;
+        erase(it);
+        return 1;
+    }
+
     GradientStopCont fix() const
     {
         GradientStopCont c(*this);
         if(size())
         {
-            GradientStopCont::const_iterator   first(c.begin());
-            GradientStopCont::reverse_iterator last(c.rbegin());
-
-            if((*first).pos>0.001)
+            if(c.front().pos>0.001)
                 c.insert(GradientStop(0.0, 1.0));
-            if((*last).pos<0.999)
+            if(c.back().pos<0.999)
                 c.insert(GradientStop(1.0, 1.0));
         }
         return c;
@@ -22,6 +22,9 @@
 
 #include <qtcurve-utils/dirs.h>
 #include <qtcurve-utils/color.h>
+#include <qtcurve-utils/confcache.h>
+#include <qtcurve-utils/lrucache.h>
+#include <qtcurve-utils/trace.h>
 #include "common.h"
 #include "config_file.h"
 
@@ -1070,8 +1073,193 @@ void qtcCheckConfig(Options *opts)
         opts->toolbarSeparators=LINE_DOTS;
 }
 
+#ifndef CONFIG_DIALOG
+// Binary snapshot of the options read by the style, see confcache.h.
+// Everything from version up to customGradient (except titlebarButtonColors)
+// is plain data and is copied as is.
+#define CACHE_STRINGS(F)                                                \
+    F(noBgndGradientApps) F(noBgndOpacityApps) F(noMenuBgndOpacityApps) \
+    F(noBgndImageApps) F(noMenuStripeApps) F(menubarApps) F(statusbarApps) \
+    F(useQtFileDialogApps) F(windowDragWhiteList) F(windowDragBlackList) \
+    F(nonnativeMenubarApps)
+
+static uint64_t
+cacheLayout(const Options *opts)
+{
+    const char *base = (const char*)opts;
+    uint64_t layout = QtCurve::hashCombine(sizeof(Options), sizeof(QColor));
+    layout = QtCurve::hashCombine(
+        layout, (const char*)&opts->titlebarButtonColors - base);
+    layout = QtCurve::hashCombine(layout, (const char*)&opts->titlebarIcon - base);
+    layout = QtCurve::hashCombine(
+        layout, (const char*)&opts->customGradient - base);
+    return QtCurve::hashCombine(layout, QT_VERSION);
+}
+
+static void
+writeCacheStr(QtCurve::ConfCache::Writer &w, const QString &str)
+{
+    QByteArray utf8(str.toUtf8());
+    w.putStr(utf8.constData(), utf8.size());
+}
+
+static bool
+readCacheStr(QtCurve::ConfCache::Reader &r, QString *str)
+{
+    const char *data;
+    size_t len;
+    if (!r.getStr(&data, &len))
+        return false;
+    *str = QString::fromUtf8(data, int(len));
+    return true;
+}
+
+static void
+writeCacheImage(QtCurve::ConfCache::Writer &w, const QtCImage &img)
+{
+    w.put<int>(img.type);
+    w.put<bool>(img.onBorder);
+    w.put<int>(img.width);
+    w.put<int>(img.height);
+    w.put<int>(img.pos);
+    writeCacheStr(w, img.pixmap.file);
+}
+
+static bool
+readCacheImage(QtCurve::ConfCache::Reader &r, QtCImage *img)
+{
+    int type = 0;
+    int pos = 0;
+    r.get(&type);
+    r.get(&img->onBorder);
+    r.get(&img->width);
+    r.get(&img->height);
+    r.get(&pos);
+    img->type = (EImageType)type;
+    img->pos = (EPixPos)pos;
+    img->loaded = false;
+    img->pixmap.img = QPixmap();
+    return readCacheStr(r, &img->pixmap.file);
+}
+
+static void
+saveConfigCache(const QtCurve::ConfCache::File &cache, const Options *opts)
+{
+    QtCurve::ConfCache::Writer w;
+    w.putRange(&opts->version, &opts->titlebarButtonColors);
+    w.putRange(&opts->titlebarIcon, &opts->customGradient);
+    w.put<uint32_t>(opts->titlebarButtonColors.size());
+    for (const auto &it: opts->titlebarButtonColors) {
+        w.put<int>(it.first);
+        w.putData(&it.second, sizeof(QColor));
+    }
+    w.put<uint32_t>(opts->customGradient.size());
+    for (const auto &it: opts->customGradient) {
+        w.put<int>(it.first);
+        w.put<int>(it.second.border);
+        w.put<uint32_t>(it.second.stops.size());
+        for (const auto &stop: it.second.stops) {
+            w.put(stop.pos);
+            w.put(stop.val);
+            w.put(stop.alpha);
+        }
+    }
+    writeCacheStr(w, opts->bgndPixmap.file);
+    writeCacheStr(w, opts->menuBgndPixmap.file);
+    writeCacheImage(w, opts->bgndImage);
+    writeCacheImage(w, opts->menuBgndImage);
+#define WRITE_STRINGS(ENTRY)                            \
+    w.put<uint32_t>(opts->ENTRY.size());                \
+    for (const QString &str: opts->ENTRY)               \
+        writeCacheStr(w, str);
+    CACHE_STRINGS(WRITE_STRINGS)
+#undef WRITE_STRINGS
+    w.put(opts->onlyTicksInMenu);
+    w.put(opts->buttonStyleMenuSections);
+    cache.save(w);
+}
+
+static bool
+loadConfigCache(QtCurve::ConfCache::File &cache, Options *opts)
+{
+    if (!cache.load())
+        return false;
+    QtCurve::ConfCache::Reader r(cache.reader());
+    // Read into a copy so that a bad snapshot leaves opts untouched.
+    Options res(*opts);
+    uint32_t num = 0;
+    r.getRange(&res.version, &res.titlebarButtonColors);
+    r.getRange(&res.titlebarIcon, &res.customGradient);
+    res.titlebarButtonColors.clear();
+    r.get(&num);
+    for (uint32_t i = 0;i < num && r.ok();i++) {
+        int key = 0;
+        QColor col;
+        r.get(&key);
+        r.getData(&col, sizeof(QColor));
+        res.titlebarButtonColors[key] = col;
+    }
+    res.customGradient.clear();
+    r.get(&num);
+    for (uint32_t i = 0;i < num && r.ok();i++) {
+        int app = 0;
+        int border = 0;
+        uint32_t numStops = 0;
+        r.get(&app);
+        r.get(&border);
+        r.get(&numStops);
+        Gradient &grad = res.customGradient[(EAppearance)app];
+        grad.border = (EGradientBorder)border;
+        for (uint32_t j = 0;j < numStops && r.ok();j++) {
+            double pos = 0;
+            double val = 0;
+            double alpha = 0;
+            r.get(&pos);
+            r.get(&val);
+            r.get(&alpha);
+            grad.stops.insert(GradientStop(pos, val, alpha));
+        }
+    }
+    readCacheStr(r, &res.bgndPixmap.file);
+    readCacheStr(r, &res.menuBgndPixmap.file);
+    readCacheImage(r, &res.bgndImage);
+    readCacheImage(r, &res.menuBgndImage);
+#define READ_STRINGS(ENTRY)                             \
+    res.ENTRY.clear();                                  \
+    r.get(&num);                                        \
+    for (uint32_t i = 0;i < num && r.ok();i++) {        \
+        QString str;                                    \
+        if (readCacheStr(r, &str)) {                    \
+            res.ENTRY << str;                           \
+        }                                               \
+    }
+    CACHE_STRINGS(READ_STRINGS)
+#undef READ_STRINGS
+    r.get(&res.onlyTicksInMenu);
+    r.get(&res.buttonStyleMenuSections);
+    if (!r.atEnd())
+        return false;
+    // Images referenced by the config are loaded as the parser would.
+    if (res.bgndAppearance == APPEARANCE_FILE &&
+        !res.bgndPixmap.img.load(res.bgndPixmap.file))
+        return false;
+    if (res.menuBgndAppearance == APPEARANCE_FILE &&
+        !res.menuBgndPixmap.img.load(res.menuBgndPixmap.file))
+        return false;
+    *opts = res;
+#ifdef QTC_ENABLE_X11
+    qtcX11SetShadowSize(opts->shadowSize);
+#endif
+    return true;
+}
+#undef CACHE_STRINGS
+#endif
+
+static const char * getSystemConfigFile();
+
 bool qtcReadConfig(const QString &file, Options *opts, Options *defOpts, bool checkImages)
 {
+    qtcTrace("qtcReadConfig");
     if (file.isEmpty()) {
         const char *env=getenv("QTCURVE_CONFIG_FILE");
 
@@ -1088,6 +1276,19 @@ bool qtcReadConfig(const QString &file, Options *opts, Options *defOpts, bool ch
             }
         }
     } else {
+#ifndef CONFIG_DIALOG
+        // Only the style reads with the default options, don't bother
+        // caching for the config dialog or the system config.
+        const QByteArray path(QFile::encodeName(file));
+        QtCurve::ConfCache::File cache(
+            !defOpts && checkImages ?
+            QtCurve::ConfCache::File::path(path.constData(), "qt5") :
+            std::string(), {path.constData(), getSystemConfigFile()},
+            cacheLayout(opts));
+        if (loadConfigCache(cache, opts)) {
+            return true;
+        }
+#endif
         QtCConfig cfg(file);
         if (cfg.ok()) {
             int i;
@@ -1431,6 +1632,9 @@ bool qtcReadConfig(const QString &file, Options *opts, Options *defOpts, bool ch
                 }
             }
             qtcCheckConfig(opts);
+#ifndef CONFIG_DIALOG
+            saveConfigCache(cache, opts);
+#endif
             return true;
         } else {
             if(defOpts)
@@ -64,38 +64,6 @@ namespace KWin {
 
 static const int constTitlePad = 4;
 
-int getMenubarSizeProperty(WId wId)
-{
-    return qtcX11GetShortProp(wId, qtc_x11_qtc_menubar_size);
-}
-
-int getStatusbarSizeProperty(WId wId)
-{
-    return qtcX11GetShortProp(wId, qtc_x11_qtc_statusbar);
-}
-
-int getOpacityProperty(WId wId)
-{
-    int o = qtcX11GetShortProp(wId, qtc_x11_qtc_opacity);
-    return o <= 0 || o >= 100 ? 100 : o;
-}
-
-void getBgndSettings(WId wId, EAppearance &app, QColor &col)
-{
-    auto reply = qtcX11GetProperty(0, wId, qtc_x11_qtc_bgnd,
-                                   XCB_ATOM_CARDINAL, 0, 1);
-    if (!reply) {
-        return;
-    }
-    if (qtcX11GetPropertyValueLength(reply) > 0) {
-        uint32_t val = *(int32_t*)qtcX11GetPropertyValue(reply);
-        app = (EAppearance)(val & 0xFF);
-        col.setRgb((val & 0xFF000000) >> 24, (val & 0x00FF0000) >> 16,
-                   (val & 0x0000FF00) >> 8);
-    }
-    free(reply);
-}
-
 static QPainterPath createPath(const QRectF &r, double radiusTop, double radiusBot)
 {
     QPainterPath path;
@@ -206,7 +174,13 @@ QtCurveClient::QtCurveClient(KDecorationBridge *bridge, QtCurveHandler *factory)
       m_titleFont(QFont()),
       m_menuBarSize(-1),
       m_toggleMenuBarButton(0L),
-      m_toggleStatusBarButton(0L)
+      m_toggleStatusBarButton(0L),
+      m_staleProps(PROP_ALL),
+      m_hasBgndProp(false),
+      m_bgndProp(0),
+      m_opacityProp(-1),
+      m_menubarSizeProp(-1),
+      m_statusbarProp(-1)
       // m_hover(false)
 {
     Handler()->addClient(this);
@@ -346,24 +320,198 @@ void QtCurveClient::activeChange()
 void QtCurveClient::captionChange()
 {
     m_caption=caption();
+    m_frameParts.clear();
+    widget()->update();
+}
+
+void QtCurveClient::iconChange()
+{
+    m_frameParts.clear();
+    widget()->update();
+    KCommonDecoration::iconChange();
+}
+
+QtCurveClient::FrameState
+QtCurveClient::frameState()
+{
+    FrameState state;
+    int windowBorder(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_WindowBorder, 0L, 0L));
+    bool preview(isPreview());
+    bool blend(!preview && Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_BlendMenuAndTitleBar, nullptr, nullptr));
+    bool menuColor(windowBorder&WINDOW_BORDER_USE_MENUBAR_COLOR_FOR_TITLEBAR);
+    EAppearance bgndAppearance=APPEARANCE_FLAT;
+
+    state.size=widget()->size();
+    state.active=isActive();
+    state.compositing=compositingActive();
+    state.maximized=isMaximized();
+    state.shade=isShade();
+    state.kwinOpacity=state.compositing ? Handler()->opacity(state.active) : 100;
+    state.opacity=state.kwinOpacity;
+    updateProperties();
+    if(!preview && state.compositing && 100==state.opacity)
+        state.opacity=m_opacityProp<=0 || m_opacityProp>=100 ? 100 : m_opacityProp;
+    state.windowCol=widget()->palette().color(QPalette::Window);
+    if(m_hasBgndProp)
+    {
+        bgndAppearance=(EAppearance)(m_bgndProp&0xFF);
+        state.windowCol.setRgb((m_bgndProp&0xFF000000)>>24, (m_bgndProp&0x00FF0000)>>16,
+                               (m_bgndProp&0x0000FF00)>>8);
+    }
+    state.bgndAppearance=bgndAppearance;
+
+    if(!preview && (blend||menuColor) && -1==m_menuBarSize)
+    {
+        QString wc(windowClass());
+        if(wc==QLatin1String("W Navigator Firefox browser") ||
+           wc==QLatin1String("W Navigator Firefox view-source") ||
+           wc==QLatin1String("W Mail Thunderbird 3pane") ||
+           wc==QLatin1String("W Mail Thunderbird addressbook") ||
+           wc==QLatin1String("W Mail Thunderbird messageWindow") ||
+           wc==QLatin1String("D Calendar Thunderbird EventDialog") ||
+           wc==QLatin1String("W Msgcompose Thunderbird Msgcompose") ||
+           wc==QLatin1String("D Msgcompose Thunderbird Msgcompose"))
+            m_menuBarSize=QFontMetrics(QApplication::font()).height()+8;
+
+        else if(
+#if 0 // Currently LibreOffice does not seem to pain menubar backgrounds for KDE - so disable check here...
+                wc.startsWith(QLatin1String("W VCLSalFrame libreoffice-")) ||
+                wc.startsWith(QLatin1String("W VCLSalFrame.DocumentWindow libreoffice-")) ||
+                //wc==QLatin1String("W soffice.bin Soffice.bin") ||
+#endif
+                wc.startsWith(QLatin1String("W VCLSalFrame.DocumentWindow OpenOffice.org")) ||
+                wc.startsWith(QLatin1String("W VCLSalFrame OpenOffice.org")) ||
+                wc==QLatin1String("W soffice.bin Soffice.bin"))
+            m_menuBarSize=QFontMetrics(QApplication::font()).height()+7;
+        else
+        {
+            if(m_menubarSizeProp>-1)
+                m_menuBarSize=m_menubarSizeProp;
+        }
+    }
+
+    state.menuBarSize=m_menuBarSize;
+    state.buttonsLeft=buttonsLeftWidth();
+    state.buttonsRight=buttonsRightWidth();
+    return state;
+}
+
+void QtCurveClient::updateProperties()
+{
+    if(!m_staleProps)
+        return;
+
+    // Everything that is out of date is read in a single round trip.
+    X11PropBatch batch;
+    WId          wId(windowId());
+    unsigned     bgnd(0),
+                 opacity(0),
+                 menubarSize(0),
+                 statusbar(0);
+
+    if(m_staleProps&PROP_BGND)
+        bgnd=batch.get(wId, qtc_x11_qtc_bgnd);
+    if(m_staleProps&PROP_OPACITY)
+        opacity=batch.get(wId, qtc_x11_qtc_opacity);
+    if(m_staleProps&PROP_MENUBAR_SIZE)
+        menubarSize=batch.get(wId, qtc_x11_qtc_menubar_size);
+    if(m_staleProps&PROP_STATUSBAR)
+        statusbar=batch.get(wId, qtc_x11_qtc_statusbar);
+
+    if(m_staleProps&PROP_BGND)
+        m_hasBgndProp=batch.value(bgnd, &m_bgndProp);
+    if(m_staleProps&PROP_OPACITY)
+        m_opacityProp=batch.shortValue(opacity);
+    if(m_staleProps&PROP_MENUBAR_SIZE)
+        m_menubarSizeProp=batch.shortValue(menubarSize);
+    if(m_staleProps&PROP_STATUSBAR)
+        m_statusbarProp=batch.shortValue(statusbar);
+    m_staleProps=0;
+}
+
+void QtCurveClient::propertyChanged(unsigned props)
+{
+    m_staleProps|=props;
     widget()->update();
 }
 
 void QtCurveClient::paintEvent(QPaintEvent *e)
 {
-    bool compositing = compositingActive();
-    QPainter painter(widget());
+    FrameState state(frameState());
+    QPainter   painter(widget());
+
+    painter.setClipRegion(e->region());
+    if(isPreview())
+        paintFrame(painter, state);
+    else
+    {
+        if(m_frameParts.isEmpty() || !(state==m_frameState))
+            updateFrameParts(state);
+        for(const FramePart &part: m_frameParts)
+            if(e->region().intersects(part.rect))
+                painter.drawPixmap(part.rect.topLeft(), part.pix);
+    }
+    painter.end();
+    updateToggleButtons(state);
+}
+
+void QtCurveClient::updateFrameParts(const FrameState &state)
+{
+    // Only the frame around the client window is ever visible, so (like KWin
+    // does for its own decoration pixmaps) only that is kept, as one pixmap
+    // per side.
+    const QRect r(widget()->rect());
+    const int   left(layoutMetric(LM_OuterPaddingLeft)+layoutMetric(LM_BorderLeft)),
+                right(layoutMetric(LM_OuterPaddingRight)+layoutMetric(LM_BorderRight)),
+                top(layoutMetric(LM_OuterPaddingTop)+layoutMetric(LM_TitleEdgeTop)+
+                    layoutMetric(LM_TitleHeight)+layoutMetric(LM_TitleEdgeBottom)),
+                bottom(layoutMetric(LM_OuterPaddingBottom)+layoutMetric(LM_BorderBottom)),
+                middle(r.height()-(top+bottom));
+    QVector<QRect> rects;
+
+    if(state.shade || middle<=0 || r.width()<=left+right)
+        rects << r;
+    else
+        rects << QRect(r.x(), r.y(), r.width(), top)
+              << QRect(r.x(), r.bottom()-bottom+1, r.width(), bottom)
+              << QRect(r.x(), r.y()+top, left, middle)
+              << QRect(r.right()-right+1, r.y()+top, right, middle);
+
+    m_frameState=state;
+    m_frameParts.clear();
+    for(const QRect &rect: rects)
+    {
+        if(rect.isEmpty())
+            continue;
+
+        FramePart part;
+        part.rect=rect;
+        part.pix=QPixmap(rect.size());
+        part.pix.fill(Qt::transparent);
+
+        QPainter painter(&part.pix);
+        painter.translate(-rect.topLeft());
+        painter.setClipRect(rect);
+        paintFrame(painter, state);
+        painter.end();
+        m_frameParts.append(part);
+    }
+}
+
+void QtCurveClient::paintFrame(QPainter &painter, const FrameState &state)
+{
+    bool compositing = state.compositing;
     QRect r(widget()->rect());
     QStyleOptionTitleBar opt;
     int windowBorder(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_WindowBorder, 0L, 0L));
-    bool active(isActive());
+    bool active(state.active);
     bool colorTitleOnly(windowBorder&WINDOW_BORDER_COLOR_TITLEBAR_ONLY);
     bool roundBottom(Handler()->roundBottom());
     bool preview(isPreview());
     bool blend(!preview && Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_BlendMenuAndTitleBar, nullptr, nullptr));
     bool menuColor(windowBorder&WINDOW_BORDER_USE_MENUBAR_COLOR_FOR_TITLEBAR);
     bool separator(active && windowBorder&WINDOW_BORDER_SEPARATOR);
-    bool maximized(isMaximized());
+    bool maximized(state.maximized);
     QtCurveConfig::Shade outerBorder(Handler()->outerBorder()),
                          innerBorder(Handler()->innerBorder());
     const int            border(Handler()->borderEdgeSize()),
@@ -376,12 +524,10 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
                          round=Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_Round, nullptr, nullptr),
                          buttonFlags=Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarButtons, nullptr, nullptr);
     int                  rectX, rectY, rectX2, rectY2, shadowSize(0),
-                         kwinOpacity(compositing ? Handler()->opacity(active) : 100),
-                         opacity(kwinOpacity);
-    EAppearance          bgndAppearance=APPEARANCE_FLAT;
-    QColor               windowCol(widget()->palette().color(QPalette::Window));
-
-    getBgndSettings(windowId(), bgndAppearance, windowCol);
+                         kwinOpacity(state.kwinOpacity),
+                         opacity(state.opacity);
+    EAppearance          bgndAppearance=state.bgndAppearance;
+    QColor               windowCol(state.windowCol);
 
     QColor               col(KDecoration::options()->color(KDecoration::ColorTitleBar, active)),
                          fillCol(colorTitleOnly ? windowCol : col);
@@ -390,11 +536,6 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
     bool customBgnd = bgndAppearance != APPEARANCE_FLAT;
     bool customShadows = Handler()->customShadows();
 
-    painter.setClipRegion(e->region());
-
-    if(!preview && compositing && 100==opacity)
-        opacity=getOpacityProperty(windowId());
-
     if (customShadows) {
         shadowSize = Handler()->shadowCache().shadowSize();
 
@@ -421,37 +562,6 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
 
     r.getCoords(&rectX, &rectY, &rectX2, &rectY2);
 
-    if(!preview && (blend||menuColor) && -1==m_menuBarSize)
-    {
-        QString wc(windowClass());
-        if(wc==QLatin1String("W Navigator Firefox browser") ||
-           wc==QLatin1String("W Navigator Firefox view-source") ||
-           wc==QLatin1String("W Mail Thunderbird 3pane") ||
-           wc==QLatin1String("W Mail Thunderbird addressbook") ||
-           wc==QLatin1String("W Mail Thunderbird messageWindow") ||
-           wc==QLatin1String("D Calendar Thunderbird EventDialog") ||
-           wc==QLatin1String("W Msgcompose Thunderbird Msgcompose") ||
-           wc==QLatin1String("D Msgcompose Thunderbird Msgcompose"))
-            m_menuBarSize=QFontMetrics(QApplication::font()).height()+8;
-
-        else if(
-#if 0 // Currently LibreOffice does not seem to pain menubar backgrounds for KDE - so disable check here...
-                wc.startsWith(QLatin1String("W VCLSalFrame libreoffice-")) ||
-                wc.startsWith(QLatin1String("W VCLSalFrame.DocumentWindow libreoffice-")) ||
-                //wc==QLatin1String("W soffice.bin Soffice.bin") ||
-#endif
-                wc.startsWith(QLatin1String("W VCLSalFrame.DocumentWindow OpenOffice.org")) ||
-                wc.startsWith(QLatin1String("W VCLSalFrame OpenOffice.org")) ||
-                wc==QLatin1String("W soffice.bin Soffice.bin"))
-            m_menuBarSize=QFontMetrics(QApplication::font()).height()+7;
-        else
-        {
-            int val=getMenubarSizeProperty(windowId());
-            if(val>-1)
-                m_menuBarSize=val;
-        }
-    }
-
     if(menuColor && m_menuBarSize>0 &&
        (active || !Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ShadeMenubarOnlyWhenActive, nullptr, nullptr)))
         col=QColor(QRgb(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_MenubarColor, nullptr, nullptr)));
@@ -673,14 +783,43 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
                                               m_captionRect.height()),
                m_caption, showIcon ? icon().pixmap(iconSize) : QPixmap(), shadowSize);
 
+    if(separator)
+    {
+        QColor        color(KDecoration::options()->color(KDecoration::ColorFont, isActive()));
+        Qt::Alignment align((Qt::Alignment)Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleAlignment, 0L, 0L));
+
+        r.adjust(16, titleBarHeight-1, -16, 0);
+        color.setAlphaF(0.5);
+        drawFadedLine(&painter, r, color, true, align&(Qt::AlignHCenter|Qt::AlignRight), align&(Qt::AlignHCenter|Qt::AlignLeft));
+    }
+}
+
+void QtCurveClient::updateToggleButtons(const FrameState &state)
+{
+    QRect     r(widget()->rect());
+    bool      active(state.active),
+              maximized(state.maximized);
+    const int border(Handler()->borderEdgeSize()),
+              titleBarHeight(layoutMetric(LM_TitleHeight)+layoutMetric(LM_TitleEdgeTop)+
+                             layoutMetric(LM_TitleEdgeBottom)+(maximized ? border : 0));
+    QtCurveConfig::Shade outerBorder(Handler()->outerBorder());
+
+    if(Handler()->customShadows())
+    {
+        int shadowSize(Handler()->shadowCache().shadowSize());
+        r.adjust(shadowSize, shadowSize, -shadowSize, -shadowSize);
+    }
+    if(maximized)
+        r.adjust(-3, -border, 3, 0);
+
     bool hideToggleButtons(true);
     int  toggleButtons(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ToggleButtons, nullptr, nullptr));
 
     if(toggleButtons)
     {
-        if(!m_toggleMenuBarButton && toggleButtons&0x01 && (Handler()->wasLastMenu(windowId()) || getMenubarSizeProperty(windowId())>-1))
+        if(!m_toggleMenuBarButton && toggleButtons&0x01 && (Handler()->wasLastMenu(windowId()) || m_menubarSizeProp>-1))
             m_toggleMenuBarButton=createToggleButton(true);
-        if(!m_toggleStatusBarButton && toggleButtons&0x02 && (Handler()->wasLastStatus(windowId()) || getStatusbarSizeProperty(windowId())>-1))
+        if(!m_toggleStatusBarButton && toggleButtons&0x02 && (Handler()->wasLastStatus(windowId()) || m_statusbarProp>-1))
             m_toggleStatusBarButton=createToggleButton(false);
 
         // if (m_hover)
@@ -735,18 +874,6 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
         if(m_toggleStatusBarButton)
             m_toggleStatusBarButton->hide();
     }
-
-    if(separator)
-    {
-        QColor        color(KDecoration::options()->color(KDecoration::ColorFont, isActive()));
-        Qt::Alignment align((Qt::Alignment)Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleAlignment, 0L, 0L));
-
-        r.adjust(16, titleBarHeight-1, -16, 0);
-        color.setAlphaF(0.5);
-        drawFadedLine(&painter, r, color, true, align&(Qt::AlignHCenter|Qt::AlignRight), align&(Qt::AlignHCenter|Qt::AlignLeft));
-    }
-
-    painter.end();
 }
 
 void
@@ -1038,6 +1165,7 @@ bool QtCurveClient::eventFilter(QObject *o, QEvent *e)
 {
     if (e->type() == QEvent::StyleChange) {
         Handler()->setStyle();
+        m_frameParts.clear();
     }
 
     // if (widget() == o) {
@@ -1061,6 +1189,7 @@ bool QtCurveClient::eventFilter(QObject *o, QEvent *e)
 
 void QtCurveClient::reset(unsigned long changed)
 {
+    m_frameParts.clear();
     if (changed & (SettingColors | SettingFont | SettingBorder)) {
         // Reset button backgrounds...
         for(int i=0; i<constNumButtonStates; ++i)
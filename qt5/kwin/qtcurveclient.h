@@ -37,6 +37,7 @@
 #include <kcommondecoration.h>
 #include <QPixmap>
 #include <QColor>
+#include <QVector>
 #include "qtcurvehandler.h"
 
 namespace QtCurve {
@@ -49,6 +50,15 @@ class QtCurveToggleButton;
 class QtCurveClient : public KCommonDecorationUnstable {
     Q_OBJECT
 public:
+    // The QtCurve properties of the client window that are cached.
+    enum {
+        PROP_BGND = 1 << 0,
+        PROP_OPACITY = 1 << 1,
+        PROP_MENUBAR_SIZE = 1 << 2,
+        PROP_STATUSBAR = 1 << 3,
+        PROP_ALL = (1 << 4) - 1
+    };
+
     QtCurveClient(KDecorationBridge *bridge, QtCurveHandler *factory);
     ~QtCurveClient() override;
 
@@ -62,6 +72,7 @@ public:
     void shadeChange();
     void activeChange();
     void captionChange();
+    void iconChange();
     void reset(unsigned long changed);
     void paintEvent(QPaintEvent *e);
     void paintTitle(QPainter *painter, const QRect &capRect,
@@ -82,11 +93,57 @@ public:
     QtCurveToggleButton *createToggleButton(bool menubar);
     void informAppOfBorderSizeChanges();
     void sendToggleToApp(bool menubar);
+    /**
+     * Called by the handler when the properties in \param props have been
+     * changed on the client window.
+     */
+    void propertyChanged(unsigned props);
 public Q_SLOTS:
     void toggleMenuBar();
     void toggleStatusBar();
 
 private:
+    // The state the painted frame depends on besides the configuration, the
+    // caption and the icon (which drop the cached frame when they change).
+    struct FrameState {
+        QSize size;
+        bool active;
+        bool compositing;
+        bool maximized;
+        bool shade;
+        int kwinOpacity;
+        int opacity;
+        int bgndAppearance;
+        QColor windowCol;
+        int menuBarSize;
+        int buttonsLeft;
+        int buttonsRight;
+
+        bool
+        operator==(const FrameState &o) const
+        {
+            return (size == o.size && active == o.active &&
+                    compositing == o.compositing &&
+                    maximized == o.maximized && shade == o.shade &&
+                    kwinOpacity == o.kwinOpacity && opacity == o.opacity &&
+                    bgndAppearance == o.bgndAppearance &&
+                    windowCol == o.windowCol &&
+                    menuBarSize == o.menuBarSize &&
+                    buttonsLeft == o.buttonsLeft &&
+                    buttonsRight == o.buttonsRight);
+        }
+    };
+
+    struct FramePart {
+        QRect rect;
+        QPixmap pix;
+    };
+
+    void updateProperties();
+    FrameState frameState();
+    void paintFrame(QPainter &painter, const FrameState &state);
+    void updateFrameParts(const FrameState &state);
+    void updateToggleButtons(const FrameState &state);
     bool onlyMenuIcon(bool left) const;
     QRect captionRect() const;
     void createSizeGrip();
@@ -111,6 +168,17 @@ private:
     int m_menuBarSize;
     QtCurveToggleButton *m_toggleMenuBarButton;
     QtCurveToggleButton *m_toggleStatusBarButton;
+    // The frame painted for m_frameState, empty when it has to be repainted.
+    FrameState m_frameState;
+    QVector<FramePart> m_frameParts;
+    // Values of the properties of the client window, those in m_staleProps
+    // have to be read again before they are used.
+    unsigned m_staleProps;
+    bool m_hasBgndProp;
+    uint32_t m_bgndProp;
+    int m_opacityProp;
+    int m_menubarSizeProp;
+    int m_statusbarProp;
     // bool m_hover;
 };
 
@@ -99,10 +99,12 @@ QtCurveHandler::QtCurveHandler() :
 
     m_dBus = new QtCurveDBus(this);
     QDBusConnection::sessionBus().registerObject("/QtCurve", this);
+    qApp->installNativeEventFilter(this);
 }
 
 QtCurveHandler::~QtCurveHandler()
 {
+    qApp->removeNativeEventFilter(this);
     handler = 0;
     delete m_style;
 }
@@ -448,6 +450,39 @@ QtCurveHandler::borderEdgeSize() const
     }
 }
 
+// KWin selects PropertyChangeMask on every managed window, watch for the
+// properties set by QtCurve so that the clients don't have to read them on
+// every paint.
+bool
+QtCurveHandler::nativeEventFilter(const QByteArray &type, void *message, long*)
+{
+    if (type != "xcb_generic_event_t") {
+        return false;
+    }
+    auto event = (const xcb_generic_event_t*)message;
+    if ((event->response_type & ~0x80) != XCB_PROPERTY_NOTIFY) {
+        return false;
+    }
+    auto notify = (const xcb_property_notify_event_t*)event;
+    unsigned prop = (notify->atom == qtc_x11_qtc_bgnd ?
+                     QtCurveClient::PROP_BGND :
+                     notify->atom == qtc_x11_qtc_opacity ?
+                     QtCurveClient::PROP_OPACITY :
+                     notify->atom == qtc_x11_qtc_menubar_size ?
+                     QtCurveClient::PROP_MENUBAR_SIZE :
+                     notify->atom == qtc_x11_qtc_statusbar ?
+                     QtCurveClient::PROP_STATUSBAR : 0);
+    if (prop) {
+        foreach (QtCurveClient *client, m_clients) {
+            if (client->windowId() == notify->window) {
+                client->propertyChanged(prop);
+                break;
+            }
+        }
+    }
+    return false;
+}
+
 void QtCurveHandler::removeClient(QtCurveClient *c)
 {
     if(c->windowId()==m_lastMenuXid)
@@ -33,6 +33,7 @@
 #include <QFont>
 #include <QApplication>
 #include <QBitmap>
+#include <QAbstractNativeEventFilter>
 #include <kdeversion.h>
 #include <kdecoration.h>
 #include <kdecorationfactory.h>
@@ -75,11 +76,14 @@ class QtCurveDBus;
 #define _KDecorationFactoryBase KDecorationFactory
 #endif
 
-class QtCurveHandler : public QObject, public _KDecorationFactoryBase {
+class QtCurveHandler : public QObject, public _KDecorationFactoryBase,
+                       public QAbstractNativeEventFilter {
     Q_OBJECT
 public:
     QtCurveHandler();
     ~QtCurveHandler();
+    bool nativeEventFilter(const QByteArray &type, void *message,
+                           long *result) override;
     void setStyle();
     bool reset(unsigned long changed) override;
     void setBorderSize();
@@ -95,6 +95,15 @@ static QColor calcLightColor(const QColor &color)
 QtCurveShadowCache::QtCurveShadowCache()
                   : m_activeShadowConfig(ShadowConfig(QPalette::Active))
                   , m_inactiveShadowConfig(ShadowConfig(QPalette::Inactive))
+                  , m_tileSetBytes(0)
+                  , m_statsReg("kwin shadows", [this] (CacheReport *report) {
+                          report->hits = m_stats.hits;
+                          report->misses = m_stats.misses;
+                          report->evictions = m_stats.evictions;
+                          report->entries = m_shadowCache.count();
+                          report->bytes = (m_shadowCache.count() *
+                                           m_tileSetBytes);
+                      })
 {
     m_shadowCache.setMaxCost(1<<6);
 }
@@ -120,12 +129,21 @@ QtCurveShadowCache::tileSet(const QtCurveClient *client, bool roundAllCorners)
     Key key(client);
     int hash(key.hash());
 
-    if (m_shadowCache.contains(hash))
-        return m_shadowCache.object(hash);
+    if (TileSet *cached = m_shadowCache.object(hash)) {
+        m_stats.hits++;
+        return cached;
+    }
+    m_stats.misses++;
 
     qreal   size(shadowSize());
-    TileSet *tileSet = new TileSet(shadowPixmap(client, key.active, roundAllCorners), size, size, 1, 1);
-
+    QPixmap pix(shadowPixmap(client, key.active, roundAllCorners));
+    TileSet *tileSet = new TileSet(pix, size, size, 1, 1);
+
+    // All shadows have the same size, which only changes along with the
+    // config (and then the cache is reset).
+    m_tileSetBytes = pix.width() * pix.height() * (pix.depth() / 8);
+    if (m_shadowCache.totalCost() >= m_shadowCache.maxCost())
+        m_stats.evictions++;
     m_shadowCache.insert(hash, tileSet);
     return tileSet;
 }
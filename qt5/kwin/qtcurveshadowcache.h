@@ -54,6 +54,7 @@
 #include "qtcurveshadowconfiguration.h"
 #include "tileset.h"
 
+#include <qtcurve-utils/cachestats.h>
 #include <qtcurve-utils/number.h>
 
 #include <QCache>
@@ -184,6 +185,9 @@ private:
     ShadowConfig m_activeShadowConfig;
     ShadowConfig m_inactiveShadowConfig;
     TileSetCache m_shadowCache;
+    CacheStats m_stats;
+    size_t m_tileSetBytes;
+    CacheRegistration m_statsReg;
 };
 
 }
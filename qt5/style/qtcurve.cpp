@@ -24,6 +24,7 @@
 #include "qtcurve_plugin.h"
 #include "qtcurve_fonthelper.h"
 #include <qtcurve-utils/qtprops.h>
+#include <qtcurve-utils/ramp.h>
 
 #include <qglobal.h>
 #include <QDBusConnection>
@@ -67,13 +68,13 @@
 #include <QSpinBox>
 #include <QDir>
 #include <QSettings>
-#include <QPixmapCache>
 #include <QTextStream>
 #include <QtDebug>
 
 #include "shadowhelper.h"
 #include <qtcurve-utils/x11qtc.h>
 #include <sys/time.h>
+#include <algorithm>
 
 #ifdef QTC_QT5_ENABLE_KDE
 // KDE4 support headers
@@ -300,6 +301,10 @@ createKey(qulonglong size, const QColor &color, bool horiz, int app, EWidget w)
         (((qulonglong)(type&0x03))<<55);
 }
 
+static const size_t constPixmapsBudget = 10 * 1024 * 1024;
+// A rounded outline is ~20 elements, this holds a few thousand of them.
+static const size_t constPathsBudget = 1024 * 1024;
+
 static QtcKey createKey(const QColor &color, EPixmap p)
 {
     return 1 +
@@ -361,6 +366,17 @@ Style::Style() :
     m_activeMdiColors(0L),
     m_mdiColors(0L),
     m_pixmapCache(150000),
+    m_pixmaps(constPixmapsBudget),
+    m_paths(constPathsBudget),
+    m_pixmapCacheReg("qt5 style pixmapCache", [this] (CacheReport *report) {
+            reportPixmapCache(report);
+        }),
+    m_pixmapsReg("qt5 style pixmaps", [this] (CacheReport *report) {
+            reportCache(m_pixmaps, report);
+        }),
+    m_pathsReg("qt5 style paths", [this] (CacheReport *report) {
+            reportCache(m_paths, report);
+        }),
     m_active(true),
     m_sbWidget(0L),
     m_clickedLabel(0L),
@@ -374,14 +390,15 @@ Style::Style() :
     m_shortcutHandler(new ShortcutHandler(this))
 {
     const char *env = getenv(QTCURVE_PREVIEW_CONFIG);
+    clearMetrics();
 #ifdef QTC_QT5_ENABLE_KDE
     m_configFile = KSharedConfig::openConfig();
     m_kdeGlobals = KSharedConfig::openConfig(QStringLiteral("kdeglobals"), KConfig::NoGlobals);
 #endif
     if (env && strcmp(env, QTCURVE_PREVIEW_CONFIG) == 0) {
         // To enable preview of QtCurve settings, the style config module will set QTCURVE_PREVIEW_CONFIG
-        // and use CE_QtC_SetOptions to set options. If this is set, we do not use the QPixmapCache as it
-        // will interfere with that of the kcm's widgets!
+        // and use CE_QtC_SetOptions to set options. If this is set, we do not cache the pixmaps drawn as
+        // they would not match the options being previewed!
         m_isPreview=PREVIEW_MDI;
         m_usePixmapCache=false;
     } else if(env && strcmp(env, QTCURVE_PREVIEW_CONFIG_FULL) == 0) {
@@ -395,8 +412,11 @@ Style::Style() :
 
 void Style::init(bool initial)
 {
-    if(!initial)
+    if(!initial) {
         freeColors();
+        qtcClearShadeColorsCache();
+        Ramp::clear();
+    }
 
     if (m_isPreview) {
         if (m_isPreview != PREVIEW_WINDOW) {
@@ -700,6 +720,144 @@ void Style::init(bool initial)
         setDecorationColors();
     }
 #endif
+    initMetrics();
+}
+
+// The metrics and hints that neither look at the option nor the widget.
+// Only options that are not changed after init() and polish(QApplication*)
+// may be used by them, e.g. not QtC_ShadeMenubarOnlyWhenActive, which
+// getMdiColors() may clear later.
+static const QStyle::PixelMetric constStaticMetrics[] = {
+    QStyle::PM_MdiSubWindowFrameWidth,
+    QStyle::PM_DockWidgetTitleMargin,
+    QStyle::PM_DockWidgetTitleBarButtonMargin,
+    QStyle::PM_DockWidgetFrameWidth,
+    QStyle::PM_ToolBarExtensionExtent,
+#ifndef QTC_QT5_ENABLE_KDE
+    // The KDE icon sizes follow the icon loader.
+    QStyle::PM_SmallIconSize,
+    QStyle::PM_ToolBarIconSize,
+    QStyle::PM_IconViewIconSize,
+    QStyle::PM_LargeIconSize,
+#endif
+    QStyle::PM_SubMenuOverlap,
+    QStyle::PM_ScrollView_ScrollBarSpacing,
+    QStyle::PM_SizeGripSize,
+    QStyle::PM_TabBarScrollButtonWidth,
+    QStyle::PM_HeaderMargin,
+    QStyle::PM_DefaultTopLevelMargin,
+    QStyle::PM_LayoutHorizontalSpacing,
+    QStyle::PM_LayoutVerticalSpacing,
+    QStyle::PM_DefaultLayoutSpacing,
+    QStyle::PM_MenuBarItemSpacing,
+    QStyle::PM_ToolBarItemMargin,
+    QStyle::PM_ToolBarItemSpacing,
+    QStyle::PM_ToolBarFrameWidth,
+    QStyle::PM_FocusFrameVMargin,
+    QStyle::PM_FocusFrameHMargin,
+    QStyle::PM_MenuHMargin,
+    QStyle::PM_MenuVMargin,
+    QStyle::PM_ButtonMargin,
+    QStyle::PM_TabBarTabShiftVertical,
+    QStyle::PM_TabBarTabShiftHorizontal,
+    QStyle::PM_ButtonDefaultIndicator,
+    QStyle::PM_SpinBoxFrameWidth,
+    QStyle::PM_IndicatorWidth,
+    QStyle::PM_IndicatorHeight,
+    QStyle::PM_ExclusiveIndicatorWidth,
+    QStyle::PM_ExclusiveIndicatorHeight,
+    QStyle::PM_TabBarTabOverlap,
+    QStyle::PM_ProgressBarChunkWidth,
+    QStyle::PM_DockWidgetSeparatorExtent,
+    QStyle::PM_SplitterWidth,
+    QStyle::PM_ToolBarHandleExtent,
+    QStyle::PM_ScrollBarSliderMin,
+    QStyle::PM_SliderThickness,
+    QStyle::PM_SliderControlThickness,
+    QStyle::PM_SliderTickmarkOffset,
+    QStyle::PM_SliderLength,
+    QStyle::PM_ScrollBarExtent,
+    QStyle::PM_MaximumDragDistance,
+    QStyle::PM_TabBarTabHSpace,
+    QStyle::PM_TabBarTabVSpace,
+    QStyle::PM_MenuBarPanelWidth,
+    (QStyle::PixelMetric)QtC_Round,
+    (QStyle::PixelMetric)QtC_TitleAlignment,
+    (QStyle::PixelMetric)QtC_TitleBarButtons,
+    (QStyle::PixelMetric)QtC_TitleBarIcon,
+    (QStyle::PixelMetric)QtC_TitleBarEffect,
+    (QStyle::PixelMetric)QtC_BlendMenuAndTitleBar,
+    (QStyle::PixelMetric)QtC_ToggleButtons,
+    (QStyle::PixelMetric)QtC_WindowBorder,
+    (QStyle::PixelMetric)QtC_CustomBgnd
+};
+
+static const QStyle::StyleHint constStaticHints[] = {
+    QStyle::SH_ComboBox_ListMouseTracking,
+    QStyle::SH_PrintDialog_RightAlignButtons,
+    QStyle::SH_ItemView_ArrowKeysNavigateIntoChildren,
+    QStyle::SH_ToolBox_SelectedPageTitleBold,
+    QStyle::SH_ScrollBar_MiddleClickAbsolutePosition,
+    QStyle::SH_SpinControls_DisableOnBounds,
+    QStyle::SH_Slider_SnapToValue,
+    QStyle::SH_FontDialog_SelectAssociatedText,
+    QStyle::SH_Menu_MouseTracking,
+    QStyle::SH_MessageBox_CenterButtons,
+    QStyle::SH_ProgressDialog_CenterCancelButton,
+    QStyle::SH_DitherDisabledText,
+    QStyle::SH_EtchDisabledText,
+    QStyle::SH_Menu_AllowActiveAndDisabled,
+    QStyle::SH_ItemView_ShowDecorationSelected,
+    QStyle::SH_MenuBar_AltKeyNavigation,
+    QStyle::SH_ItemView_ChangeHighlightOnFocus,
+    QStyle::SH_WizardStyle,
+    QStyle::SH_Menu_SubMenuPopupDelay,
+#if QT_VERSION >= QT_VERSION_CHECK(5,5,0)
+    QStyle::SH_Menu_SloppySubMenus,
+    QStyle::SH_Menu_SubMenuSloppyCloseTimeout,
+#endif
+    QStyle::SH_ToolButton_PopupDelay,
+    QStyle::SH_ComboBox_PopupFrameStyle,
+    QStyle::SH_TabBar_Alignment,
+    QStyle::SH_Header_ArrowAlignment,
+    QStyle::SH_TitleBar_NoBorder,
+    QStyle::SH_TitleBar_AutoRaise,
+    QStyle::SH_MainWindow_SpaceBelowMenuBar,
+    QStyle::SH_DialogButtonLayout,
+    QStyle::SH_MessageBox_TextInteractionFlags,
+    QStyle::SH_MenuBar_MouseTracking,
+    QStyle::SH_FormLayoutFormAlignment,
+    QStyle::SH_FormLayoutLabelAlignment,
+    QStyle::SH_FormLayoutFieldGrowthPolicy,
+    QStyle::SH_FormLayoutWrapPolicy,
+    QStyle::SH_Widget_Animate,
+    QStyle::SH_Menu_SupportsSections
+};
+
+void
+Style::clearMetrics()
+{
+    std::fill(std::begin(m_metrics), std::end(m_metrics), constUnknownMetric);
+    std::fill(std::begin(m_hints), std::end(m_hints), constUnknownMetric);
+}
+
+void
+Style::initMetrics()
+{
+    // The values are computed by the switches, which must not see the ones
+    // of the previous options.
+    clearMetrics();
+    for (auto metric: constStaticMetrics) {
+        int index = metricIndex(metric);
+        if (index >= 0) {
+            m_metrics[index] = pixelMetric(metric, nullptr, nullptr);
+        }
+    }
+    for (auto hint: constStaticHints) {
+        if ((unsigned)hint < constNumHints) {
+            m_hints[hint] = styleHint(hint, nullptr, nullptr, nullptr);
+        }
+    }
 }
 
 void Style::connectDBus()
@@ -1396,7 +1554,7 @@ void Style::drawProgressBevelGradient(QPainter *p, const QRect &origRect, const
     QRect   r(0, 0, horiz ? PROGRESS_CHUNK_WIDTH*2 : origRect.width(),
               horiz ? origRect.height() : PROGRESS_CHUNK_WIDTH*2);
     QtcKey  key(createKey(horiz ? r.height() : r.width(), cols[ORIGINAL_SHADE], horiz, bevApp, WIDGET_PROGRESSBAR));
-    QPixmap *pix(m_pixmapCache.object(key));
+    QPixmap *pix(cachedPixmap(key));
 
     if(!pix)
     {
@@ -1461,7 +1619,7 @@ void Style::drawProgressBevelGradient(QPainter *p, const QRect &origRect, const
         int cost(pix->width()*pix->height()*(pix->depth()/8));
 
         if(cost<m_pixmapCache.maxCost())
-            m_pixmapCache.insert(key, pix, cost);
+            cachePixmap(key, pix, cost);
         else
             inCache=false;
     }
@@ -1532,7 +1690,7 @@ Style::drawBevelGradient(const QColor &base, QPainter *p, const QRect &origRect,
                     horiz ? origRect.height() : PIXMAP_DIMENSION);
             QtcKey key(createKey(horiz ? r.height() : r.width(),
                                  base, horiz, app, w));
-            QPixmap *pix(m_pixmapCache.object(key));
+            QPixmap *pix(cachedPixmap(key));
             bool inCache(true);
 
             if (!pix) {
@@ -1547,7 +1705,7 @@ Style::drawBevelGradient(const QColor &base, QPainter *p, const QRect &origRect,
                 int cost(pix->width()*pix->height()*(pix->depth()/8));
 
                 if (cost < m_pixmapCache.maxCost()) {
-                    m_pixmapCache.insert(key, pix, cost);
+                    cachePixmap(key, pix, cost);
                 } else {
                     inCache = false;
                 }
@@ -1583,31 +1741,32 @@ Style::drawBevelGradientReal(const QColor &base, QPainter *p, const QRect &r,
     bool reverse = QApplication::layoutDirection() == Qt::RightToLeft;
     const Gradient *grad = qtcGetGradient(app, &opts);
     QLinearGradient g(r.topLeft(), horiz ? r.bottomLeft() : r.topRight());
-    GradientStopCont::const_iterator it(grad->stops.begin());
-    GradientStopCont::const_iterator end(grad->stops.end());
-    int numStops(grad->stops.size());
-
-    for (int i = 0;it != end;++it, ++i) {
-        QColor col;
-
-        if ((topTab || botTab || dwt || titleBar) && i == numStops-1) {
+    bool blendEnd = topTab || botTab || dwt || titleBar;
+    int flags = ((botTab ? Ramp::Reverse : 0) |
+                 (botTab && opts.invertBotTab ? Ramp::Invert : 0) |
+                 (blendEnd ? Ramp::BaseEnd : 0) |
+                 (w == WIDGET_TOOLTIP ? Ramp::Opaque : 0));
+    const QtcColor qtcBase = {base.redF(), base.greenF(), base.blueF()};
+    RampStops stops(Ramp(qtcBase, opts.shading, flags)
+                    .addAll(grad->stops).stops());
+
+    for (size_t i = 0;i < stops->size();i++) {
+        const RampStop &stop = (*stops)[i];
+        QColor col(QColor::fromRgbF(stop.color.red, stop.color.green,
+                                    stop.color.blue, base.alphaF()));
+
+        if (blendEnd && i == stops->size() - 1) {
             if (titleBar) {
                 col = m_backgroundCols[ORIGINAL_SHADE];
                 col.setAlphaF(0.0);
-            } else {
-                col = base;
-                if ((sel && opts.tabBgnd == 0 && !reverse) || dwt) {
-                    col.setAlphaF(0.0);
-                }
+            } else if ((sel && opts.tabBgnd == 0 && !reverse) || dwt) {
+                col.setAlphaF(0.0);
             }
-        } else {
-            shade(base, &col, botTab && opts.invertBotTab ?
-                  qMax(INVERT_SHADE((*it).val), 0.9) : (*it).val);
         }
-        if (w != WIDGET_TOOLTIP && (*it).alpha < 1.0) {
-            col.setAlphaF(col.alphaF() * (*it).alpha);
+        if (stop.alpha < 1.0) {
+            col.setAlphaF(col.alphaF() * stop.alpha);
         }
-        g.setColorAt(botTab ? 1.0 - (*it).pos : (*it).pos, col);
+        g.setColorAt(stop.pos, col);
     }
 
     if (app == APPEARANCE_AGUA && !(topTab || botTab || dwt) &&
@@ -1704,11 +1863,11 @@ Style::drawLightBevel(QPainter *p, const QRect &r, const QStyleOption *option,
 
         int size = 2 * endSize + middleSize;
 
-        if (size > constMaxCachePixmap) {
+        if (size > constMaxCachePixmap || r.width() > 0xffff ||
+            r.height() > 0xffff) {
             drawLightBevelReal(p, r, option, widget, round, fill, custom,
                                doBorder, w, true, realRound, onToolbar);
         } else {
-            QString key;
             bool small(circular || (horiz ? r.width() : r.height())<(2*endSize));
             QPixmap pix;
             const QSize pixSize(small ? QSize(r.width(), r.height()) :
@@ -1717,10 +1876,17 @@ Style::drawLightBevel(QPainter *p, const QRect &r, const QStyleOption *option,
             uint state(option->state&(State_Raised|State_Sunken|State_On|State_Horizontal|State_HasFocus|State_MouseOver|
                                          (WIDGET_MDI_WINDOW_BUTTON==w ? State_Active : State_None)));
 
-            key.sprintf("qtc-%x-%x-%x-%x-%x-%x-%x-%x-%x", w, onToolbar ? 1 : 0,
-                        round, (int)realRound, pixSize.width(), pixSize.height(),
-                        state, fill.rgba(), (int)(radius * 100));
-            if (!m_usePixmapCache || !QPixmapCache::find(key, pix)) {
+            // state only has bits up to State_Active (0x10000) set.
+            PixmapKey key(PIX_BEVEL,
+                          (quint64(w & 0xff) << 52) |
+                          (quint64(onToolbar ? 1 : 0) << 51) |
+                          (quint64(realRound & 0x7) << 48) |
+                          (quint64(round & 0xffff) << 32) |
+                          (quint64(pixSize.width()) << 16) | pixSize.height(),
+                          (quint64(fill.rgba()) << 32) |
+                          (quint64(state & 0x1ffff) << 15) |
+                          (int(radius * 100) & 0x7fff));
+            if (!findPixmap(key, pix)) {
                 pix = QPixmap(pixSize);
                 pix.fill(Qt::transparent);
 
@@ -1734,10 +1900,7 @@ Style::drawLightBevel(QPainter *p, const QRect &r, const QStyleOption *option,
                                    false, realRound, onToolbar);
                 opts.round = oldRound;
                 pixPainter.end();
-
-                if (m_usePixmapCache) {
-                    QPixmapCache::insert(key, pix);
-                }
+                insertPixmap(key, pix);
             }
 
             if (small) {
@@ -2133,17 +2296,49 @@ void Style::drawBgndRing(QPainter &painter, int x, int y, int size, int size2, b
     }
 }
 
+bool
+Style::findPixmap(const PixmapKey &key, QPixmap &pix) const
+{
+    if (!m_usePixmapCache) {
+        return false;
+    }
+    if (const QPixmap *cached = m_pixmaps.find(key)) {
+        pix = *cached;
+        return true;
+    }
+    return false;
+}
+
+void
+Style::insertPixmap(const PixmapKey &key, const QPixmap &pix) const
+{
+    if (m_usePixmapCache) {
+        m_pixmaps.insert(key, QPixmap(pix),
+                         pix.width() * pix.height() * (pix.depth() / 8));
+    }
+}
+
+void
+Style::reportPixmapCache(CacheReport *report) const
+{
+    // The cost of most entries is their size in bytes.
+    report->hits = m_pixmapCacheStats.hits;
+    report->misses = m_pixmapCacheStats.misses;
+    report->evictions = m_pixmapCacheStats.evictions;
+    report->entries = m_pixmapCache.count();
+    report->bytes = m_pixmapCache.totalCost();
+}
+
 QPixmap Style::drawStripes(const QColor &color, int opacity) const
 {
     QPixmap pix;
-    QString key;
     QColor  col(color);
 
     if(100!=opacity)
         col.setAlphaF(opacity/100.0);
 
-    key.sprintf("qtc-stripes-%x", col.rgba());
-    if(!m_usePixmapCache || !QPixmapCache::find(key, pix))
+    PixmapKey key(PIX_STRIPES, 0, col.rgba());
+    if(!findPixmap(key, pix))
     {
         pix=QPixmap(QSize(64, 64));
 
@@ -2175,9 +2370,8 @@ QPixmap Style::drawStripes(const QColor &color, int opacity) const
         pixPainter.setPen(QPen(col2, QPENWIDTH1));
         for(int i=2; i<pix.height()-1; i+=4)
             pixPainter.drawLine(0, i, pix.width()-1, i);
-
-        if(m_usePixmapCache)
-            QPixmapCache::insert(key, pix);
+        pixPainter.end();
+        insertPixmap(key, pix);
     }
 
     return pix;
@@ -2204,7 +2398,6 @@ Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r,
         } else if (app == APPEARANCE_FILE) {
             pix = isWindow ? opts.bgndPixmap.img : opts.menuBgndPixmap.img;
         } else {
-            QString key;
             scaledSize = QSize(grad == GT_HORIZ ? constPixmapWidth : r.width(),
                                grad == GT_HORIZ ? r.height() :
                                constPixmapWidth);
@@ -2212,8 +2405,9 @@ Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r,
             if (opacity != 100)
                 col.setAlphaF(opacity / 100.0);
 
-            key.sprintf("qtc-bgnd-%x-%d-%d", col.rgba(), grad, app);
-            if (!m_usePixmapCache || !QPixmapCache::find(key, pix)) {
+            PixmapKey key(PIX_BGND, (quint64(grad & 0xff) << 32) |
+                          (app & 0xffffffff), col.rgba());
+            if (!findPixmap(key, pix)) {
                 pix = QPixmap(QSize(grad == GT_HORIZ ? constPixmapWidth :
                                     constPixmapHeight, grad == GT_HORIZ ?
                                     constPixmapHeight : constPixmapWidth));
@@ -2225,9 +2419,7 @@ Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r,
                                       grad == GT_HORIZ, false, app,
                                       WIDGET_OTHER);
                 pixPainter.end();
-                if (m_usePixmapCache) {
-                    QPixmapCache::insert(key, pix);
-                }
+                insertPixmap(key, pix);
             }
         }
 
@@ -2251,9 +2443,9 @@ Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r,
             grad == GT_HORIZ &&
             qtcGetGradient(app, &opts)->border == GB_SHINE) {
             int size = qMin(BGND_SHINE_SIZE, qMin(r.height() * 2, r.width()));
-            QString key;
-            key.sprintf("qtc-radial-%x", size / BGND_SHINE_STEPS);
-            if (!m_usePixmapCache || !QPixmapCache::find(key, pix)) {
+            // The alpha of the shine depends on the color.
+            PixmapKey key(PIX_RADIAL, size / BGND_SHINE_STEPS, col.rgba());
+            if (!findPixmap(key, pix)) {
                 size /= BGND_SHINE_STEPS;
                 size *= BGND_SHINE_STEPS;
                 pix = QPixmap(size, size / 2);
@@ -2276,9 +2468,7 @@ Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r,
                 pixPainter.fillRect(QRect(0, 0, pix.width(), pix.height()),
                                     gradient);
                 pixPainter.end();
-                if (m_usePixmapCache) {
-                    QPixmapCache::insert(key, pix);
-                }
+                insertPixmap(key, pix);
             }
             p->drawPixmap(r.x() + ((r.width() - pix.width()) / 2), r.y(), pix);
         }
@@ -2484,25 +2674,13 @@ Style::drawBackground(QPainter *p, const QWidget *widget,
     p->restore();
 }
 
-QPainterPath
-Style::buildPath(const QRectF &r, EWidget w, int round, double radius) const
+static void
+buildRoundedPath(QPainterPath &path, const QRectF &r, bool title, int round,
+                 double radius)
 {
-    QPainterPath path;
-
-    if (oneOf(w, WIDGET_RADIO_BUTTON, WIDGET_DIAL) ||
-        (w == WIDGET_MDI_WINDOW_BUTTON &&
-         opts.titlebarButtons & TITLEBAR_BUTTON_ROUND) || CIRCULAR_SLIDER(w)) {
-        path.addEllipse(r);
-        return path;
-    }
-
-    if (opts.round == ROUND_NONE || radius < 0.01) {
-        round = ROUNDED_NONE;
-    }
-
     double diameter = radius * 2;
 
-    if (w != WIDGET_MDI_WINDOW_TITLE && round & CORNER_BR) {
+    if (!title && round & CORNER_BR) {
         path.moveTo(r.x() + r.width(), r.y() + r.height() - radius);
     } else {
         path.moveTo(r.x() + r.width(), r.y() + r.height());
@@ -2518,14 +2696,14 @@ Style::buildPath(const QRectF &r, EWidget w, int round, double radius) const
     } else {
         path.lineTo(r.x(), r.y());
     }
-    if (w != WIDGET_MDI_WINDOW_TITLE && round & CORNER_BL) {
+    if (!title && round & CORNER_BL) {
         path.arcTo(r.x(), r.y() + r.height() - diameter,
                    diameter, diameter, 180, 90);
     } else {
         path.lineTo(r.x(), r.y() + r.height());
     }
 
-    if (w != WIDGET_MDI_WINDOW_TITLE) {
+    if (!title) {
         if (round & CORNER_BR) {
             path.arcTo(r.x() + r.width() - diameter,
                        r.y() + r.height() - diameter,
@@ -2534,26 +2712,18 @@ Style::buildPath(const QRectF &r, EWidget w, int round, double radius) const
             path.lineTo(r.x() + r.width(), r.y() + r.height());
         }
     }
-    return path;
-}
-
-QPainterPath
-Style::buildPath(const QRect &r, EWidget w, int round, double radius) const
-{
-    return buildPath(QRectF(r.x() + 0.5, r.y() + 0.5,
-                            r.width() - 1, r.height() - 1), w, round, radius);
 }
 
-void
-Style::buildSplitPath(const QRect &r, int round, double radius,
-                      QPainterPath &tl, QPainterPath &br) const
+static void
+buildSplitPaths(const QRectF &r, int round, double radius,
+                QPainterPath &tl, QPainterPath &br)
 {
-    double xd = r.x() + 0.5;
-    double yd = r.y() + 0.5;
+    double xd = r.x();
+    double yd = r.y();
     double diameter = radius * 2;
     bool rounded = diameter > 0.0;
-    int width = r.width() - 1;
-    int height = r.height() - 1;
+    double width = r.width();
+    double height = r.height();
 
     if (rounded && round & CORNER_TR) {
         tl.arcMoveTo(xd + width - diameter, yd, diameter, diameter, 45);
@@ -2594,6 +2764,85 @@ Style::buildSplitPath(const QRect &r, int round, double radius,
     }
 }
 
+// Rough size of a path, for the budget of m_paths.
+static size_t
+pathCost(const QPainterPath &path)
+{
+    return 64 + path.elementCount() * sizeof(QPainterPath::Element);
+}
+
+const Style::CachedPath&
+Style::cachedPath(const PathKey &key) const
+{
+    return *m_paths.get(key, [&] (size_t *cost) {
+            CachedPath res;
+            QRectF r(0, 0, key.width, key.height);
+            switch (key.kind) {
+            case PATH_ELLIPSE:
+                res.first.addEllipse(r);
+                break;
+            case PATH_SPLIT:
+                buildSplitPaths(r, key.round, key.radius,
+                                res.first, res.second);
+                break;
+            default:
+                buildRoundedPath(res.first, r, key.kind == PATH_TITLE,
+                                 key.round, key.radius);
+                break;
+            }
+            *cost = pathCost(res.first) + pathCost(res.second);
+            return res;
+        });
+}
+
+QPainterPath
+Style::buildPath(const QRectF &r, EWidget w, int round, double radius) const
+{
+    int kind = PATH_ROUNDED;
+    if (oneOf(w, WIDGET_RADIO_BUTTON, WIDGET_DIAL) ||
+        (w == WIDGET_MDI_WINDOW_BUTTON &&
+         opts.titlebarButtons & TITLEBAR_BUTTON_ROUND) || CIRCULAR_SLIDER(w)) {
+        kind = PATH_ELLIPSE;
+    } else if (w == WIDGET_MDI_WINDOW_TITLE) {
+        kind = PATH_TITLE;
+    }
+    round &= ROUNDED_ALL;
+    if (kind == PATH_ELLIPSE || opts.round == ROUND_NONE || radius < 0.01) {
+        round = ROUNDED_NONE;
+    }
+    if (round == ROUNDED_NONE) {
+        radius = 0;
+    }
+    const PathKey key = {r.width(), r.height(), radius, kind, round};
+    const QPainterPath &path = cachedPath(key).first;
+    // Only copied when moved, at the origin the path stays shared.
+    return r.topLeft().isNull() ? path : path.translated(r.topLeft());
+}
+
+QPainterPath
+Style::buildPath(const QRect &r, EWidget w, int round, double radius) const
+{
+    return buildPath(QRectF(r.x() + 0.5, r.y() + 0.5,
+                            r.width() - 1, r.height() - 1), w, round, radius);
+}
+
+void
+Style::buildSplitPath(const QRect &r, int round, double radius,
+                      QPainterPath &tl, QPainterPath &br) const
+{
+    round &= ROUNDED_ALL;
+    if (round == ROUNDED_NONE || radius <= 0) {
+        round = ROUNDED_NONE;
+        radius = 0;
+    }
+    const PathKey key = {double(r.width() - 1), double(r.height() - 1),
+                         radius, PATH_SPLIT, round};
+    const CachedPath &paths = cachedPath(key);
+    const QPointF offset(r.x() + 0.5, r.y() + 0.5);
+    tl = paths.first.translated(offset);
+    br = paths.second.translated(offset);
+}
+
 void
 Style::drawBorder(QPainter *p, const QRect &r, const QStyleOption *option,
                   int round, const QColor *custom, EWidget w,
@@ -3040,6 +3289,40 @@ void Style::drawMenuItem(QPainter *p, const QRect &r, const QStyleOption *option
     }
 }
 
+QRect
+Style::busyIndicatorRect(const QRect &r, bool vertical) const
+{
+    int chunkSize = PROGRESS_CHUNK_WIDTH * 3.4;
+    int measure = vertical ? r.height() : r.width();
+
+    if (chunkSize > measure / 2)
+        chunkSize = measure / 2;
+    if (measure - chunkSize <= 0)
+        return r;
+
+    int step = m_animateStep % ((measure - chunkSize) * 2);
+
+    if (step > (measure - chunkSize))
+        step = 2 * (measure - chunkSize) - step;
+
+    return (vertical ? QRect(r.x(), r.y() + step, r.width(), chunkSize) :
+            QRect(r.x() + step, r.y(), chunkSize, r.height()));
+}
+
+void
+Style::setProgressBarArea(const QWidget *widget, const QRect &contents,
+                          const QRect &band, bool vertical, bool busy) const
+{
+    if (!widget || !m_progressBars.contains((QProgressBar*)widget))
+        return;
+    // drawProgress() draws at least 3 pixels.
+    ProgressBarArea &area = m_progressBarAreas[widget];
+    area.contents = contents;
+    area.band = band.adjusted(0, 0, vertical ? 0 : 2, vertical ? 2 : 0);
+    area.vertical = vertical;
+    area.busy = busy;
+}
+
 void Style::drawProgress(QPainter *p, const QRect &r, const QStyleOption *option, bool vertical, bool reverse) const
 {
     QStyleOption opt(*option);
@@ -3671,17 +3954,17 @@ void Style::colorTab(QPainter *p, const QRect &r, bool horiz, EWidget tab, int r
 
 void Style::shadeColors(const QColor &base, QColor *vals) const
 {
+    static_assert(QTC_NUM_PALETTE_SHADES == ORIGINAL_SHADE + 1, "");
     bool useCustom(USE_CUSTOM_SHADES(opts));
-    double hl=TO_FACTOR(opts.highlightFactor);
+    QtcShadeParams params;
 
     for(int i=0; i<QTC_NUM_STD_SHADES; ++i)
-        shade(base, &vals[i], useCustom ? opts.customShades[i] :
-              qtcShadeGetIntern(opts.contrast, i,
-                                opts.darkerBorders, opts.shading));
-    shade(base, &vals[SHADE_ORIG_HIGHLIGHT], hl);
-    shade(vals[4], &vals[SHADE_4_HIGHLIGHT], hl);
-    shade(vals[2], &vals[SHADE_2_HIGHLIGHT], hl);
-    vals[ORIGINAL_SHADE]=base;
+        params.factors[i] = useCustom ? opts.customShades[i] :
+            qtcShadeGetIntern(opts.contrast, i, opts.darkerBorders,
+                              opts.shading);
+    params.highlight = TO_FACTOR(opts.highlightFactor);
+    params.shading = opts.shading;
+    qtcShadeColors(&base, &params, vals);
 }
 
 const QColor * Style::buttonColors(const QStyleOption *option) const
@@ -4082,7 +4365,7 @@ const QColor & Style::getFill(const QStyleOption *option, const QColor *use, boo
 QPixmap * Style::getPixmap(const QColor col, EPixmap p, double shade) const
 {
     QtcKey  key(createKey(col, p));
-    QPixmap *pix=m_pixmapCache.object(key);
+    QPixmap *pix=cachedPixmap(key);
 
     if (!pix) {
         if (p == PIX_DOT) {
@@ -4137,7 +4420,7 @@ QPixmap * Style::getPixmap(const QColor col, EPixmap p, double shade) const
                          col.blue(), shade, QTC_PIXEL_QT);
             *pix=QPixmap::fromImage(img);
         }
-        m_pixmapCache.insert(key, pix, pix->depth()/8);
+        cachePixmap(key, pix, pix->depth()/8);
     }
 
     return pix;
@@ -4324,8 +4607,7 @@ void Style::kdeGlobalSettingsChange(int type, int)
     switch(type) {
     case KGlobalSettings::StyleChanged: {
         m_configFile->reparseConfiguration();
-        if (m_usePixmapCache)
-            QPixmapCache::clear();
+        m_pixmaps.clear();
         init(false);
 
         for (QWidget *widget: QApplication::topLevelWidgets()) {
@@ -4336,8 +4618,7 @@ void Style::kdeGlobalSettingsChange(int type, int)
     case KGlobalSettings::PaletteChanged:
         m_configFile->reparseConfiguration();
         applyKdeSettings(true);
-        if (m_usePixmapCache)
-            QPixmapCache::clear();
+        m_pixmaps.clear();
         break;
     case KGlobalSettings::FontChanged:
         m_configFile->reparseConfiguration();
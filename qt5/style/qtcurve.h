@@ -28,6 +28,7 @@
 #include <QMap>
 #include <QList>
 #include <QSet>
+#include <QHash>
 #include <QCache>
 #include <QColor>
 #include <QFont>
@@ -45,6 +46,8 @@ using ParentStyleClass = QCommonStyle;
 
 typedef qulonglong QtcKey;
 #include <common/common.h>
+#include <qtcurve-utils/cachestats.h>
+#include <climits>
 
 class QStyleOptionSlider;
 class QLabel;
@@ -183,6 +186,149 @@ public:
     }
 
 private:
+    // The kinds of pixmaps kept in m_pixmaps.
+    enum EPixmapKind {
+        PIX_BEVEL = 1,
+        PIX_STRIPES,
+        PIX_BGND,
+        PIX_RADIAL,
+        PIX_SELECTION
+    };
+
+    // Key of a pixmap in m_pixmaps, the lower 60 bits of hi and all of lo
+    // are up to each kind to fill in.
+    struct PixmapKey {
+        quint64 hi;
+        quint64 lo;
+
+        PixmapKey(EPixmapKind kind, quint64 _hi, quint64 _lo)
+            : hi((quint64(kind) << 60) | (_hi & ((1ull << 60) - 1))),
+              lo(_lo)
+        {
+        }
+        bool
+        operator==(const PixmapKey &o) const
+        {
+            return hi == o.hi && lo == o.lo;
+        }
+    };
+    struct PixmapKeyHash {
+        size_t
+        operator()(const PixmapKey &key) const
+        {
+            return hashCombine(key.hi, key.lo);
+        }
+    };
+
+    bool findPixmap(const PixmapKey &key, QPixmap &pix) const;
+    void insertPixmap(const PixmapKey &key, const QPixmap &pix) const;
+    // Access to m_pixmapCache, counted for the cache statistics.
+    QPixmap*
+    cachedPixmap(QtcKey key) const
+    {
+        QPixmap *pix = m_pixmapCache.object(key);
+        (pix ? m_pixmapCacheStats.hits : m_pixmapCacheStats.misses)++;
+        return pix;
+    }
+    bool
+    cachePixmap(QtcKey key, QPixmap *pix, int cost) const
+    {
+        // QCache doesn't count what it drops. Anything missing after the
+        // insert, other than a replaced entry, was pushed out by it.
+        int expected = m_pixmapCache.count();
+        if (!m_pixmapCache.contains(key)) {
+            expected++;
+        }
+        bool res = m_pixmapCache.insert(key, pix, cost);
+        if (!res) {
+            // Too large, dropped without touching the cache.
+            expected--;
+        }
+        m_pixmapCacheStats.evictions += expected - m_pixmapCache.count();
+        return res;
+    }
+    void reportPixmapCache(CacheReport *report) const;
+
+    // The shapes kept in m_paths.
+    enum EPathKind {
+        PATH_ROUNDED,
+        PATH_TITLE,
+        PATH_ELLIPSE,
+        PATH_SPLIT
+    };
+
+    // Paths only depend on the size and not on the widget, other than through
+    // the kind, so identical buttons share them wherever they are drawn. They
+    // are built at the origin and translated into place.
+    struct PathKey {
+        double width;
+        double height;
+        double radius;
+        int kind;
+        int round;
+
+        bool
+        operator==(const PathKey &o) const
+        {
+            return (width == o.width && height == o.height &&
+                    radius == o.radius && kind == o.kind && round == o.round);
+        }
+    };
+    struct PathKeyHash {
+        size_t
+        operator()(const PathKey &key) const
+        {
+            quint64 bits[3];
+            memcpy(&bits[0], &key.width, sizeof(double));
+            memcpy(&bits[1], &key.height, sizeof(double));
+            memcpy(&bits[2], &key.radius, sizeof(double));
+            quint64 h = hashCombine(key.kind, key.round);
+            for (quint64 v: bits) {
+                h = hashCombine(h, v);
+            }
+            return h;
+        }
+    };
+    // The second path is only used by split paths (for the bottom right).
+    typedef QPair<QPainterPath, QPainterPath> CachedPath;
+    const CachedPath &cachedPath(const PathKey &key) const;
+
+    // Results of pixelMetric() and styleHint() that only depend on the
+    // options are resolved by initMetrics() for every init() so that the
+    // layout code doesn't go through the switches (and the widget checks)
+    // for each call. The QtC_* metrics are stored after the standard ones.
+    enum {
+        constNumStdMetrics = 128,
+        constNumMetrics = (constNumStdMetrics +
+                           QtC_TitleBarApp - QtC_Round + 1),
+        constNumHints = 128,
+        constUnknownMetric = INT_MIN
+    };
+    static int
+    metricIndex(unsigned metric)
+    {
+        if (metric < constNumStdMetrics) {
+            return metric;
+        } else if (metric >= (unsigned)QtC_Round &&
+                   metric <= (unsigned)QtC_TitleBarApp) {
+            return constNumStdMetrics + (metric - QtC_Round);
+        }
+        return -1;
+    }
+    int
+    cachedMetric(unsigned metric) const
+    {
+        int index = metricIndex(metric);
+        return index < 0 ? constUnknownMetric : m_metrics[index];
+    }
+    int
+    cachedHint(unsigned hint) const
+    {
+        return hint < constNumHints ? m_hints[hint] : constUnknownMetric;
+    }
+    void clearMetrics();
+    void initMetrics();
+
     void init(bool initial);
     void connectDBus();
     void freeColor(QSet<QColor*> &freedColors, QColor **cols);
@@ -293,6 +439,10 @@ private:
                       MenuItemType type, int round, const QColor *cols) const;
     void drawProgress(QPainter *p, const QRect &r, const QStyleOption *option,
                       bool vertical=false, bool reverse=false) const;
+    QRect busyIndicatorRect(const QRect &r, bool vertical) const;
+    void setProgressBarArea(const QWidget *widget, const QRect &contents,
+                            const QRect &band, bool vertical,
+                            bool busy) const;
     void drawArrow(QPainter *p, const QRect &rx, PrimitiveElement pe,
                    QColor col, bool small=false, bool kwin=false) const;
     void drawSbSliderHandle(QPainter *p, const QRect &r,
@@ -557,10 +707,30 @@ private:
     mutable QColor m_coloredBackgroundCols[TOTAL_SHADES + 1];
     mutable QColor m_coloredHighlightCols[TOTAL_SHADES + 1];
     mutable QCache<QtcKey, QPixmap> m_pixmapCache;
+    // Pixmaps of the style's own, kept apart from the application's
+    // QPixmapCache so that neither can evict the other's.
+    mutable LRUCache<PixmapKey, QPixmap, PixmapKeyHash> m_pixmaps;
+    mutable LRUCache<PathKey, CachedPath, PathKeyHash> m_paths;
+    mutable CacheStats m_pixmapCacheStats;
+    CacheRegistration m_pixmapCacheReg;
+    CacheRegistration m_pixmapsReg;
+    CacheRegistration m_pathsReg;
+    int m_metrics[constNumMetrics];
+    int m_hints[constNumHints];
     mutable bool m_active;
     mutable const QWidget *m_sbWidget;
     mutable QLabel *m_clickedLabel;
     QSet<QProgressBar*> m_progressBars;
+    // The part of each animated progress bar that changes between two
+    // frames, recorded when the bar is drawn so that the timer only has to
+    // repaint the stripes or the busy indicator.
+    struct ProgressBarArea {
+        QRect contents;
+        QRect band;
+        bool vertical;
+        bool busy;
+    };
+    mutable QHash<const QWidget*, ProgressBarArea> m_progressBarAreas;
     mutable int m_progressBarAnimateTimer,
         m_progressBarAnimateFps,
         m_animateStep;
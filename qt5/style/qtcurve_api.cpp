@@ -21,6 +21,7 @@
  *****************************************************************************/
 
 #include <qtcurve-utils/qtprops.h>
+#include <qtcurve-utils/trace.h>
 
 #include "qtcurve_p.h"
 #include "qtcurve_fonthelper.h"
@@ -62,7 +63,6 @@
 #include <QLineEdit>
 #include <QDir>
 #include <QSettings>
-#include <QPixmapCache>
 #include <QTextStream>
 #include <QFileDialog>
 #include <QToolBox>
@@ -159,6 +159,7 @@ void Style::FontHelper::unSetBold(QWidget *widget)
 void
 Style::polish(QApplication *app)
 {
+    qtcTrace("Style::polish(QApplication)");
     // appName = getFile(app->arguments()[0]);
 
     if (appName == "kwin" || appName == "kwin_x11" || appName == "kwin_wayland") {
@@ -231,6 +232,9 @@ Style::polish(QApplication *app)
         opts.menuBgndAppearance = APPEARANCE_FLAT;
     }
 
+    // Some of the options above are used by the metrics.
+    initMetrics();
+
     ParentStyleClass::polish(app);
     if (opts.hideShortcutUnderline) {
         app->installEventFilter(m_shortcutHandler);
@@ -239,6 +243,7 @@ Style::polish(QApplication *app)
 
 void Style::polish(QPalette &palette)
 {
+    qtcTrace("Style::polish(QPalette)");
     int  contrast(QSettings(QLatin1String("Trolltech")).value("/Qt/KDE/contrast", DEFAULT_CONTRAST).toInt());
     bool newContrast(false);
 
@@ -287,9 +292,7 @@ void Style::polish(QPalette &palette)
             oneOf(opts.menuBgndImage.type, IMG_PLAIN_RINGS,
                   IMG_BORDERED_RINGS, IMG_SQUARE_RINGS)) {
             qtcCalcRingAlphas(&m_backgroundCols[ORIGINAL_SHADE]);
-            if (m_usePixmapCache) {
-                QPixmapCache::clear();
-            }
+            m_pixmaps.clear();
         }
     }
 
@@ -435,6 +438,7 @@ void Style::polish(QPalette &palette)
 
 void Style::polish(QWidget *widget)
 {
+    qtcTrace("Style::polish(QWidget)");
     // TODO:
     //      Reorganize this polish function
     if (!widget)
@@ -529,7 +533,8 @@ void Style::polish(QWidget *widget)
                     statusBar->setHidden(true);
                 }
             }
-            setSbProp(widget);
+            X11PropBatch batch;
+            setSbProp(widget, batch);
             emitStatusBarState(sb.first());
         }
     }
@@ -944,6 +949,7 @@ void Style::unpolish(QWidget *widget)
         if(opts.boldProgress)
             m_fntHelper->unSetBold(widget);
         m_progressBars.remove((QProgressBar *)widget);
+        m_progressBarAreas.remove(widget);
     } else if (qobject_cast<QMenuBar*>(widget)) {
         widget->setAttribute(Qt::WA_Hover, false);
 
@@ -1228,8 +1234,9 @@ bool Style::eventFilter(QObject *object, QEvent *event)
 
         if (widget && widget->isWindow() &&
             (qtcIsDialog(widget) || qtcIsWindow(widget))) {
+            X11PropBatch batch;
             setBgndProp(widget, opts.bgndAppearance,
-                        IMG_NONE != opts.bgndImage.type);
+                        IMG_NONE != opts.bgndImage.type, batch);
         }
         break;
     }
@@ -1418,11 +1425,13 @@ bool Style::eventFilter(QObject *object, QEvent *event)
 
             if(widget && widget->isWindow() &&
                (qtcIsWindow(widget) || qtcIsDialog(widget))) {
+                // Both properties go out with a single flush.
+                X11PropBatch batch;
                 setBgndProp(widget, opts.bgndAppearance,
-                            IMG_NONE != opts.bgndImage.type);
+                            IMG_NONE != opts.bgndImage.type, batch);
                 int opacity = (qtcIsDialog(widget) ? opts.dlgOpacity :
                                opts.bgndOpacity);
-                setOpacityProp(widget, (unsigned short)opacity);
+                setOpacityProp(widget, (unsigned short)opacity, batch);
             }
         }
         break;
@@ -1448,6 +1457,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         // So we have to check on object.
         if (object && !m_progressBars.isEmpty()) {
             m_progressBars.remove(reinterpret_cast<QProgressBar*>(object));
+            m_progressBarAreas.remove(reinterpret_cast<QWidget*>(object));
             if (m_progressBars.isEmpty() && m_progressBarAnimateTimer) {
                 killTimer(m_progressBarAnimateTimer);
                 m_progressBarAnimateTimer = 0;
@@ -1499,12 +1509,25 @@ void Style::timerEvent(QTimerEvent *event)
     if (event->timerId() == m_progressBarAnimateTimer) {
         bool hasAnimation = false;
         m_animateStep = m_timer.elapsed() / (1000 / constProgressBarFps);
+        // All bars are invalidated from this single timer, Qt merges the
+        // resulting paint events of each window into one repaint.
         for (QProgressBar *bar: const_(m_progressBars)) {
             if ((opts.animatedProgress && 0 == m_animateStep % 2 &&
                  bar->value() != bar->minimum() &&
                  bar->value() != bar->maximum()) ||
                 (0 == bar->minimum() && 0 == bar->maximum())) {
-                bar->update();
+                auto it = m_progressBarAreas.constFind(bar);
+                if (it == m_progressBarAreas.constEnd()) {
+                    // Not drawn by us yet.
+                    bar->update();
+                } else if (it->busy) {
+                    // Clear the old position of the indicator and draw
+                    // the new one.
+                    bar->update(it->band |
+                                busyIndicatorRect(it->contents, it->vertical));
+                } else {
+                    bar->update(it->band);
+                }
                 hasAnimation = true;
             }
         }
@@ -1523,6 +1546,10 @@ Style::pixelMetric(PixelMetric metric, const QStyleOption *option,
                    const QWidget *widget) const
 {
     prePolish(widget);
+    int cached = cachedMetric(metric);
+    if (cached != constUnknownMetric) {
+        return cached;
+    }
     switch((unsigned)metric) {
     case PM_ToolTipLabelFrameWidth:
         if (opts.round != ROUND_NONE && !(opts.square & SQUARE_TOOLTIPS))
@@ -1825,6 +1852,10 @@ Style::styleHint(StyleHint hint, const QStyleOption *option,
                  const QWidget *widget, QStyleHintReturn *returnData) const
 {
     prePolish(widget);
+    int cached = cachedHint(hint);
+    if (cached != constUnknownMetric) {
+        return cached;
+    }
     switch (hint) {
     case SH_ToolTip_Mask:
     case SH_Menu_Mask:
@@ -2067,6 +2098,7 @@ void
 Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option,
                      QPainter *painter, const QWidget *widget) const
 {
+    qtcTrace("Style::drawPrimitive");
     prePolish(widget);
     bool (Style::*drawFunc)(PrimitiveElement, const QStyleOption*,
                             QPainter*, const QWidget*) const = nullptr;
@@ -2197,6 +2229,7 @@ void
 Style::drawControl(ControlElement element, const QStyleOption *option,
                    QPainter *painter, const QWidget *widget) const
 {
+    qtcTrace("Style::drawControl");
     prePolish(widget);
     QRect r = option->rect;
     const State &state = option->state;
@@ -2913,52 +2946,39 @@ Style::drawControl(ControlElement element, const QStyleOption *option,
 
             if (indeterminate) {
                 //Busy indicator
-                int chunkSize = PROGRESS_CHUNK_WIDTH * 3.4;
-                int measure = vertical ? r.height() : r.width();
-
-                if (chunkSize > measure / 2)
-                    chunkSize = measure / 2;
-
-                int step = m_animateStep % ((measure - chunkSize) * 2);
-                QStyleOption opt(*option);
-
-                if (step > (measure - chunkSize))
-                    step = 2 * (measure - chunkSize) - step;
-
-                opt.state |= State_Raised | State_Horizontal;
-                drawProgress(painter, vertical ? QRect(r.x(), r.y() + step,
-                                                       r.width(), chunkSize) :
-                             QRect(r.x() + step, r.y(), chunkSize, r.height()),
-                             option, vertical);
+                QRect band(busyIndicatorRect(r, vertical));
+                drawProgress(painter, band, option, vertical);
+                setProgressBarArea(widget, r, band, vertical, true);
             } else if (r.isValid() && bar->progress > 0) {
                 // workaround for bug in QProgressBar
                 qint64 progress = qMax(bar->progress, bar->minimum);
                 double pg = ((progress - bar->minimum) /
                              qtcMax(1.0, double(bar->maximum - bar->minimum)));
+                QRect band;
 
                 if (vertical) {
                     int height = qtcMin(r.height(), pg * r.height());
 
                     if (inverted) {
-                        drawProgress(painter, QRect(r.x(), r.y(), r.width(),
-                                                    height), option, true);
+                        band = QRect(r.x(), r.y(), r.width(), height);
                     } else {
-                        drawProgress(painter,
-                                     QRect(r.x(), r.y() + (r.height() - height),
-                                           r.width(), height), option, true);
+                        band = QRect(r.x(), r.y() + (r.height() - height),
+                                     r.width(), height);
                     }
+                    drawProgress(painter, band, option, true);
                 } else {
                     int width = qtcMin(r.width(), pg * r.width());
 
                     if (reverse || inverted) {
-                        drawProgress(painter, QRect(r.x() + r.width() - width,
-                                                    r.y(), width, r.height()),
-                                     option, false, true);
+                        band = QRect(r.x() + r.width() - width, r.y(),
+                                     width, r.height());
+                        drawProgress(painter, band, option, false, true);
                     } else {
-                        drawProgress(painter, QRect(r.x(), r.y(), width,
-                                                    r.height()), option);
+                        band = QRect(r.x(), r.y(), width, r.height());
+                        drawProgress(painter, band, option);
                     }
                 }
+                setProgressBarArea(widget, r, band, vertical, false);
             }
             painter->restore();
         }
@@ -4579,6 +4599,7 @@ Style::drawControl(ControlElement element, const QStyleOption *option,
 
 void Style::drawComplexControl(ComplexControl control, const QStyleOptionComplex *option, QPainter *painter, const QWidget *widget) const
 {
+    qtcTrace("Style::drawComplexControl");
     prePolish(widget);
     QRect               r(option->rect);
     const State &state(option->state);
@@ -25,6 +25,7 @@
 
 #include <qtcurve-utils/log.h>
 #include <qtcurve-utils/qtutils.h>
+#include <qtcurve-utils/x11qtc.h>
 #include "qtcurve.h"
 #include <QPainter>
 #include <QPushButton>
@@ -108,9 +109,10 @@ isOOWidget(const QWidget *widget)
 bool blendOOMenuHighlight(const QPalette &pal, const QColor &highlight);
 bool isNoEtchWidget(const QWidget *widget);
 
-void setOpacityProp(QWidget *w, unsigned short opacity);
-void setBgndProp(QWidget *w, EAppearance app, bool haveBgndImage);
-void setSbProp(QWidget *w);
+void setOpacityProp(QWidget *w, unsigned short opacity, X11PropBatch &batch);
+void setBgndProp(QWidget *w, EAppearance app, bool haveBgndImage,
+                 X11PropBatch &batch);
+void setSbProp(QWidget *w, X11PropBatch &batch);
 
 static inline QList<QStatusBar*>
 getStatusBars(QWidget *w)
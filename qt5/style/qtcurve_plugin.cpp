@@ -31,7 +31,8 @@
 #include <QApplication>
 
 #ifdef Qt5X11Extras_FOUND
-#  include <qtcurve-utils/x11base.h>
+#  include <qtcurve-utils/x11utils.h>
+#  include <QAbstractNativeEventFilter>
 #  include <QX11Info>
 #endif
 
@@ -113,6 +114,24 @@ qtcEventCallback(void **cbdata)
     return false;
 }
 
+#ifdef Qt5X11Extras_FOUND
+// Feeds the X events to qtcurve-utils so that it can keep track of the
+// compositing state without asking the server for it.
+class X11EventFilter: public QAbstractNativeEventFilter {
+public:
+    bool
+    nativeEventFilter(const QByteArray &type, void *message, long*) override
+    {
+        if (type == "xcb_generic_event_t") {
+            qtcX11FilterEvent((const xcb_generic_event_t*)message);
+        }
+        return false;
+    }
+};
+
+static X11EventFilter *x11EventFilter = nullptr;
+#endif
+
 static StylePlugin *firstPlInstance = nullptr;
 static QList<Style*> *styleInstances = nullptr;
 
@@ -149,6 +168,14 @@ void StylePlugin::unregisterCallback()
                                     qtcEventCallback);
         m_eventNotifyCallbackInstalled = false;
     }
+#ifdef Qt5X11Extras_FOUND
+    if (x11EventFilter && QCoreApplication::instance()) {
+        QCoreApplication::instance()->removeNativeEventFilter(x11EventFilter);
+        delete x11EventFilter;
+        x11EventFilter = nullptr;
+        qtcX11UntrackCompositing();
+    }
+#endif
 }
 
 StylePlugin::~StylePlugin()
@@ -186,7 +213,11 @@ StylePlugin::init()
 #endif
 #ifdef Qt5X11Extras_FOUND
             if (qApp->platformName() == "xcb") {
-                qtcX11InitXcb(QX11Info::connection(), QX11Info::appScreen());
+                qtcX11InitXcb(QX11Info::connection(), QX11Info::appScreen(),
+                              QX11Info::display());
+                x11EventFilter = new X11EventFilter;
+                qApp->installNativeEventFilter(x11EventFilter);
+                qtcX11TrackCompositing();
             }
 #endif
         });
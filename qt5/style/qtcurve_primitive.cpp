@@ -29,7 +29,6 @@
 #include <QComboBox>
 #include <QMainWindow>
 #include <QListView>
-#include <QPixmapCache>
 #include <QDockWidget>
 #include <QGroupBox>
 #include <QDial>
@@ -851,9 +850,8 @@ Style::drawPrimitivePanelItemViewItem(PrimitiveElement,
                               opts.selectionAppearance, WIDGET_SELECTION);
         } else {
             QPixmap pix;
-            QString key;
-            key.sprintf("qtc-sel-%x-%x", r.height(), color.rgba());
-            if (!m_usePixmapCache || !QPixmapCache::find(key, pix)) {
+            PixmapKey key(PIX_SELECTION, r.height(), color.rgba());
+            if (!findPixmap(key, pix)) {
                 pix = QPixmap(QSize(24, r.height()));
                 pix.fill(Qt::transparent);
                 QPainter pixPainter(&pix);
@@ -873,9 +871,7 @@ Style::drawPrimitivePanelItemViewItem(PrimitiveElement,
                                                   ROUNDED_ALL, radius));
                 }
                 pixPainter.end();
-                if (m_usePixmapCache) {
-                    QPixmapCache::insert(key, pix);
-                }
+                insertPixmap(key, pix);
             }
             bool roundedLeft = false;
             bool roundedRight = false;
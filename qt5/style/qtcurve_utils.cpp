@@ -51,12 +51,13 @@
 #include <QSpinBox>
 #include <QDir>
 #include <QSettings>
-#include <QPixmapCache>
 #include <QTextStream>
 
 #include "shadowhelper.h"
 #include <qtcurve-utils/x11qtc.h>
 #include <qtcurve-utils/qtutils.h>
+#include <qtcurve-utils/lrucache.h>
+#include <qtcurve-utils/shape.h>
 #include <sys/time.h>
 
 namespace QtCurve {
@@ -97,19 +98,20 @@ bool isNoEtchWidget(const QWidget *widget)
 }
 
 void
-setOpacityProp(QWidget *w, unsigned short opacity)
+setOpacityProp(QWidget *w, unsigned short opacity, X11PropBatch &batch)
 {
     // DO NOT condition compile on QTC_ENABLE_X11.
     // There's no direct linkage on X11 and the following code will just do
     // nothing if X11 is not enabled (either at compile time or at run time).
     QTC_RET_IF_FAIL(qtcX11Enabled());
     if (WId wid = qtcGetWid(w->window())) {
-        qtcX11SetOpacity(wid, opacity);
+        batch.setOpacity(wid, opacity);
     }
 }
 
 void
-setBgndProp(QWidget *w, EAppearance app, bool haveBgndImage)
+setBgndProp(QWidget *w, EAppearance app, bool haveBgndImage,
+            X11PropBatch &batch)
 {
     // DO NOT condition compile on QTC_ENABLE_X11.
     // There's no direct linkage on X11 and the following code will just do
@@ -121,11 +123,11 @@ setBgndProp(QWidget *w, EAppearance app, bool haveBgndImage)
                             APPEARANCE_FLAT) : app) & 0xFF) |
                          (w->palette().background().color().rgb() &
                           0x00FFFFFF) << 8);
-        qtcX11SetBgnd(wid, prop);
+        batch.setBgnd(wid, prop);
     }
 }
 
-void setSbProp(QWidget *w)
+void setSbProp(QWidget *w, X11PropBatch &batch)
 {
     // DO NOT condition compile on QTC_ENABLE_X11.
     // There's no direct linkage on X11 and the following code will just do
@@ -137,7 +139,7 @@ void setSbProp(QWidget *w)
 
         if (!prop.isValid() || !prop.toBool()) {
             w->setProperty(constStatusBarProperty, true);
-            qtcX11SetStatusBar(wid);
+            batch.setStatusBar(wid);
         }
     }
 }
@@ -217,24 +219,30 @@ updateMenuBarEvent(QMouseEvent *event, QMenuBar *menu)
     return false;
 }
 
+// Popups and combo lists set their mask on every resize and it is asked for
+// with SH_Menu_Mask when painting, keep the regions of the last few sizes.
+static const size_t constWindowMasks = 16;
+
 QRegion
 windowMask(const QRect &r, bool full)
 {
-    int x, y, w, h;
-    r.getRect(&x, &y, &w, &h);
-
-    if (full) {
-        QRegion region(x + 4, y + 0, w-4*2, h-0*2);
-        region += QRegion(x + 0, y + 4, w-0*2, h-4*2);
-        region += QRegion(x + 2, y + 1, w-2*2, h-1*2);
-        region += QRegion(x + 1, y + 2, w-1*2, h-2*2);
-        return region;
-    } else {
-        QRegion region(x+1, y+1, w-2, h-2);
-        region += QRegion(x, y+2, w, h-4);
-        region += QRegion(x+2, y, w-4, h);
-        return region;
-    }
+    static LRUCache<quint64, QRegion> masks(constWindowMasks);
+    const quint64 key = ((quint64(r.width() & 0x7FFFFFFF) << 33) |
+                         (quint64(r.height() & 0x7FFFFFFF) << 1) |
+                         (full ? 1 : 0));
+    const QRegion *region = masks.get(key, [&] (size_t*) {
+            ShapeRect rects[Shape::maxRects];
+            size_t num = Shape::rounded(r.width(), r.height(), full, rects);
+            QVector<QRect> qrects(num);
+            for (size_t i = 0;i < num;i++) {
+                qrects[i] = QRect(rects[i].x, rects[i].y,
+                                  rects[i].width, rects[i].height);
+            }
+            QRegion res;
+            res.setRects(qrects.constData(), num);
+            return res;
+        });
+    return region->translated(r.topLeft());
 }
 
 const QWidget*
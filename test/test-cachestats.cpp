@@ -0,0 +1,72 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/cachestats.h>
+#include <assert.h>
+#include <string>
+
+using namespace QtCurve;
+
+static const CacheReport*
+findReport(const CacheRegistry::Reports &reports, const char *name)
+{
+    for (auto &report: reports) {
+        if (report.first == name) {
+            return &report.second;
+        }
+    }
+    return nullptr;
+}
+
+int
+main()
+{
+    // The caches of the library itself.
+    const size_t numBuiltin = CacheRegistry::collect().size();
+    LRUCache<int, std::string> cache(10);
+    {
+        CacheRegistration reg("test", [&] (CacheReport *report) {
+                reportCache(cache, report);
+            });
+        assert(cache.find(1) == nullptr);
+        cache.insert(1, "a", 6);
+        assert(*cache.find(1) == "a");
+        cache.insert(2, "b", 6);
+
+        auto reports = CacheRegistry::collect();
+        const CacheReport *report = findReport(reports, "test");
+        assert(report);
+        assert(report->hits == 1 && report->misses == 1);
+        assert(report->lookups() == 2);
+        assert(report->evictions == 1);
+        assert(report->entries == 1 && report->bytes == 6);
+
+        CacheRegistration other("other", [] (CacheReport *report) {
+                report->bytes = 42;
+            });
+        reports = CacheRegistry::collect();
+        assert(reports.size() == numBuiltin + 2 &&
+               reports.back().first == "other");
+        assert(findReport(reports, "other")->bytes == 42);
+    }
+    assert(CacheRegistry::collect().size() == numBuiltin);
+    return 0;
+}
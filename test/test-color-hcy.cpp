@@ -0,0 +1,258 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/color.h>
+#include <assert.h>
+
+/**
+ * Reference (pow based) implementation of the HCY color math.
+ */
+
+static double
+refGamma(double n)
+{
+    return pow(qtcBound(0, n, 1), 2.2);
+}
+
+static double
+refIGamma(double n)
+{
+    return pow(qtcBound(0, n, 1), 1.0 / 2.2);
+}
+
+static double
+refLuma(const QtcColor *c)
+{
+    return qtcColorHCYLumag(refGamma(c->red), refGamma(c->green),
+                            refGamma(c->blue));
+}
+
+static void
+refFromColor(const QtcColor *color, QtcColorHCY *hcy)
+{
+    double r = refGamma(color->red);
+    double g = refGamma(color->green);
+    double b = refGamma(color->blue);
+    hcy->y = qtcColorHCYLumag(r, g, b);
+    double p = qtcMax(qtcMax(r, g), b);
+    double n = qtcMin(qtcMin(r, g), b);
+    double d = 6.0 * (p - n);
+    if (n == p) {
+        hcy->h = 0.0;
+    } else if (r == p) {
+        hcy->h = ((g - b) / d);
+    } else if (g == p) {
+        hcy->h = ((b - r) / d) + (1.0 / 3.0);
+    } else {
+        hcy->h = ((r - g) / d) + (2.0 / 3.0);
+    }
+    if (0.0 == hcy->y || 1.0 == hcy->y) {
+        hcy->c = 0.0;
+    } else {
+        hcy->c = qtcMax((hcy->y - n) / hcy->y, (p - hcy->y) / (1 - hcy->y));
+    }
+}
+
+static void
+refToColor(const QtcColorHCY *hcy, QtcColor *color)
+{
+    double _h = qtcColorWrap(hcy->h, 1);
+    double _c = qtcBound(0, hcy->c, 1);
+    double _y = qtcBound(0, hcy->y, 1);
+    double _hs = _h * 6.0, th, tm;
+    if (_hs < 1.0) {
+        th = _hs;
+        tm = _qtc_yc[0] + _qtc_yc[1] * th;
+    } else if (_hs < 2.0) {
+        th = 2.0 - _hs;
+        tm = _qtc_yc[1] + _qtc_yc[0] * th;
+    } else if (_hs < 3.0) {
+        th = _hs - 2.0;
+        tm = _qtc_yc[1] + _qtc_yc[2] * th;
+    } else if (_hs < 4.0) {
+        th = 4.0 - _hs;
+        tm = _qtc_yc[2] + _qtc_yc[1] * th;
+    } else if (_hs < 5.0) {
+        th = _hs - 4.0;
+        tm = _qtc_yc[2] + _qtc_yc[0] * th;
+    } else {
+        th = 6.0 - _hs;
+        tm = _qtc_yc[0] + _qtc_yc[2] * th;
+    }
+    double tn, to, tp;
+    if (tm >= _y) {
+        tp = _y + _y * _c * (1.0 - tm) / tm;
+        to = _y + _y * _c * (th - tm) / tm;
+        tn = _y - (_y * _c);
+    } else {
+        tp = _y + (1.0 - _y) * _c;
+        to = _y + (1.0 - _y) * _c * (th - tm) / (1.0 - tm);
+        tn = _y - (1.0 - _y) * _c * tm / (1.0 - tm);
+    }
+    tp = refIGamma(tp);
+    to = refIGamma(to);
+    tn = refIGamma(tn);
+    if (_hs < 1.0) {
+        qtcColorFill(color, tp, to, tn);
+    } else if (_hs < 2.0) {
+        qtcColorFill(color, to, tp, tn);
+    } else if (_hs < 3.0) {
+        qtcColorFill(color, tn, tp, to);
+    } else if (_hs < 4.0) {
+        qtcColorFill(color, tn, to, tp);
+    } else if (_hs < 5.0) {
+        qtcColorFill(color, to, tn, tp);
+    } else {
+        qtcColorFill(color, tp, tn, to);
+    }
+}
+
+static double
+refRatio(const QtcColor *c1, const QtcColor *c2)
+{
+    double y1 = refLuma(c1);
+    double y2 = refLuma(c2);
+    return y1 > y2 ? (y1 + 0.05) / (y2 + 0.05) : (y2 + 0.05) / (y1 + 0.05);
+}
+
+static void
+refTint(const QtcColor *base, const QtcColor *col, double amount,
+        QtcColor *out)
+{
+    double ri = refRatio(base, col);
+    double rg = 1.0 + ((ri + 1.0) * amount * amount * amount);
+    double u = 1.0, l = 0.0;
+    for (int i = 12;i;i--) {
+        double a = 0.5 * (l + u);
+        QtcColor mixed;
+        _qtcColorMix(base, col, pow(a, 0.3), &mixed);
+        QtcColorHCY hcy;
+        refFromColor(&mixed, &hcy);
+        hcy.y = qtcColorMixF(refLuma(base), hcy.y, a);
+        refToColor(&hcy, out);
+        if (refRatio(base, out) > rg) {
+            u = a;
+        } else {
+            l = a;
+        }
+    }
+}
+
+static double
+colorDiff(const QtcColor &c1, const QtcColor &c2)
+{
+    return qtcMax(qtcMax(std::abs(c1.red - c2.red),
+                         std::abs(c1.green - c2.green)),
+                  std::abs(c1.blue - c2.blue));
+}
+
+static const QtcColor colors[] = {
+    {0, 0, 0}, {1, 1, 1}, {0.5, 0.5, 0.5}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1},
+    {0.2, 0.4, 0.8}, {0.9, 0.1, 0.3}, {0.93, 0.92, 0.9}, {0.01, 0.02, 0.05},
+    {0.24, 0.68, 0.91}, {0.61, 0.35, 0.71},
+};
+
+static void
+test_gamma()
+{
+    for (int i = 0;i <= 100000;i++) {
+        double x = i / 100000.0;
+        assert(std::abs(qtcColorHCYGamma(x) - refGamma(x)) < 1e-6);
+        assert(std::abs(qtcColorHCYIGamma(x) - refIGamma(x)) < 1e-6);
+    }
+    assert(qtcColorHCYGamma(0) == 0 && qtcColorHCYGamma(1) == 1);
+    assert(qtcColorHCYIGamma(0) == 0 && qtcColorHCYIGamma(1) == 1);
+    assert(qtcColorHCYGamma(-1) == 0 && qtcColorHCYIGamma(2) == 1);
+}
+
+static void
+test_convert()
+{
+    const size_t n = sizeof(colors) / sizeof(colors[0]);
+    QtcColorHCY hcys[n];
+    QtcColor res[n];
+    qtcColorHCYFromColors(colors, hcys, n);
+    qtcColorHCYToColors(hcys, res, n);
+    for (size_t i = 0;i < n;i++) {
+        QtcColorHCY ref;
+        refFromColor(&colors[i], &ref);
+        QtcColor ref_color;
+        refToColor(&ref, &ref_color);
+        assert(std::abs(hcys[i].y - ref.y) < 1e-6);
+        assert(colorDiff(res[i], ref_color) < 1e-5);
+    }
+}
+
+static void
+test_shade()
+{
+    for (auto &color: colors) {
+        for (double k: {0.6, 0.9, 1.1, 1.4}) {
+            QtcColorHCY ref_hcy;
+            refFromColor(&color, &ref_hcy);
+            if (k > 1) {
+                double ky = k * 1.15 - 1.0;
+                ref_hcy.y = 1.0 - qtcBound(0, (1.0 - ref_hcy.y) *
+                                           (1.0 - ky), 1);
+                ref_hcy.c = 1.0 - qtcBound(0, (1.0 - ref_hcy.c), 1);
+            } else {
+                ref_hcy.y = qtcBound(0, ref_hcy.y * k * 0.85, 1);
+                ref_hcy.c = qtcBound(0, ref_hcy.c, 1);
+            }
+            QtcColor ref;
+            refToColor(&ref_hcy, &ref);
+            QtcColor res;
+            _qtcShade(&color, &res, k, Shading::HCY);
+            assert(colorDiff(res, ref) < 1e-5);
+        }
+    }
+}
+
+static void
+test_tint()
+{
+    // In theory the bisection could take a different branch when the
+    // contrast ratio is (almost) exactly the one wanted, none of these do.
+    for (auto &base: colors) {
+        for (auto &col: colors) {
+            for (double amount: {0.1, 0.3, 0.5, 0.9}) {
+                QtcColor ref;
+                refTint(&base, &col, amount, &ref);
+                // Twice, the second time from the cache.
+                for (int n = 0;n < 2;n++) {
+                    QtcColor res;
+                    _qtcColorTint(&base, &col, amount, &res);
+                    assert(colorDiff(res, ref) < 1e-5);
+                }
+            }
+        }
+    }
+}
+
+int
+main()
+{
+    test_gamma();
+    test_convert();
+    test_shade();
+    test_tint();
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/confcache.h>
+#include <assert.h>
+#include <unistd.h>
+#include <string>
+
+using namespace QtCurve;
+
+static void
+writeFile(const std::string &path, const char *content)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    assert(f);
+    fputs(content, f);
+    fclose(f);
+}
+
+static ConfCache::Writer
+makePayload(int val)
+{
+    ConfCache::Writer w;
+    w.put<int>(val);
+    w.putStr("qtcurve");
+    w.putStr(nullptr);
+    w.put<double>(0.5);
+    return w;
+}
+
+static bool
+readPayload(const std::string &cachePath, const std::string &config,
+            uint64_t layout, int *val)
+{
+    ConfCache::File cache(cachePath, {config.c_str(), nullptr}, layout);
+    if (!cache.load()) {
+        return false;
+    }
+    ConfCache::Reader r = cache.reader();
+    const char *str;
+    const char *null;
+    size_t len;
+    size_t nullLen;
+    double d;
+    r.get(val);
+    r.getStr(&str, &len);
+    r.getStr(&null, &nullLen);
+    r.get(&d);
+    assert(r.atEnd());
+    assert(len == 7 && memcmp(str, "qtcurve", 7) == 0);
+    assert(!null && nullLen == 0);
+    assert(d == 0.5);
+    // Reading past the end fails and stays failed.
+    assert(!r.get(&d) && !r.ok());
+    return true;
+}
+
+int
+main()
+{
+    char dir[] = "/tmp/qtc-confcache-XXXXXX";
+    assert(mkdtemp(dir));
+    const std::string config = std::string(dir) + "/stylerc";
+    const std::string cachePath = ConfCache::File::path(config.c_str(),
+                                                        "test");
+    int val = 0;
+    writeFile(config, "version=1.9.0\n");
+
+    // Nothing saved yet.
+    assert(!readPayload(cachePath, config, 1, &val));
+    {
+        ConfCache::File cache(cachePath, {config.c_str(), nullptr}, 1);
+        assert(cache.save(makePayload(42)));
+    }
+    assert(readPayload(cachePath, config, 1, &val) && val == 42);
+    // Different layout.
+    assert(!readPayload(cachePath, config, 2, &val));
+    // Changed config with the same size.
+    writeFile(config, "version=1.9.1\n");
+    assert(!readPayload(cachePath, config, 1, &val));
+    {
+        ConfCache::File cache(cachePath, {config.c_str(), nullptr}, 1);
+        assert(cache.save(makePayload(7)));
+    }
+    assert(readPayload(cachePath, config, 1, &val) && val == 7);
+    // Corrupted payload.
+    {
+        FILE *f = fopen(cachePath.c_str(), "r+");
+        assert(f);
+        fseek(f, -1, SEEK_END);
+        fputc(0x55, f);
+        fclose(f);
+    }
+    assert(!readPayload(cachePath, config, 1, &val));
+    // A missing source is a valid state, creating it invalidates the cache.
+    unlink(config.c_str());
+    {
+        ConfCache::File cache(cachePath, {config.c_str()}, 1, false);
+        assert(!cache.load());
+        assert(cache.save(makePayload(1)));
+    }
+    {
+        ConfCache::File cache(cachePath, {config.c_str()}, 1, false);
+        assert(cache.load());
+    }
+    writeFile(config, "version=1.9.2\n");
+    {
+        ConfCache::File cache(cachePath, {config.c_str()}, 1, false);
+        assert(!cache.load());
+        assert(cache.save(makePayload(2)));
+    }
+    {
+        ConfCache::File cache(cachePath, {config.c_str()}, 1, false);
+        assert(cache.load());
+    }
+    // A source that is not a regular file disables the cache.
+    {
+        ConfCache::File cache(cachePath, {dir}, 1);
+        assert(!cache.save(makePayload(1)));
+        assert(!cache.load());
+    }
+    // Empty path disables the cache.
+    {
+        ConfCache::File cache("", {nullptr}, 1);
+        assert(!cache.save(makePayload(1)));
+        assert(!cache.load());
+    }
+    unlink(config.c_str());
+    unlink(cachePath.c_str());
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/ini.h>
+#include <assert.h>
+#include <unistd.h>
+#include <string>
+
+using namespace QtCurve;
+
+static void
+writeFile(const std::string &path, const char *content)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    assert(f);
+    fputs(content, f);
+    fclose(f);
+}
+
+static bool
+isValue(const IniFile &ini, const char *group, const char *key,
+        const char *val)
+{
+    const char *res = ini.value(group, key);
+    return res && strcmp(res, val) == 0;
+}
+
+int
+main()
+{
+    char dir[] = "/tmp/qtc-ini-XXXXXX";
+    assert(mkdtemp(dir));
+    const std::string sys = std::string(dir) + "/system";
+    const std::string user = std::string(dir) + "/user";
+    writeFile(sys, "top=1\n"
+              "# comment\n"
+              "[Colors:Button]\n"
+              "BackgroundNormal=1,2,3\n"
+              "ForegroundNormal = 4,5,6 \r\n"
+              "BackgroundNormal=7,8,9\n"
+              "\n"
+              "[General]\n"
+              "font=Sans Serif,10,-1,5,50,0,0,0,0,0\n"
+              "widgetStyle[$e]=qtcurve\n"
+              "Name[de]=local\n"
+              "[Icons]\n"
+              "Theme=oxygen");
+    writeFile(user, "[colors:button]\n"
+              "backgroundNormal=10,11,12\n"
+              "[Icons]\n"
+              "Theme=\n"
+              "[Empty]\n");
+
+    IniFile ini;
+    assert(!ini.load((std::string(dir) + "/missing").c_str()));
+    assert(ini.empty());
+    assert(ini.load(sys.c_str()));
+    assert(isValue(ini, "", "top", "1"));
+    // First duplicate in a file wins.
+    assert(isValue(ini, "Colors:Button", "BackgroundNormal", "1,2,3"));
+    assert(isValue(ini, "Colors:Button", "ForegroundNormal", "4,5,6"));
+    assert(isValue(ini, "General", "widgetStyle", "qtcurve"));
+    assert(isValue(ini, "General", "Name[de]", "local"));
+    assert(!ini.value("General", "Name"));
+    assert(isValue(ini, "Icons", "Theme", "oxygen"));
+    assert(!ini.value("Icons", "Size"));
+    assert(!ini.value("Toolbar style", "ToolButtonStyle"));
+
+    // Later files override, names are case insensitive.
+    assert(ini.load(user.c_str()));
+    assert(isValue(ini, "COLORS:BUTTON", "backgroundnormal", "10,11,12"));
+    assert(isValue(ini, "Colors:Button", "ForegroundNormal", "4,5,6"));
+    assert(isValue(ini, "Icons", "Theme", ""));
+    assert(!ini.value("Empty", "Theme"));
+
+    ConfCache::Writer w;
+    ini.serialize(w);
+    IniFile copy;
+    {
+        ConfCache::Reader r(w.data().data(), w.data().size());
+        assert(copy.deserialize(r) && r.atEnd());
+    }
+    assert(isValue(copy, "Colors:Button", "BackgroundNormal", "10,11,12"));
+    assert(isValue(copy, "General", "font",
+                   "Sans Serif,10,-1,5,50,0,0,0,0,0"));
+    // A truncated serialization is rejected and leaves the object alone.
+    {
+        ConfCache::Reader r(w.data().data(), w.data().size() - 1);
+        assert(!copy.deserialize(r));
+    }
+    assert(isValue(copy, "Icons", "Theme", ""));
+
+    unlink(sys.c_str());
+    unlink(user.c_str());
+    rmdir(dir);
+    return 0;
+}
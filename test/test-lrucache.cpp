@@ -0,0 +1,81 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/lrucache.h>
+#include <assert.h>
+#include <string>
+
+using namespace QtCurve;
+
+int
+main()
+{
+    LRUCache<int, std::string> cache(10);
+    assert(cache.find(1) == nullptr);
+    assert(cache.stats().misses == 1);
+
+    cache.insert(1, "a", 4);
+    cache.insert(2, "b", 4);
+    assert(cache.size() == 2 && cache.cost() == 8);
+    // Touch 1 so that 2 becomes the least recently used entry.
+    assert(*cache.find(1) == "a");
+    assert(cache.stats().hits == 1);
+
+    cache.insert(3, "c", 4);
+    assert(cache.size() == 2 && cache.cost() == 8);
+    assert(cache.stats().evictions == 1);
+    assert(cache.find(2) == nullptr);
+    assert(*cache.find(1) == "a");
+    assert(*cache.find(3) == "c");
+
+    // Replacing an entry updates its cost instead of adding to it.
+    cache.insert(3, "d", 2);
+    assert(cache.size() == 2 && cache.cost() == 6);
+    assert(*cache.find(3) == "d");
+
+    // The newest entry is kept even if it is over the budget on its own.
+    std::string *big = cache.insert(4, "e", 20);
+    assert(*big == "e");
+    assert(cache.size() == 1 && cache.cost() == 20);
+
+    int created = 0;
+    auto create = [&] (size_t *cost) {
+        created++;
+        *cost = 1;
+        return std::string("f");
+    };
+    assert(*cache.get(5, create) == "f");
+    assert(*cache.get(5, create) == "f");
+    assert(created == 1);
+    assert(cache.size() == 1 && cache.find(4) == nullptr);
+
+    cache.setBudget(0);
+    assert(cache.size() == 1);
+    cache.clear();
+    assert(cache.size() == 0 && cache.cost() == 0);
+
+    // Keys differing in one bit should not share most of their hash bits.
+    uint64_t h1 = hashMix(1);
+    uint64_t h2 = hashMix(2);
+    assert(__builtin_popcountll(h1 ^ h2) > 16);
+    assert(hashCombine(1, 2) != hashCombine(2, 1));
+    return 0;
+}
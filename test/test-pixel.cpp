@@ -0,0 +1,164 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/pixel.h>
+#include <qtcurve-utils/number.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace QtCurve;
+
+static const QtcPixelByteOrder orders[] = {
+    QTC_PIXEL_ARGB, QTC_PIXEL_BGRA, QTC_PIXEL_RGBA
+};
+
+// Index of red, green, blue and alpha for each byte order.
+static const int layouts[][4] = {{1, 2, 3, 0}, {2, 1, 0, 3}, {0, 1, 2, 3}};
+
+static const Pixel::Impl impls[] = {
+    Pixel::Impl::Scalar, Pixel::Impl::SSE2, Pixel::Impl::AVX2
+};
+
+// The per pixel implementation qtcAdjustPix used to have.
+static void
+refAdjust(unsigned char *data, int numChannels, int w, int h, int stride,
+          int r, int g, int b, QtcPixelByteOrder order)
+{
+    for (int row = 0;row < h;row++) {
+        for (int col = 0;col < w * numChannels;col += numChannels) {
+            unsigned char *p = data + row * stride + col;
+            unsigned char source = p[1];
+            int new_r = qtcBound(0, r - source, 255);
+            int new_g = qtcBound(0, g - source, 255);
+            int new_b = qtcBound(0, b - source, 255);
+            switch (order) {
+            case QTC_PIXEL_ARGB:
+                p[1] = new_r;
+                p[2] = new_g;
+                p[3] = new_b;
+                break;
+            case QTC_PIXEL_BGRA:
+                p[0] = new_b;
+                p[1] = new_g;
+                p[2] = new_r;
+                break;
+            default:
+                p[0] = new_r;
+                p[1] = new_g;
+                p[2] = new_b;
+                break;
+            }
+        }
+    }
+}
+
+static void
+testAdjust()
+{
+    const int w = 37;
+    const int h = 5;
+    const int colors[][3] = {
+        {0, 0, 0}, {255, 255, 255}, {128, 300, 17}, {600, -20, 255}
+    };
+    for (int channels = 3;channels <= 4;channels++) {
+        const int stride = w * channels + 3;
+        std::vector<unsigned char> src(stride * h);
+        for (auto &c: src) {
+            c = rand();
+        }
+        for (auto order: orders) {
+            if (channels == 3 && order == QTC_PIXEL_ARGB) {
+                continue;
+            }
+            for (auto &color: colors) {
+                std::vector<unsigned char> ref(src);
+                refAdjust(ref.data(), channels, w, h, stride,
+                          color[0], color[1], color[2], order);
+                for (auto impl: impls) {
+                    if (!Pixel::setImpl(impl)) {
+                        continue;
+                    }
+                    std::vector<unsigned char> res(src);
+                    Pixel::adjust(res.data(), channels, w, h, stride,
+                                  color[0], color[1], color[2], order);
+                    assert(res == ref);
+                }
+            }
+        }
+    }
+}
+
+static void
+testShadow()
+{
+    const size_t n = 45;
+    std::vector<float> bias(n);
+    for (size_t i = 0;i < n;i++) {
+        bias[i] = i == 0 ? 0 : i == 1 ? 1 : i == 2 ? 1.2 :
+            (rand() % 1000) / 999.0;
+    }
+    const QtcColor c1 = {0.1, 0.5, 0.9};
+    const QtcColor c2 = {1, 0, 0.3};
+    for (auto order: orders) {
+        Pixel::setImpl(Pixel::Impl::Scalar);
+        std::vector<unsigned char> ref(n * 4);
+        Pixel::fillShadow(ref.data(), bias.data(), n, &c1, &c2, order);
+        for (size_t i = 0;i < n;i++) {
+            // Compare with the double precision result.
+            unsigned alpha = qtcBound(0, 0xff * double(bias[i]), 0xff);
+            double k = qtcBound(0, bias[i], 1);
+            double rgb[] = {
+                c2.red + (c1.red - c2.red) * k,
+                c2.green + (c1.green - c2.green) * k,
+                c2.blue + (c1.blue - c2.blue) * k,
+            };
+            const int *layout = layouts[order];
+            unsigned char expect[4];
+            for (int c = 0;c < 3;c++) {
+                unsigned v = qtcBound(0, 0xff * rgb[c], 0xff);
+                expect[layout[c]] = v * alpha / 0xff;
+            }
+            expect[layout[3]] = alpha;
+            for (int c = 0;c < 4;c++) {
+                assert(std::abs(ref[i * 4 + c] - expect[c]) <= 1);
+            }
+        }
+        for (auto impl: impls) {
+            if (!Pixel::setImpl(impl)) {
+                continue;
+            }
+            std::vector<unsigned char> res(n * 4);
+            Pixel::fillShadow(res.data(), bias.data(), n, &c1, &c2, order);
+            assert(res == ref);
+        }
+    }
+}
+
+int
+main()
+{
+    assert(Pixel::supported(Pixel::impl()));
+    testAdjust();
+    testShadow();
+    return 0;
+}
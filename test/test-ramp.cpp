@@ -0,0 +1,85 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/ramp.h>
+#include <assert.h>
+
+using namespace QtCurve;
+
+struct Stop {
+    double pos;
+    double val;
+    double alpha;
+};
+
+static const Stop stops[] = {
+    {0.0, 1.2, 1.0}, {0.5, 1.0, 0.5}, {1.0, 0.8, 1.0}
+};
+
+static bool
+sameColor(const QtcColor &c1, const QtcColor &c2)
+{
+    return c1.red == c2.red && c1.green == c2.green && c1.blue == c2.blue;
+}
+
+int
+main()
+{
+    const QtcColor base = {0.4, 0.5, 0.6};
+    RampStops plain = Ramp(base, Shading::HSL).addAll(stops).stops();
+    assert(plain->size() == 3);
+    for (size_t i = 0;i < 3;i++) {
+        // A shade of 1 is the base color itself.
+        QtcColor shaded = base;
+        if (stops[i].val != 1.0) {
+            _qtcShade(&base, &shaded, stops[i].val, Shading::HSL);
+        }
+        assert((*plain)[i].pos == stops[i].pos);
+        assert((*plain)[i].alpha == stops[i].alpha);
+        assert(sameColor((*plain)[i].color, shaded));
+    }
+    // The same color and stops share the ramp.
+    assert(Ramp(base, Shading::HSL).addAll(stops).stops() == plain);
+    assert(Ramp(base, Shading::HSV).addAll(stops).stops() != plain);
+    const QtcColor other = {0.4, 0.5, 0.7};
+    assert(Ramp(other, Shading::HSL).addAll(stops).stops() != plain);
+
+    RampStops tab = Ramp(base, Shading::HSL,
+                         Ramp::Reverse | Ramp::Invert | Ramp::BaseEnd |
+                         Ramp::Opaque).addAll(stops).stops();
+    assert(tab != plain && tab->size() == 3);
+    for (size_t i = 0;i < 3;i++) {
+        assert((*tab)[i].pos == 1.0 - stops[i].pos);
+        assert((*tab)[i].alpha == 1.0);
+    }
+    // 1.2 is inverted to 0.8 but shades are not inverted below 0.9.
+    QtcColor inverted;
+    _qtcShade(&base, &inverted, 0.9, Shading::HSL);
+    assert(sameColor((*tab)[0].color, inverted));
+    assert(sameColor((*tab)[1].color, base));
+    assert(sameColor((*tab)[2].color, base));
+
+    // Ramps that are still in use survive clearing the cache.
+    Ramp::clear();
+    assert(plain->size() == 3);
+    assert(Ramp(base, Shading::HSL).addAll(stops).stops() != plain);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ *   Copyright 2013 - 2015 Yichao Yu <yyc1992@gmail.com>                     *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/color.h>
+#include <assert.h>
+
+static bool
+colorEqual(const QtcColor &c1, const QtcColor &c2)
+{
+    return (c1.red == c2.red && c1.green == c2.green &&
+            c1.blue == c2.blue);
+}
+
+static void
+test_palette(const QtcColor *base, const QtcShadeParams *params)
+{
+    QtcColor expect[QTC_NUM_PALETTE_SHADES];
+    for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
+        _qtcShade(base, &expect[i], params->factors[i], params->shading);
+    }
+    _qtcShade(base, &expect[QTC_NUM_STD_SHADES], params->highlight,
+              params->shading);
+    _qtcShade(&expect[4], &expect[QTC_NUM_STD_SHADES + 1], params->highlight,
+              params->shading);
+    _qtcShade(&expect[2], &expect[QTC_NUM_STD_SHADES + 2], params->highlight,
+              params->shading);
+    expect[QTC_NUM_PALETTE_SHADES - 1] = *base;
+    // The second call is served from the cache.
+    for (int n = 0;n < 2;n++) {
+        QtcColor vals[QTC_NUM_PALETTE_SHADES];
+        _qtcShadeColors(base, params, vals);
+        for (int i = 0;i < QTC_NUM_PALETTE_SHADES;i++) {
+            assert(colorEqual(vals[i], expect[i]));
+        }
+    }
+}
+
+int
+main()
+{
+    const QtcColor bases[] = {
+        {0, 0, 0}, {1, 1, 1}, {0.2, 0.4, 0.8}, {0.9, 0.1, 0.3}
+    };
+    const Shading shadings[] = {
+        Shading::Simple, Shading::HSL, Shading::HSV, Shading::HCY
+    };
+    for (int contrast = 0;contrast <= 10;contrast += 5) {
+        for (auto shading: shadings) {
+            QtcShadeParams params;
+            for (int i = 0;i < QTC_NUM_STD_SHADES;i++) {
+                params.factors[i] = qtcShadeGetIntern(contrast, i, false,
+                                                      shading);
+            }
+            params.highlight = 1.03;
+            params.shading = shading;
+            for (auto &base: bases) {
+                test_palette(&base, &params);
+            }
+            qtcClearShadeColorsCache();
+            params.highlight = 1;
+            for (auto &base: bases) {
+                test_palette(&base, &params);
+            }
+        }
+    }
+    return 0;
+}
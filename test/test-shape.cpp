@@ -0,0 +1,105 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/shape.h>
+#include <qtcurve-utils/number.h>
+#include <assert.h>
+#include <vector>
+
+using namespace QtCurve;
+
+typedef std::vector<std::vector<int> > Coverage;
+
+static void
+cover(Coverage &pixels, const ShapeRect &rect)
+{
+    for (int y = qtcMax(rect.y, 0);
+         y < qtcMin(rect.y + rect.height, (int)pixels.size());y++) {
+        for (int x = qtcMax(rect.x, 0);
+             x < qtcMin(rect.x + rect.width, (int)pixels[y].size());x++) {
+            pixels[y][x]++;
+        }
+    }
+}
+
+// The overlapping rectangles the styles used to build the shape from.
+static Coverage
+reference(int w, int h, bool full)
+{
+    Coverage pixels(h, std::vector<int>(w, 0));
+    if (full) {
+        cover(pixels, ShapeRect{4, 0, w - 4 * 2, h});
+        cover(pixels, ShapeRect{0, 4, w, h - 4 * 2});
+        cover(pixels, ShapeRect{2, 1, w - 2 * 2, h - 2});
+        cover(pixels, ShapeRect{1, 2, w - 2, h - 2 * 2});
+    } else {
+        cover(pixels, ShapeRect{1, 1, w - 2, h - 2});
+        cover(pixels, ShapeRect{0, 2, w, h - 4});
+        cover(pixels, ShapeRect{2, 0, w - 4, h});
+    }
+    for (auto &row: pixels) {
+        for (auto &pixel: row) {
+            pixel = pixel ? 1 : 0;
+        }
+    }
+    return pixels;
+}
+
+int
+main()
+{
+    for (int full = 0;full < 2;full++) {
+        for (int w = 1;w < 24;w++) {
+            for (int h = 1;h < 24;h++) {
+                ShapeRect rects[Shape::maxRects];
+                size_t num = Shape::rounded(w, h, full, rects);
+                assert(num <= Shape::maxRects);
+                Coverage pixels(h, std::vector<int>(w, 0));
+                for (size_t i = 0;i < num;i++) {
+                    assert(rects[i].width > 0 && rects[i].height > 0);
+                    if (i > 0) {
+                        assert(rects[i].y ==
+                               rects[i - 1].y + rects[i - 1].height);
+                    }
+                    cover(pixels, rects[i]);
+                }
+                // No overlap, and the same shape as the old rectangles
+                // wherever those didn't degenerate.
+                Coverage ref = reference(w, h, full);
+                for (int y = 0;y < h;y++) {
+                    for (int x = 0;x < w;x++) {
+                        assert(pixels[y][x] <= 1);
+                        if (w > 8 && h > 8) {
+                            assert(pixels[y][x] == ref[y][x]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    ShapeRect rects[Shape::maxRects];
+    assert(Shape::rounded(100, 50, true, rects) == 7);
+    assert(rects[3].x == 0 && rects[3].y == 4 && rects[3].width == 100 &&
+           rects[3].height == 42);
+    assert(Shape::rounded(100, 50, false, rects) == 5);
+    assert(Shape::rounded(0, 50, false, rects) == 0);
+    return 0;
+}
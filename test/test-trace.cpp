@@ -0,0 +1,98 @@
+/*****************************************************************************
+ *   Copyright 2015 Yichao Yu <yyc1992@gmail.com>                            *
+ *                                                                           *
+ *   This program is free software; you can redistribute it and/or modify    *
+ *   it under the terms of the GNU Lesser General Public License as          *
+ *   published by the Free Software Foundation; either version 2.1 of the    *
+ *   License, or (at your option) version 3, or any later version accepted   *
+ *   by the membership of KDE e.V. (or its successor approved by the         *
+ *   membership of KDE e.V.), which shall act as a proxy defined in          *
+ *   Section 6 of version 3 of the license.                                  *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ *   Lesser General Public License for more details.                         *
+ *                                                                           *
+ *   You should have received a copy of the GNU Lesser General Public        *
+ *   License along with this library. If not,                                *
+ *   see <http://www.gnu.org/licenses/>.                                     *
+ *****************************************************************************/
+
+#include <qtcurve-utils/trace.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace QtCurve;
+
+static std::string tracePath;
+
+// The trace is written again at exit.
+static void
+removeTrace()
+{
+    unlink(tracePath.c_str());
+}
+
+static size_t
+countStr(const std::string &str, const std::string &sub)
+{
+    size_t res = 0;
+    for (size_t pos = str.find(sub);pos != std::string::npos;
+         pos = str.find(sub, pos + 1)) {
+        res++;
+    }
+    return res;
+}
+
+static void
+traced(int depth)
+{
+    qtcTrace("traced");
+    if (depth > 0) {
+        traced(depth - 1);
+    }
+}
+
+int
+main()
+{
+    char prefix[] = "/tmp/qtc-test-trace-XXXXXX";
+    int fd = mkstemp(prefix);
+    assert(fd >= 0);
+    close(fd);
+    unlink(prefix);
+    setenv("QTCURVE_TRACE", prefix, 1);
+    tracePath = (std::string(prefix) + '-' + std::to_string(getpid()) +
+                 ".json");
+    atexit(removeTrace);
+    assert(Trace::enabled());
+
+    {
+        qtcTrace("outer \"span\"");
+        traced(2);
+    }
+    std::thread thread([] {
+            qtcTrace("thread");
+        });
+    thread.join();
+    assert(Trace::flush());
+
+    std::ifstream file(tracePath);
+    std::stringstream data;
+    data << file.rdbuf();
+    const std::string trace = data.str();
+    assert(trace.find("{\"traceEvents\":[") == 0);
+    assert(countStr(trace, "\"ph\":\"X\"") == 5);
+    assert(countStr(trace, "\"name\":\"traced\"") == 3);
+    assert(countStr(trace, "\"name\":\"outer \\\"span\\\"\"") == 1);
+    assert(countStr(trace, "\"name\":\"thread\",") == 1);
+    assert(countStr(trace, "\"tid\":1}") == 4);
+    assert(countStr(trace, "\"tid\":2}") == 1);
+    return 0;
+}